@@ -47,7 +47,8 @@
 
 #define SERIAL_PRINT 1                    // 1 = yes, 0 = no. Select if Serial.print messages are printed
 #define FLASH_LOGGING 1                   // 1 = yes, 0 = no. Enable to write log-messages in Flash (LittleFS)
-#define LOGGING_ENTRIES 10                // Number of persisting entries in Log-File
+#define LOGGING_ENTRIES 10                // Number of entries of the Log-File which are printed at start
+#define LOGGING_SECTORS 2                 // Size of the ring Log-File in flash sectors of 4 kB (56 entries each)
 
 #define _ESPASYNC_WIFIMGR_LOGLEVEL_  0     // ( 0 - 4) Define EspAsync_WiFiManager Loglevel (Debug Messages)
 
@@ -66,6 +67,8 @@
 
 #define VIESSMANN_ANALOG_TABLENAME_01 "ApiAnalog01ValuesX" // Name of the Azure Table to store 4 analog Values max length = 45
 
+#define WATERMETER_ANALOG_TABLENAME "WaterValuesX"         // Name of the Azure Table to store 4 analog Values of the watermeter max length = 45
+
 #define ANALOG_TABLE_PART_PREFIX "Y2_"            // Prefix for PartitionKey of Analog Tables (default, no need to change)
 
 
@@ -78,6 +81,24 @@
 
 #define ON_OFF_TABLE_PART_PREFIX "Y3_"           // Prefix for PartitionKey of On/Off Tables (default, only change if needed)
 
+#define HEALTH_TELEMETRY 1                       // 1 means: every MAIN_LOOP_REPORT_SECONDS a row with heap, loop cycle times,
+                                                 // request latencies, RSSI, reconnects and queue depths is stored
+#define HEALTH_TABLENAME "DeviceHealthX"         // Name of the health table (like the analog tables: T_1 free heap kB,
+                                                 // T_2 loop p99 ms, T_3 mean Azure latency ms, T_4 RSSI) max length = 45
+#define HEALTH_TABLE_PART_PREFIX "Y4_"           // Prefix for PartitionKey of the health table
+#define HEALTH_BATCH_ROWS 4                      // The health rows are collected and sent in one batch (max 6)
+
+#define ON_OFF_SEND_DUTY_CYCLE_STATS 1           // 1 means: Starts per hour and day, min and mean on-time, longest run and
+                                                 // mean off-time of the day are stored in additional columns of the On/Off tables
+
+#define ON_OFF_FLUSH_COUNT 4                     // The switch events of the On/Off tables are buffered and uploaded in batches
+#define ON_OFF_FLUSH_SECONDS 300                 // when one table has this number of events or the oldest is older than this
+                                                 // (seconds). ON_OFF_FLUSH_COUNT 1 means: every event is uploaded immediately
+
+#define ON_OFF_RECONCILE_BURNER_STARTS 1         // 1 means: Burner cycles which happened between two polls are concluded from the
+                                                 // 'starts' counter (heating.burners.0.statistics) and stored as
+#define ON_OFF_MAX_INFERRED_CYCLES 10            // switch events with Inferred = 1 (max. this number of cycles per poll)
+
 #define INVALIDATEINTERVAL_MINUTES 10      // Invalidateinterval in minutes 
                                            // (limited to values between 1 - 60)
                                            // (Sensor readings are considered to be invalid if not successsfully
@@ -85,6 +106,8 @@
 
 #define NTP_UPDATE_INTERVAL_MINUTES 14400  //  With this interval sytem time is updated via NTP 14400 = 10 days
                                            //  with internet time (is limited to be not below 1 min)
+                                           //  NTP is only asked when no Azure response came within this interval,
+                                           //  in between the time is corrected by the measured drift of the crystal
 
 #define UPDATE_TIME_FROM_AZURE_RESPONSE 1  // 1 = yes, 0 = no. SystemTime is updated from the Post response from Azure.
                                            // With this option set, you can set  NTP_UPDATE_INTERVAL_MINUTES to a very
@@ -96,15 +119,77 @@
 
 #define GASMETER_AI_API_BASEVALUE_OFFSET "2000"  // Offset for the basevalue, holds the not evaluated left digits
 
+#define USE_WATERMETER 0                           // 1 = yes, 0 = no. A second AiOnTheEdge device (hostname 'watermeter')
+                                                   // is read and its values are stored in WATERMETER_ANALOG_TABLENAME
+
+#define WATERMETER_AI_API_READ_INTERVAL_SECONDS 60 //Values from the AiOnTheEdge watermeter are read with this timeinterval
+
+#define WATERMETER_AI_API_BASEVALUE_OFFSET "0"     // Offset for the basevalue, holds the not evaluated left digits
+
+#define METER_HTTP_TIMEOUT_MS 4000               // Every meter is read by its own task with its own HTTP client, a slow
+                                                 // or hanging camera delays only the reads of its own meter
+#define METER_RETRY_MAX_BACKOFF_SECONDS 600      // After each failed read the read interval of the meter is doubled up to this time
+
+#define GASMETER_MAX_FLOW_PER_MINUTE 0.1         // Maximal possible flow of the gasmeter (m3 per minute), readings which
+                                                 // imply a higher flow are rejected (or repaired with the 'raw' value)
+
+#define WATERMETER_MAX_FLOW_PER_MINUTE 0.06      // Maximal possible flow of the watermeter (m3 per minute)
+
+#define METER_RESYNC_AFTER_REJECTS 10            // After this number of rejected readings in a row, which agree with each other
+                                                 // (within the max flow), the next agreeing reading is taken as new reference
+                                                 // (e.g. after the meter was changed). Failed reads are not counted
+
 #define API_ANALOG_SENSOR_READ_INTERVAL_SECONDS 77  // Analog Sensor values from the Viessmann Api (seconds, can be 0)
 
 #define VIESSMANN_API_READ_INTERVAL_SECONDS 75  //Values from the Viessmann Cloud Api are read with this timeinterval
 
+#define VI_SEND_BY_EXCEPTION 1                   // 1 = yes, 0 = no. Values from the Viessmann Api are only sent when one value
+                                                 // moved beyond its deadband, or at the latest after VI_HEARTBEAT_MINUTES
+                                                 // 0 means: Values are sent every SENDINTERVAL_MINUTES_VI
+#define VI_HEARTBEAT_MINUTES 60                  // Maximal time between two sends of the Viessmann analog values (minutes)
+#define VI_DEADBAND_T_1 0.5                      // Deadband of T_1 (outside temperature)
+#define VI_DEADBAND_T_2 2.0                      // Deadband of T_2 (supply temperature)
+#define VI_DEADBAND_T_3 1.0                      // Deadband of T_3 (hot water temperature)
+#define VI_DEADBAND_T_4 5.0                      // Deadband of T_4 (burner modulation)
+
 #define ANALOG_SENSORS_USE_AVERAGE 0             // 1 means: The average from multiple Sensor readings are used
                                                  // 0 means: The last Sensor reading is used
 
+#define ANALOG_SENSORS_SEND_INTERVAL_STATS 1     // 1 means: Min, max and mean of the readings in the send interval are
+                                                 // stored in additional columns of the Viessmann analog table
+                                                 // (T_1_Min, T_1_Max, T_1_Mean ... T_4_Mean)
+
+#define ANALOG_SENSORS_SEND_ROLLUPS 1            // 1 means: Hourly and daily min, max and mean of the analog values are
+                                                 // stored in additional tables (...Hours2025, ...Days2025)
+                                                 // For the meters only the ...Hours table is written
+
 #define VIESSMANN_TOKEN_REFRESH_INTERVAL_SECONDS 60 * 29 // Viessman AccessToken is refreshed using this timeInterval
 
+#define MAIN_LOOP_CYCLE_MS 1000                 // loop() performs its work every cycle and sleeps in between
+                                                 // (must be clearly below 15 seconds for the end of day handling)
+#define MAIN_LOOP_LIGHT_SLEEP 1                  // 1 = yes, 0 = no. Light sleep while waiting, if the framework
+                                                 // is built with power management and tickless idle
+#define MAIN_LOOP_REPORT_SECONDS 600             // Interval to print cycle jitter and idle time (SERIAL_PRINT 1)
+                                                 // and of the health rows (HEALTH_TELEMETRY 1)
+
+#define METRICS_FLUSH_INTERVAL_MINUTES 60        // The metrics (counters, latencies) survive resets in RTC memory,
+                                                 // in this interval they are also written to flash (power loss)
+
+#define LOW_POWER_MODE 0                         // 1 = yes, 0 = no. WiFi in modem sleep between the polls, the
+                                                 // uploads are collected and sent in one burst per batch interval
+#define LOW_POWER_UPLOAD_BATCH_SECONDS 600       // Min time between two upload bursts (should match the send interval)
+#define LOW_POWER_CYCLE_MS 5000                  // Cycle of loop() and of the acquisition task in low power mode
+                                                 // (must be clearly below 15 seconds for the end of day handling)
+
+#define ACQUISITION_TASK_CORE 0                  // The tasks which read the Viessmann Cloud and the meters
+#define ACQUISITION_TASK_PRIORITY 1              // (loop() runs on core 1 and processes and uploads the values)
+#define ACQUISITION_TASK_STACK_SIZE 16 * 1024
+#define ACQUISITION_TASK_PERIOD_MS 1000          // The task checks the read intervals with this period
+#define ACQUISITION_QUEUE_LENGTH 8               // Events of reads which wait to be processed by loop()
+#define METER_TASK_STACK_SIZE 10 * 1024          // Each active meter has its own task on ACQUISITION_TASK_CORE
+#define METER_RESPONSE_BUFFER_LENGTH 2000        // Responses of an AiOnTheEdge device
+#define METER_COMMAND_QUEUE_LENGTH 4             // Requests of loop() to a meter (pre value) which wait for the task of the meter
+
 #define WORK_WITH_WATCHDOG 0              // 1 = yes, 0 = no, Watchdog is used (1) or not used (0)
                                            // should be 1 for normal operation and 0 for testing
                                            
@@ -131,6 +216,9 @@
 #define  DST_STOP_HOUR               3       // 0 - 23
                                                 
 #define AZURE_TRANSPORT_PROTOKOL 1        // 0 = http, 1 = https
+#define AZURE_AUTH_MODE_SAS 0             // 1 = requests are authorized by AZURE_CONFIG_SAS_TOKEN (config_secret.h)
+                                          // the requests are not signed, the account key is not needed
+                                          // 0 = SharedKey (the account key signs each request)
 
 #define USE_STATIC_IP 0                // 1 = use static IpAddress, 0 = use DHCP
                                         // for static IP: Ip-addresses have to be set in the code
@@ -12,6 +12,11 @@
 #define AZURE_CONFIG_ACCOUNT_NAME       "YourAzureStorageAccountName"
 #define AZURE_CONFIG_ACCOUNT_KEY        "3M+ssz2Ws6....YourStorageAccountKey.....BOjg+1r7ZA=="
 
+// Only needed with AZURE_AUTH_MODE_SAS = 1 (config.h)
+// Account SAS for the table service (ss=t) with resource types 'sco' (the tables of a year are created 
+// by the device) and permissions 'rau' or 'racu'. Max length 200
+#define AZURE_CONFIG_SAS_TOKEN          "sv=2019-02-02&ss=t&srt=sco&sp=rau&se=2030-01-01T00:00:00Z&spr=https&sig=..."
+
 // The following three tokens need not be set to valid values here
 // The Viessmann Client Id and the Viessmann Refresh Token 
 // can be set in the Config Portal Page 
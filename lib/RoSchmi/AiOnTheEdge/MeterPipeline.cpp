@@ -0,0 +1,46 @@
+#include "MeterPipeline.h"
+
+// Constructor
+MeterPipeline::MeterPipeline(const char * pLabel, RestApiAccount * pAccount, AiOnTheEdgeApiSelection * pApiSelection, DataContainerWio * pContainer,
+                             AnalogSensorMgr * pSensorMgr, const char * pTableName, const char * pPersistFile, bool pIsActive)
+{
+    strncpy(Label, pLabel, sizeof(Label) - 1);
+    strncpy(TableName, pTableName, sizeof(TableName) - 1);
+    strncpy(PersistFile, pPersistFile, sizeof(PersistFile) - 1);
+    Account = pAccount;
+    ApiSelection = pApiSelection;
+    Container = pContainer;
+    SensorMgr = pSensorMgr;
+    IsActive = pIsActive;
+}
+
+void MeterPipeline::SetInactive()
+{
+    IsActive = false;
+    SensorMgr ->SetSensorActive(0, false);
+}
+
+void MeterPipeline::SetActive()
+{
+    IsActive = true;
+    SensorMgr ->SetSensorActive(0, true);
+}
+
+bool MeterPipeline::AttachScheduler(SensorScheduler * pScheduler, uint8_t pSource)
+{
+    if (!SensorMgr ->AttachScheduler(pScheduler, pSource, METER_POLLED_CHANNEL_MASK))
+    {
+        return false;
+    }
+    SensorMgr ->SetSensorActive(0, IsActive);
+    return true;
+}
+
+void MeterPipeline::SetReadInterval(int32_t pReadIntervalSeconds)
+{
+    ApiSelection ->readIntervalSeconds = pReadIntervalSeconds;
+    // Channel 3 is not read from the meter, keeps the standard interval
+    SensorMgr ->SetReadInterval(0, pReadIntervalSeconds);
+    SensorMgr ->SetReadInterval(1, pReadIntervalSeconds);
+    SensorMgr ->SetReadInterval(2, pReadIntervalSeconds);
+}
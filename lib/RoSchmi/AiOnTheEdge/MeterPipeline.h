@@ -0,0 +1,115 @@
+#include <Arduino.h>
+#include "RestApiAccount.h"
+#include "AiOnTheEdgeApiSelection.h"
+#include "DataContainerWio.h"
+#include "AnalogSensorMgr.h"
+#include "MeterPlausibilityFilter.h"
+#include "AnalogRollup.h"
+
+#ifndef _METERPIPELINE_H_
+#define _METERPIPELINE_H_
+
+// Number of features read from the AiOnTheEdge Json endpoint
+// (value, raw, pre, error, rate, timestamp)
+#define AI_FEATURES_COUNT 6
+
+#define METER_LABEL_LENGTH 15
+#define METER_TABLENAME_LENGTH 45
+#define METER_PERSISTFILE_LENGTH 30
+
+// Only channel 0 takes the reading of the device (when the event of the read comes in), its deadline
+// is the time when the next reading is expected. Channels 1 - 3 are derived from it
+#define METER_POLLED_CHANNEL_MASK 0x01
+
+// Values of the first reading of a day of one meter
+// The layout of the first four members is the same as in the
+// former 'First_Reading' struct, so that an existing gas file
+// can still be read
+// Is stored in the journaled state store (protected by CRC32),
+// checksum is only used in the persist files of former versions
+typedef struct
+{
+  char localTimestamp[30] = {'\0'};
+  int timeZoneOffsetUTC = 0;
+  float dayBaseValue = 0.0;
+  int overflowCount = 0;
+  uint16_t checksum = 0;
+} MeterDayBase;
+
+// Is used to store the consumption of the last day
+// is set in the first reading of each new day
+// if it is valid, the value is stored in a new
+// line in the Azure ...Days Table
+typedef struct
+{
+  bool isValid = false;
+  float dayConsumption = 0.0f;
+  float totalConsumption = 0.0f;
+} MaxLastDayConsumption;
+
+// A MeterPipeline bundles everything that is needed to read one
+// AiOnTheEdge meter device (gas, water, electricity) and to store
+// its values in Azure: the Rest-Api account, the read schedule,
+// the persisted base value of the day, the datacontainer and the tablename
+class MeterPipeline
+{
+public:
+    MeterPipeline(const char * pLabel, RestApiAccount * pAccount, AiOnTheEdgeApiSelection * pApiSelection, DataContainerWio * pContainer,
+                  AnalogSensorMgr * pSensorMgr, const char * pTableName, const char * pPersistFile, bool pIsActive = true);
+
+    // The polled channel of an inactive meter has no deadline in the scheduler
+    void SetInactive();
+    void SetActive();
+
+    /**
+    * @brief Registers the polled channel of the meter in the scheduler
+    *
+    * @param[in] pScheduler The scheduler which is shared by all sensor groups
+    * @param[in] pSource The number of the sensor group of this meter in the scheduler
+    * @return false if the scheduler is full
+    */
+    bool AttachScheduler(SensorScheduler * pScheduler, uint8_t pSource);
+
+    /**
+    * @brief Sets the read interval of the meter device and of the 3 channels
+    *        (total, day consumption, rate) which are derived from the reading
+    *
+    * @param[in] pReadIntervalSeconds The interval in seconds
+    */
+    void SetReadInterval(int32_t pReadIntervalSeconds);
+
+    char Label[METER_LABEL_LENGTH] = {'\0'};
+    char TableName[METER_TABLENAME_LENGTH] = {'\0'};
+    char PersistFile[METER_PERSISTFILE_LENGTH] = {'\0'};    // only read once to take over the DayBase of former versions
+    uint8_t StateKey = 0;                                     // key of the DayBase in the journaled state store
+    bool IsActive = true;
+
+    RestApiAccount * Account;
+    AiOnTheEdgeApiSelection * ApiSelection;
+    DataContainerWio * Container;
+    AnalogSensorMgr * SensorMgr;
+
+    // Features of the newest read, copied out of its event by loop()
+    AiOnTheEdgeApiSelection::Feature Features[AI_FEATURES_COUNT];
+    bool HasNewFeatures = false;                              // the reading of the features is not yet taken
+
+    bool IsFirstRead = true;
+    bool PreValueIsPending = false;                           // the task of the meter has to set the pre value of the first read
+    float PendingPreValue = 0.0f;
+    float LastReading = 0.0f;
+    float LastDayConsumption = 0.0f;
+    uint32_t ReadErrorCount = 0;
+    uint32_t LoadJsonCount = 0;
+    int InsertCounter = 0;
+
+    MeterDayBase DayBase;
+    MaxLastDayConsumption MaxLastDay;
+
+    // Readings pass this filter before they are stored in the container
+    MeterPlausibilityFilter Plausibility;
+
+    // Hourly min/max/mean of the channels for the ...Hours table
+    AnalogRollup Rollup;
+};
+
+#endif  // _METERPIPELINE_H_
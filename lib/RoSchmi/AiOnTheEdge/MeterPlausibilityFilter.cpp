@@ -0,0 +1,146 @@
+#include "MeterPlausibilityFilter.h"
+
+// Constructor
+MeterPlausibilityFilter::MeterPlausibilityFilter()
+{}
+
+void MeterPlausibilityFilter::Begin(float pMaxFlowPerMinute, uint32_t pResyncAfterRejects)
+{
+    maxFlowPerMinute = pMaxFlowPerMinute > 0.0f ? pMaxFlowPerMinute : 1.0f;
+    resyncAfterRejects = pResyncAfterRejects;
+}
+
+void MeterPlausibilityFilter::Reset()
+{
+    hasReference = false;
+    statistics.ConsecutiveRejects = 0;
+}
+
+PlausibilityResult MeterPlausibilityFilter::Check(float pValue, float pRaw, float pPre, uint32_t pUtcSeconds, float * outValue)
+{
+    if (isnan(pValue) || isinf(pValue) || pValue <= 0.0f)
+    {
+        return SetInvalid();
+    }
+    if (!hasReference || isInRange(LastAcceptedValue, LastAcceptedTime, pValue, pUtcSeconds))
+    {
+        return accept(PlausibilityResult::Accepted, pValue, pUtcSeconds, outValue);
+    }
+
+    PlausibilityResult reason = pValue < LastAcceptedValue ? PlausibilityResult::Backwards : PlausibilityResult::TooFast;
+    if (!isnan(pPre) && isDigitFlip(pValue, pPre))
+    {
+        reason = PlausibilityResult::DigitFlip;
+    }
+
+    // The post-processed 'value' is implausible, try to repair with the 'raw' value
+    if (!isnan(pRaw) && pRaw > 0.0f && isInRange(LastAcceptedValue, LastAcceptedTime, pRaw, pUtcSeconds))
+    {
+        return accept(PlausibilityResult::Repaired, pRaw, pUtcSeconds, outValue);
+    }
+
+    // The meter could really have changed (e.g. replaced), don't reject forever:
+    // after resyncAfterRejects rejects which agree with each other, the next agreeing reading is taken
+    bool agreesWithRejects = statistics.ConsecutiveRejects > 0 && isInRange(lastRejectedValue, lastRejectedTime, pValue, pUtcSeconds);
+    if (resyncAfterRejects > 0 && agreesWithRejects && statistics.ConsecutiveRejects >= resyncAfterRejects)
+    {
+        return accept(PlausibilityResult::Resynced, pValue, pUtcSeconds, outValue);
+    }
+    return reject(reason, pValue, pUtcSeconds);
+}
+
+PlausibilityResult MeterPlausibilityFilter::SetInvalid()
+{
+    // A failed read says nothing about the meter, the series of rejects goes on
+    statistics.Invalid++;
+    return PlausibilityResult::Invalid;
+}
+
+bool MeterPlausibilityFilter::IsUsable(PlausibilityResult pResult)
+{
+    return pResult == PlausibilityResult::Accepted || pResult == PlausibilityResult::Repaired || pResult == PlausibilityResult::Resynced;
+}
+
+const char * MeterPlausibilityFilter::ResultName(PlausibilityResult pResult)
+{
+    switch (pResult)
+    {
+        case PlausibilityResult::Accepted:  return "Accepted";
+        case PlausibilityResult::Repaired:  return "Repaired";
+        case PlausibilityResult::Resynced:  return "Resynced";
+        case PlausibilityResult::Invalid:   return "Invalid";
+        case PlausibilityResult::Backwards: return "Backwards";
+        case PlausibilityResult::TooFast:   return "TooFast";
+        case PlausibilityResult::DigitFlip: return "DigitFlip";
+    }
+    return "Unknown";
+}
+
+PlausibilityStatistics MeterPlausibilityFilter::GetStatistics()
+{
+    return statistics;
+}
+
+bool MeterPlausibilityFilter::isInRange(float pReference, uint32_t pReferenceTime, float pValue, uint32_t pUtcSeconds)
+{
+    // float has about 7 significant digits, so allow a small tolerance
+    float tolerance = 0.0005f + fabsf(pReference) * 1.0e-6f;
+    float delta = pValue - pReference;
+    if (delta < -tolerance)
+    {
+        return false;
+    }
+    // Readings are not exactly equidistant, so at least one minute is assumed
+    float elapsedMinutes = pUtcSeconds > pReferenceTime ? (float)(pUtcSeconds - pReferenceTime) / 60.0f : 0.0f;
+    if (elapsedMinutes < 1.0f)
+    {
+        elapsedMinutes = 1.0f;
+    }
+    return delta <= maxFlowPerMinute * elapsedMinutes + tolerance;
+}
+
+bool MeterPlausibilityFilter::isDigitFlip(float pValue, float pPre)
+{
+    // A misread digit changes the reading by k * 10^n with a single digit k
+    float diff = fabsf(pValue - pPre);
+    if (diff < 0.001f)
+    {
+        return false;
+    }
+    float magnitude = powf(10.0f, floorf(log10f(diff)));
+    float leading = diff / magnitude;
+    return fabsf(leading - roundf(leading)) < 0.01f;
+}
+
+PlausibilityResult MeterPlausibilityFilter::reject(PlausibilityResult pResult, float pValue, uint32_t pUtcSeconds)
+{
+    // A reject which does not agree with the rejects before starts a new series
+    bool agreesWithRejects = statistics.ConsecutiveRejects > 0 && isInRange(lastRejectedValue, lastRejectedTime, pValue, pUtcSeconds);
+    statistics.ConsecutiveRejects = agreesWithRejects ? statistics.ConsecutiveRejects + 1 : 1;
+    lastRejectedValue = pValue;
+    lastRejectedTime = pUtcSeconds;
+    switch (pResult)
+    {
+        case PlausibilityResult::Backwards: statistics.Backwards++; break;
+        case PlausibilityResult::TooFast:   statistics.TooFast++; break;
+        case PlausibilityResult::DigitFlip: statistics.DigitFlip++; break;
+        default: break;
+    }
+    return pResult;
+}
+
+PlausibilityResult MeterPlausibilityFilter::accept(PlausibilityResult pResult, float pValue, uint32_t pUtcSeconds, float * outValue)
+{
+    statistics.ConsecutiveRejects = 0;
+    switch (pResult)
+    {
+        case PlausibilityResult::Repaired: statistics.Repaired++; break;
+        case PlausibilityResult::Resynced: statistics.Resynced++; break;
+        default: statistics.Accepted++; break;
+    }
+    hasReference = true;
+    LastAcceptedValue = pValue;
+    LastAcceptedTime = pUtcSeconds;
+    *outValue = pValue;
+    return pResult;
+}
@@ -0,0 +1,91 @@
+#include <Arduino.h>
+
+#ifndef _METERPLAUSIBILITYFILTER_H_
+#define _METERPLAUSIBILITYFILTER_H_
+
+// Result of the plausibility check of one meter reading
+enum class PlausibilityResult
+{
+    Accepted,       // reading is plausible
+    Repaired,       // reading was implausible, the 'raw' value was used instead
+    Resynced,       // after too many consistent rejects in a row, the reading is taken as new reference
+    Invalid,        // reading could not be parsed or was 0
+    Backwards,      // reading is lower than the last accepted reading
+    TooFast,        // reading implies a flow above the maximal possible flow
+    DigitFlip       // reading differs from 'pre' in exactly one digit position
+};
+
+// Accept/reject statistics of one meter
+typedef struct
+{
+    uint32_t Accepted = 0;
+    uint32_t Repaired = 0;
+    uint32_t Resynced = 0;
+    uint32_t Invalid = 0;
+    uint32_t Backwards = 0;
+    uint32_t TooFast = 0;
+    uint32_t DigitFlip = 0;
+    uint32_t ConsecutiveRejects = 0;    // rejects in a row which agree with each other (failed reads not counted)
+} PlausibilityStatistics;
+
+// Streaming plausibility stage for the readings of an AiOnTheEdge meter device
+// The meter is a counter: readings may not go backwards and may not rise faster
+// than the maximal physically possible flow. Misread digits of the camera
+// (digit flips) are detected with the 'raw' and 'pre' values of the device
+// Only a series of rejected readings which agree with each other (within the
+// maximal flow) can make a new reference, a single glitch never does
+class MeterPlausibilityFilter
+{
+public:
+    MeterPlausibilityFilter();
+
+    /**
+    * @brief Sets the limits of the filter
+    *
+    * @param[in] pMaxFlowPerMinute Maximal possible flow in meter units per minute
+    * @param[in] pResyncAfterRejects After this number of consistent rejects in a row the next
+    *                                reading which agrees with them is taken as new reference (0 = never)
+    */
+    void Begin(float pMaxFlowPerMinute, uint32_t pResyncAfterRejects);
+
+    /**
+    * @brief Checks a new reading of the meter
+    *
+    * @param[in] pValue The 'value' read from the device (meter units)
+    * @param[in] pRaw The 'raw' value read from the device (NAN if not available)
+    * @param[in] pPre The 'pre' value read from the device (NAN if not available)
+    * @param[in] pUtcSeconds Time of the reading
+    * @param[out] outValue The value to be used (only valid if the reading was accepted, repaired or resynced)
+    * @return The result of the check
+    */
+    PlausibilityResult Check(float pValue, float pRaw, float pPre, uint32_t pUtcSeconds, float * outValue);
+
+    // Counts a reading which could not be parsed (or a failed read), does not count for the resync
+    PlausibilityResult SetInvalid();
+
+    // Forget the last accepted reading (e.g. after the 'pre' value of the device was set)
+    void Reset();
+
+    static bool IsUsable(PlausibilityResult pResult);
+    static const char * ResultName(PlausibilityResult pResult);
+
+    PlausibilityStatistics GetStatistics();
+
+    float LastAcceptedValue = 0.0f;
+    uint32_t LastAcceptedTime = 0;
+
+private:
+    bool isInRange(float pReference, uint32_t pReferenceTime, float pValue, uint32_t pUtcSeconds);
+    bool isDigitFlip(float pValue, float pPre);
+    PlausibilityResult reject(PlausibilityResult pResult, float pValue, uint32_t pUtcSeconds);
+    PlausibilityResult accept(PlausibilityResult pResult, float pValue, uint32_t pUtcSeconds, float * outValue);
+
+    float maxFlowPerMinute = 1.0f;
+    uint32_t resyncAfterRejects = 0;
+    bool hasReference = false;
+    float lastRejectedValue = 0.0f;     // the consistent rejects are checked against the last of them
+    uint32_t lastRejectedTime = 0;
+    PlausibilityStatistics statistics;
+};
+
+#endif  // _METERPLAUSIBILITYFILTER_H_
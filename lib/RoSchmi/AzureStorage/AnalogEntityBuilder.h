@@ -0,0 +1,83 @@
+#include <Arduino.h>
+#include <azure/core/az_span.h>
+#include <TableEntityProperty.h>
+#include <AnalogTableEntity.h>
+
+#ifndef _ANALOGENTITYBUILDER_H_
+#define _ANALOGENTITYBUILDER_H_
+
+// Builds the properties of an analog table row with N value columns (T_1 ... T_N)
+// and up to Extra additional named columns (e.g. T_1_Min, T_1_Max ...)
+// Column 0 is always 'SampleTime'
+// With N = 8 or N = 12 the values of two or three containers can be sent in one row
+template<size_t N, size_t Extra = 0>
+class AnalogEntityBuilder
+{
+public:
+    static constexpr size_t MaxPropertyCount = 1 + N + Extra;
+
+    AnalogEntityBuilder(const char * pSampleTime)
+    {
+        Properties[0] = TableEntityProperty((char *)"SampleTime", (char *)pSampleTime, (char *)"Edm.String");
+        char name[MAX_ENTITYPROPERTY_NAME_LENGTH] = {0};
+        for (size_t i = 0; i < N; i++)
+        {
+            snprintf(name, sizeof(name), "T_%u", (unsigned int)(i + 1));
+            Properties[1 + i] = TableEntityProperty(name, (char *)"", (char *)"Edm.String");
+        }
+    }
+
+    /**
+    * @brief Sets the value of column T_(pIndex + 1)
+    *
+    * @param[in] pIndex The index of the value column (0 - N-1)
+    * @param[in] pValue The value as string (max MAX_ENTITYPROPERTY_VALUE_LENGTH - 1 chars)
+    */
+    void SetValue(size_t pIndex, const char * pValue)
+    {
+        if (pIndex < N)
+        {
+            strlcpy(Properties[1 + pIndex].Value, pValue, MAX_ENTITYPROPERTY_VALUE_LENGTH);
+        }
+    }
+
+    /**
+    * @brief Appends an additional named column
+    *
+    * @param[in] pName The name of the column
+    * @param[in] pValue The value as string
+    * @return false if all Extra columns are already used
+    */
+    bool AddProperty(const char * pName, const char * pValue)
+    {
+        if (extraCount >= Extra)
+        {
+            return false;
+        }
+        EntityProperty * property = &Properties[1 + N + extraCount];
+        strlcpy(property ->Name, pName, MAX_ENTITYPROPERTY_NAME_LENGTH);
+        strlcpy(property ->Value, pValue, MAX_ENTITYPROPERTY_VALUE_LENGTH);
+        strlcpy(property ->Type, "Edm.String", MAX_ENTITYPROPERTY_TYPE_LENGTH);
+        extraCount++;
+        return true;
+    }
+
+    // Number of properties which are used (SampleTime, T_1 ... T_N and the added columns)
+    size_t PropertyCount()
+    {
+        return 1 + N + extraCount;
+    }
+
+    // The entity references the properties of the builder, so the builder must outlive it
+    AnalogTableEntity CreateEntity(az_span pPartitionKey, az_span pRowKey)
+    {
+        return AnalogTableEntity(pPartitionKey, pRowKey, az_span_create_from_str(Properties[0].Value), Properties, PropertyCount());
+    }
+
+    EntityProperty Properties[MaxPropertyCount];
+
+private:
+    size_t extraCount = 0;
+};
+
+#endif  // _ANALOGENTITYBUILDER_H_
@@ -17,10 +17,11 @@
             myProperties.RowKey = rowKey;
               
             myProperties.SampleTime = SampleTime;
-            myProperties.T_1 = az_span_create_from_str(pProperties[1].Value);
-            myProperties.T_2 = az_span_create_from_str(pProperties[2].Value);
-            myProperties.T_3 = az_span_create_from_str(pProperties[3].Value);
-            myProperties.T_4 = az_span_create_from_str(pProperties[4].Value);
+            // Tables may carry more or less than 4 columns (see AnalogEntityBuilder.h)
+            myProperties.T_1 = propertyCount > 1 ? az_span_create_from_str(pProperties[1].Value) : AZ_SPAN_EMPTY;
+            myProperties.T_2 = propertyCount > 2 ? az_span_create_from_str(pProperties[2].Value) : AZ_SPAN_EMPTY;
+            myProperties.T_3 = propertyCount > 3 ? az_span_create_from_str(pProperties[3].Value) : AZ_SPAN_EMPTY;
+            myProperties.T_4 = propertyCount > 4 ? az_span_create_from_str(pProperties[4].Value) : AZ_SPAN_EMPTY;
             
         //  this.JsonString = JsonConverter.Serialize(myProperties).ToString();
         }
@@ -3,6 +3,8 @@
 #include <TableEntityProperty.h>
 #include <TableEntity.h>
 
+#ifndef _ANALOG_TABLE_ENTITY_H_
+#define _ANALOG_TABLE_ENTITY_H_
 
 class AnalogTableEntity : public TableEntity
 {
@@ -25,4 +27,6 @@ class AnalogTableEntity : public TableEntity
 
         };
         
-};
\ No newline at end of file
+};
+
+#endif  // _ANALOG_TABLE_ENTITY_H_
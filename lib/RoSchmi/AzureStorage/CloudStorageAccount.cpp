@@ -39,6 +39,20 @@ void CloudStorageAccount::ChangeAccountParams(const String accountName, const St
 }
 
 
+void CloudStorageAccount::SetSasToken(const String sasToken)
+{
+    // A token copied from the portal starts with '?'
+    SasToken = sasToken.startsWith("?") ? sasToken.substring(1) : sasToken;
+    if (SasToken.length() > MAX_SAS_TOKEN_LENGTH)
+    {
+        SasToken = "";
+    }
+}
+
+bool CloudStorageAccount::UsesSas()
+{
+    return SasToken.length() > 0;
+}
 
 /**
  * destructor
@@ -6,6 +6,7 @@
 
 #define MAX_ACCOUNTNAME_LENGTH 50
 #define ACCOUNT_KEY_LENGTH     88
+#define MAX_SAS_TOKEN_LENGTH   200
 
 class CloudStorageAccount
 {
@@ -15,9 +16,16 @@ public:
     ~CloudStorageAccount();
 
     void ChangeAccountParams(const String accountName, const String accountKey, const bool useHttps, const bool useCaCert);
+
+    // With a Shared Access Signature the requests are not signed, the token is appended to the url
+    // (e.g. "sv=2019-02-02&ss=t&srt=sco&sp=rau&se=...&sig=..."), then the AccountKey is not needed
+    // An empty token switches back to SharedKey authentication
+    void SetSasToken(const String sasToken);
+    bool UsesSas();
     
     String AccountName;
     String AccountKey;
+    String SasToken;
     //String UriEndPointBlob;
     //String UriEndPointQueue;
     String UriEndPointTable;
@@ -12,10 +12,14 @@ uint8_t * _requestPtr;
 uint8_t * _propertiesPtr;
 uint8_t * _responsePtr;
 uint8_t * _authorizationHeaderBufferPtr;
+uint8_t * _batchPtr;
 
 char x_ms_timestamp[35] {0};
 char timestamp[22] {0};
 
+// Time to build, hash and sign the last request (before it is sent)
+uint32_t _prepareMicros = 0;
+
 //static SysTime sysTime;
       
         char * _OperationResponseBody;
@@ -31,30 +35,36 @@ az_span  getAcceptType_az_span(AcceptType pAcceptType);
 int base64_decode(const char * input, char * output);
 int32_t dow(int32_t year, int32_t month, int32_t day);
 void GetTableXml(EntityProperty EntityProperties[], size_t propertyCount, az_span outSpan, size_t *outSpanLength);
+bool GetTableJson(TableEntity pEntity, az_span outSpan, size_t *outSpanLength);
+bool appendStringToSpan(az_span * remainder, const char * stringToAppend);
+bool appendAndHashToSpan(az_span * remainder, const char * stringToAppend, mbedtls_md5_context * md5Context);
+void appendSasToUrl(String * url);
 DateTime GetDateTimeFromDateHeader(az_span x_ms_time);
 
 void TableClient::CreateTableAuthorizationHeader(const char * content, const char * canonicalResource, const char * const ptimeStamp, const char * pHttpVerb, az_span pContentType, char * pMD5HashHex, char * pAutorizationHeader, bool useSharedKeyLite)
 {  
-    char contentTypeString[25] {0};
+    char contentTypeString[60] {0};    // must hold 'multipart/mixed; boundary=batch_...' 
 
     char _timeStamp[35] {0};
     strcpy(_timeStamp, ptimeStamp);
 
     az_span_to_str(contentTypeString, (az_span_size(pContentType) + 1), pContentType);                                                                              
     
-    if (!useSharedKeyLite)
+    // If content is nullptr, the Md5 hash was calculated while the body was generated
+    if (!useSharedKeyLite && content != nullptr)
     {               
         // How to produce Md5 hash:
         //https://community.mongoose-os.com/t/md5-library-setup-and-config-examples/856
 
         // create Md5Hash           
-        const size_t Md5HashStrLenght = 16 + 1;
-        char md5HashStr[Md5HashStrLenght] {0};
-        
-        __unused int createMd5Result = createMd5Hash(md5HashStr, Md5HashStrLenght, content);    
-
-        // Convert to hex-string
-        stringToHexString(pMD5HashHex, md5HashStr, (const char *)"");          
+        uint8_t md5Hash[16] {0};
+        mbedtls_md5_context md5Context;
+        md5HashInit(&md5Context);
+        md5HashUpdate(&md5Context, content, strlen(content));
+        md5HashFinish(&md5Context, md5Hash);
+
+        // Convert to hex-string (the binary hash can contain 0 bytes)
+        bytesToHexString(pMD5HashHex, md5Hash, sizeof(md5Hash));
     }
                         
     char toSign[(strlen(canonicalResource) + 100)];  // if counted correctly, at least 93 needed
@@ -135,14 +145,22 @@ TableClient::TableClient(CloudStorageAccount * account, const char * caCert, HTT
     _propertiesPtr = bufferStorePtr + REQUEST_BODY_BUFFER_LENGTH;
     _authorizationHeaderBufferPtr = bufferStorePtr + REQUEST_BODY_BUFFER_LENGTH + PROPERTIES_BUFFER_LENGTH;
     _responsePtr = bufferStorePtr + REQUEST_BODY_BUFFER_LENGTH + PROPERTIES_BUFFER_LENGTH + AUTH_HEADER_BUFFER_LENGTH;
+    _batchPtr = _responsePtr + RESPONSE_BUFFER_LENGTH;
     
 }
 TableClient::~TableClient()
 {};
 
+uint32_t TableClient::GetPrepareMicros()
+{
+  return _prepareMicros;
+}
+
 az_http_status_code TableClient::CreateTable(const char * tableName, DateTime pDateTimeUtcNow, ContType pContentType, 
 AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
 {
+   uint32_t prepareStartMicros = micros();
+
    // limit length of tablename to max_tablename_length
    char * validTableName = (char *)tableName;
    if (strlen(tableName) >  MAX_TABLENAME_LENGTH)
@@ -204,6 +222,7 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
   String TableEndPoint = _accountPtr->UriEndPointTable;
   String Host = _accountPtr->HostNameTable;
   String Url = TableEndPoint + "/Tables()";
+  appendSasToUrl(&Url);
   const char * HttpVerb = "POST";
 
   char accountName_and_Tables[MAX_ACCOUNTNAME_LENGTH + 12];
@@ -214,8 +233,17 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
   //char authorizationHeaderBuffer[100] {0};
   //_authorizationHeaderBufferPtr
 
-  CreateTableAuthorizationHeader((char *)_requestPtr, accountName_and_Tables, x_ms_timestampCopy, HttpVerb, 
-  contentTypeAzSpan, md5Buffer, (char *)_authorizationHeaderBufferPtr, useSharedKeyLite);
+  if (_accountPtr->UsesSas())
+  {
+    // The request is authorized by the token in the url, no Authorization and Content-MD5 header
+    _authorizationHeaderBufferPtr[0] = '\0';
+  }
+  else
+  {
+    CreateTableAuthorizationHeader((char *)_requestPtr, accountName_and_Tables, x_ms_timestampCopy, HttpVerb, 
+    contentTypeAzSpan, md5Buffer, (char *)_authorizationHeaderBufferPtr, useSharedKeyLite);
+  }
+  _prepareMicros = micros() - prepareStartMicros;
       
   az_storage_tables_client tabClient;        
   az_storage_tables_client_options options = az_storage_tables_client_options_default();
@@ -275,6 +303,8 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
  az_http_status_code TableClient::InsertTableEntity(const char * tableName, DateTime pDateTimeUtcNow, TableEntity pEntity, char * out_ETAG, DateTime * outResponsHeaderDate, 
  ContType pContentType, AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
 {
+  uint32_t prepareStartMicros = micros();
+
   char * validTableName = (char *)tableName;
   if (strlen(tableName) >  MAX_TABLENAME_LENGTH)
   {
@@ -367,29 +397,19 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
    //uint8_t * remainderBufAddress = (uint8_t *)remainderBuffer;
 
 
-   az_span remainder = az_span_create(_requestPtr, REQUEST_BODY_BUFFER_LENGTH);
+   // The body is hashed while it is generated, so it is not read a second time for the Md5 hash
+   // (with SAS authentication no hash is needed)
+   const char * bodyParts[] = { li1, li2, li3, li4, li5, li6, li7, li8, li9, li10, li11, li12, li13, li14, li15, li16, li17, li18, li19, li20, li21 };
+   mbedtls_md5_context md5Context;
+   mbedtls_md5_context * md5ContextPtr = _accountPtr->UsesSas() ? nullptr : &md5Context;
+   md5HashInit(&md5Context);
 
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li1));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li2));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li3));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li4));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li5));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li6));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li7));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li8));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li9));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li10));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li11));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li12));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li13));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li14));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li15));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li16));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li17));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li18));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li19));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li20));
-            remainder = az_span_copy(remainder, az_span_create_from_str((char *)li21));
+   // One byte is reserved for the terminating 0
+   az_span remainder = az_span_create(_requestPtr, REQUEST_BODY_BUFFER_LENGTH - 1);
+   for (size_t i = 0; i < sizeof(bodyParts) / sizeof(bodyParts[0]); i++)
+   {
+     appendAndHashToSpan(&remainder, bodyParts[i], md5ContextPtr);
+   }
     
   
   az_span_copy_u8(remainder, 0);
@@ -404,17 +424,29 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
    String Host = _accountPtr->HostNameTable;
 
    String Url = TableEndPoint + "/" + urlPath + "()";
+   appendSasToUrl(&Url);
    
   char accountName_and_Tables[MAX_ACCOUNTNAME_LENGTH + MAX_TABLENAME_LENGTH + 10];
   sprintf(accountName_and_Tables, "/%s/%s%s", (char *)_accountPtr->AccountName.c_str(), validTableName, (const char *)"()");
   
   // Create buffers to hold the results of MD5-hash and the value of the authorizationheader
   char md5Buffer[32 +1] {0};
+  uint8_t md5Hash[16] {0};
+  md5HashFinish(&md5Context, md5Hash);
   //char authorizationHeaderBuffer[65] {0};
 
   //CreateTableAuthorizationHeader((char *)addBufAddress, accountName_and_Tables, (const char *)x_ms_timestamp, HttpVerb, contentTypeAzSpan, md5Buffer, authorizationHeaderBuffer, useSharedKeyLite);
   //CreateTableAuthorizationHeader((char *)_requestPtr, accountName_and_Tables, x_ms_timestampCopy, HttpVerb, contentTypeAzSpan, md5Buffer, authorizationHeaderBuffer, useSharedKeyLite);
-  CreateTableAuthorizationHeader((char *)_requestPtr, accountName_and_Tables, x_ms_timestampCopy, HttpVerb, contentTypeAzSpan, md5Buffer, (char *)_authorizationHeaderBufferPtr, useSharedKeyLite);
+  if (_accountPtr->UsesSas())
+  {
+    _authorizationHeaderBufferPtr[0] = '\0';
+  }
+  else
+  {
+    bytesToHexString(md5Buffer, md5Hash, sizeof(md5Hash));
+    CreateTableAuthorizationHeader(nullptr, accountName_and_Tables, x_ms_timestampCopy, HttpVerb, contentTypeAzSpan, md5Buffer, (char *)_authorizationHeaderBufferPtr, useSharedKeyLite);
+  }
+  _prepareMicros = micros() - prepareStartMicros;
 
   // Create client to handle request    
   az_storage_tables_client tabClient;        
@@ -484,6 +516,181 @@ AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite)
 }
 
 
+// Entity group transaction, see:
+// https://learn.microsoft.com/en-us/rest/api/storageservices/performing-entity-group-transactions
+// The entities are sent in JSON format (shorter than Atom) as one changeset
+az_http_status_code TableClient::InsertTableEntities(const char * tableName, DateTime pDateTimeUtcNow, TableEntity pEntities[], size_t pEntityCount, DateTime * outResponsHeaderDate, bool useSharedKeyLite)
+{
+  char * validTableName = (char *)tableName;
+  if (strlen(tableName) >  MAX_TABLENAME_LENGTH)
+  {
+    validTableName[MAX_TABLENAME_LENGTH] = '\0';
+  }
+  if ((pEntityCount == 0) || (pEntityCount > MAX_BATCH_ENTITY_COUNT))
+  {
+    return AZ_HTTP_STATUS_CODE_BAD_REQUEST;
+  }
+  uint32_t prepareStartMicros = micros();
+
+  GetDateHeader(pDateTimeUtcNow, timestamp, x_ms_timestamp);
+
+  char x_ms_timestampCopy[35] {0};
+  strcpy((char *)x_ms_timestampCopy, x_ms_timestamp );
+
+  // The boundaries must not appear in the content
+  char batchBoundary[20] {0};
+  char changesetBoundary[24] {0};
+  sprintf(batchBoundary, "batch_%08x", (unsigned int)pDateTimeUtcNow.unixtime());
+  sprintf(changesetBoundary, "changeset_%08x", (unsigned int)pDateTimeUtcNow.unixtime());
+
+  char contentType[60] {0};
+  sprintf(contentType, "multipart/mixed; boundary=%s", batchBoundary);
+  az_span contentTypeAzSpan = az_span_create_from_str((char *)contentType);
+
+  String TableEndPoint = _accountPtr->UriEndPointTable;
+  String entityUrl = TableEndPoint + "/" + validTableName;
+
+  // One byte is reserved for the terminating 0
+  az_span remainder = az_span_create(_batchPtr, BATCH_BODY_BUFFER_LENGTH - 1);
+  az_span jsonSpan = az_span_create(_propertiesPtr, PROPERTIES_BUFFER_LENGTH);
+  size_t jsonLength = 0;
+  bool fits = true;
+
+  // The body is hashed while it is generated (with SAS authentication no hash is needed)
+  mbedtls_md5_context md5Context;
+  mbedtls_md5_context * md5ContextPtr = _accountPtr->UsesSas() ? nullptr : &md5Context;
+  md5HashInit(&md5Context);
+
+  fits = fits && appendAndHashToSpan(&remainder, "--", md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, batchBoundary, md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, "\r\nContent-Type: multipart/mixed; boundary=", md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, changesetBoundary, md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, "\r\n\r\n", md5ContextPtr);
+
+  for (size_t i = 0; i < pEntityCount; i++)
+  {
+    fits = fits && GetTableJson(pEntities[i], jsonSpan, &jsonLength);
+    fits = fits && appendAndHashToSpan(&remainder, "--", md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, changesetBoundary, md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, "\r\nContent-Type: application/http\r\nContent-Transfer-Encoding: binary\r\n\r\nPOST ", md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, entityUrl.c_str(), md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, " HTTP/1.1\r\nContent-Type: application/json\r\nAccept: application/json;odata=nometadata\r\n", md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, "Prefer: return-no-content\r\nDataServiceVersion: 3.0;\r\n\r\n", md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, (char *)_propertiesPtr, md5ContextPtr);
+    fits = fits && appendAndHashToSpan(&remainder, "\r\n", md5ContextPtr);
+  }
+
+  fits = fits && appendAndHashToSpan(&remainder, "--", md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, changesetBoundary, md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, "--\r\n--", md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, batchBoundary, md5ContextPtr);
+  fits = fits && appendAndHashToSpan(&remainder, "--\r\n", md5ContextPtr);
+
+  az_span_copy_u8(remainder, 0);
+
+  uint8_t md5Hash[16] {0};
+  md5HashFinish(&md5Context, md5Hash);
+  if (!fits)
+  {
+    return AZ_HTTP_STATUS_CODE_PAYLOAD_TOO_LARGE;
+  }
+
+  az_span content_to_upload = az_span_create_from_str((char *)_batchPtr);
+
+  String Url = TableEndPoint + "/$batch";
+  appendSasToUrl(&Url);
+  const char * HttpVerb = "POST";
+
+  char accountName_and_Batch[MAX_ACCOUNTNAME_LENGTH + 10];
+  sprintf(accountName_and_Batch, "/%s/%s", (char *)_accountPtr->AccountName.c_str(), (char *)"$batch");
+
+  char md5Buffer[32 +1] {0};
+  if (_accountPtr->UsesSas())
+  {
+    _authorizationHeaderBufferPtr[0] = '\0';
+  }
+  else
+  {
+    bytesToHexString(md5Buffer, md5Hash, sizeof(md5Hash));
+    CreateTableAuthorizationHeader(nullptr, accountName_and_Batch, x_ms_timestampCopy, HttpVerb, contentTypeAzSpan, md5Buffer, (char *)_authorizationHeaderBufferPtr, useSharedKeyLite);
+  }
+  _prepareMicros = micros() - prepareStartMicros;
+
+  az_storage_tables_client tabClient;        
+  az_storage_tables_client_options options = az_storage_tables_client_options_default();
+
+  if (az_storage_tables_client_init(
+      &tabClient, az_span_create_from_str((char *)Url.c_str()), AZ_CREDENTIAL_ANONYMOUS, &options)
+      != AZ_OK)
+  {
+      // possible breakpoint, if some something went wrong
+      volatile int dummy646 = 1;    
+  }
+
+  memset(_responsePtr, 0, RESPONSE_BUFFER_LENGTH);
+  // The last byte of the response buffer stays 0, so the response can be searched as string
+  az_span response_az_span = az_span_create(_responsePtr, RESPONSE_BUFFER_LENGTH - 1);
+  
+  az_http_response http_response;
+  if (az_result_failed(az_http_response_init(&http_response, response_az_span)))
+  {
+     volatile int dummy647 = 1;
+  }
+
+  az_storage_tables_upload_options uploadOptions = az_storage_tables_upload_options_default();
+  
+  uploadOptions._internal.acceptType = getAcceptType_az_span(AcceptType::acceptApplicationIjson);
+  uploadOptions._internal.contentType = contentTypeAzSpan;
+  uploadOptions._internal.perferType = getResponseType_az_span(ResponseType::dont_returnContent);
+
+  setHttpClient(_httpPtr);
+  setCaCert(_caCert);
+  setWiFiClient(_wifiClient);
+
+  __unused az_result const batch_upload_result = 
+  az_storage_tables_upload(&tabClient, content_to_upload, az_span_create_from_str(md5Buffer), az_span_create_from_str((char *)_authorizationHeaderBufferPtr), az_span_create_from_str((char *)x_ms_timestamp), &uploadOptions, &http_response);
+
+  az_http_response_status_line statusLine;
+
+  __unused az_result result = az_http_response_get_status_line(&http_response, &statusLine);
+
+  az_span dateName = AZ_SPAN_FROM_STR("Date");
+  char keyBuf[20] {0};
+  az_span headerKey = AZ_SPAN_FROM_BUFFER(keyBuf);
+  char valueBuf[50] {0};
+  az_span headerValue = AZ_SPAN_FROM_BUFFER(valueBuf);
+
+  for (int i = 0; i < 5; i++)
+  {
+    __unused az_result headerResult = az_http_response_get_next_header(&http_response, &headerKey, &headerValue);
+    if (az_span_is_content_equal(headerKey, dateName))
+    {
+      *outResponsHeaderDate = GetDateTimeFromDateHeader(headerValue);    
+    }
+  }
+
+  if (statusLine.status_code != AZ_HTTP_STATUS_CODE_ACCEPTED)
+  {
+    return statusLine.status_code;
+  }
+
+  // The request was accepted, the result of the changeset is in the multipart body.
+  // If an operation failed, the body contains only the response of this operation.
+  // (A long body of a successful changeset can be truncated, it contains only 2xx status lines)
+  const char * statusLinePrefix = "HTTP/1.1 ";
+  char * response = strstr((char *)_responsePtr, statusLinePrefix);   // the status line of the request itself
+  while ((response != NULL) && ((response = strstr(response + 1, statusLinePrefix)) != NULL))
+  {
+    int innerStatusCode = atoi(response + strlen(statusLinePrefix));
+    if (innerStatusCode >= 300)
+    {
+      return (az_http_status_code)innerStatusCode;
+    }
+  }
+  return statusLine.status_code;
+}
+
+
 DateTime GetDateTimeFromDateHeader(az_span x_ms_time)
 {
   char monthsOfTheYear[12][5] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
@@ -573,6 +780,89 @@ void GetTableXml(EntityProperty EntityProperties[], size_t propertyCount, az_spa
   *outSpanLength = outLength;
 }
 
+// Writes the entity as JSON object, e.g. {"PartitionKey":"Y2_2025-11","RowKey":"...","ActStatus":"On"}
+// Properties which are not of type Edm.String get an "@odata.type" annotation
+bool GetTableJson(TableEntity pEntity, az_span outSpan, size_t *outSpanLength)
+{
+  char prop[(MAX_ENTITYPROPERTY_NAME_LENGTH * 2) + (MAX_ENTITYPROPERTY_VALUE_LENGTH * 2) + MAX_ENTITYPROPERTY_TYPE_LENGTH + 30] {0};
+  char key[20] {0};
+
+  // One byte is reserved for the terminating 0
+  az_span remainder = az_span_slice(outSpan, 0, az_span_size(outSpan) - 1);
+  bool fits = appendStringToSpan(&remainder, "{\"PartitionKey\":\"");
+  az_span_to_str(key, sizeof(key), pEntity.PartitionKey);
+  fits = fits && appendStringToSpan(&remainder, key);
+  fits = fits && appendStringToSpan(&remainder, "\",\"RowKey\":\"");
+  az_span_to_str(key, sizeof(key), pEntity.RowKey);
+  fits = fits && appendStringToSpan(&remainder, key);
+  fits = fits && appendStringToSpan(&remainder, "\"");
+
+  for (size_t i = 0; i < pEntity.PropertyCount; i++)
+  {
+    EntityProperty * property = &pEntity.Properties[i];
+    if (strcmp(property ->Type, "Edm.String") != 0)
+    {
+      sprintf(prop, ",\"%s@odata.type\":\"%s\"", property ->Name, property ->Type);
+      fits = fits && appendStringToSpan(&remainder, prop);
+    }
+
+    // Quotes and backslashes in the value must be escaped
+    size_t length = sprintf(prop, ",\"%s\":\"", property ->Name);
+    for (const char * c = property ->Value; *c != '\0'; c++)
+    {
+      if ((*c == '"') || (*c == '\\'))
+      {
+        prop[length++] = '\\';
+      }
+      prop[length++] = *c;
+    }
+    prop[length++] = '"';
+    prop[length] = '\0';
+    fits = fits && appendStringToSpan(&remainder, prop);
+  }
+  fits = fits && appendStringToSpan(&remainder, "}");
+
+  az_span_copy_u8(remainder, 0);
+  *outSpanLength = az_span_size(outSpan) - 1 - az_span_size(remainder);
+  return fits;
+}
+
+// Returns false (and doesn't copy) if the string doesn't fit into the remainder
+bool appendStringToSpan(az_span * remainder, const char * stringToAppend)
+{
+  az_span source = az_span_create_from_str((char *)stringToAppend);
+  if (az_span_size(source) > az_span_size(*remainder))
+  {
+    return false;
+  }
+  *remainder = az_span_copy(*remainder, source);
+  return true;
+}
+
+// Appends the string and adds it to the Md5 hash of the body (md5Context nullptr: only appends)
+bool appendAndHashToSpan(az_span * remainder, const char * stringToAppend, mbedtls_md5_context * md5Context)
+{
+  if (!appendStringToSpan(remainder, stringToAppend))
+  {
+    return false;
+  }
+  if (md5Context != nullptr)
+  {
+    md5HashUpdate(md5Context, stringToAppend, strlen(stringToAppend));
+  }
+  return true;
+}
+
+// With SAS authentication the token is the query of the request url
+void appendSasToUrl(String * url)
+{
+  if (_accountPtr->UsesSas())
+  {
+    *url += "?";
+    *url += _accountPtr->SasToken;
+  }
+}
+
 void GetDateHeader(DateTime time, char * stamp, char * x_ms_time)
 {
   int32_t dayOfWeek = dow((int32_t)time.year(), (int32_t)time.month(), (int32_t)time.day());
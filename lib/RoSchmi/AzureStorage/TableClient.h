@@ -24,10 +24,15 @@
 
 #define MAX_TABLENAME_LENGTH 50
 #define RESPONSE_BUFFER_LENGTH 2000
-#define REQUEST_BODY_BUFFER_LENGTH 900
-#define PROPERTIES_BUFFER_LENGTH 300
+#define REQUEST_BODY_BUFFER_LENGTH 1600    // was 900, entities can now have up to 17 properties
+#define PROPERTIES_BUFFER_LENGTH 1000      // was 300
 #define AUTH_HEADER_BUFFER_LENGTH 100
 #define REQUEST_PREPARE_PTR_BUFFER_LENGTH 500
+#define BATCH_BODY_BUFFER_LENGTH 5000      // multipart body of an entity group transaction ($batch)
+#define MAX_BATCH_ENTITY_COUNT 6           // entities of one batch (Azure allows 100, here limited by BATCH_BODY_BUFFER_LENGTH)
+
+// The bufferStore passed to the constructor must have at least this length
+#define TABLE_CLIENT_BUFFER_STORE_LENGTH (REQUEST_BODY_BUFFER_LENGTH + PROPERTIES_BUFFER_LENGTH + AUTH_HEADER_BUFFER_LENGTH + RESPONSE_BUFFER_LENGTH + BATCH_BODY_BUFFER_LENGTH)
 
   typedef enum {
     contApplicationIatomIxml,
@@ -56,7 +61,23 @@ public:
 
     az_http_status_code CreateTable(const char * tableName, DateTime pDateTimeUtcNow, ContType pContentType = ContType::contApplicationIatomIxml, AcceptType pAcceptType = AcceptType::acceptApplicationIjson, ResponseType pResponseType = ResponseType::returnContent, bool useSharedKeyLight = false);
     az_http_status_code InsertTableEntity(const char * tableName, DateTime pDateTimeUtcNow, TableEntity pEntity, char* out_ETAG, DateTime * outResonseHeaderDate, ContType pContentType, AcceptType pAcceptType, ResponseType pResponseType, bool useSharedKeyLite = false);   
+
+    /**
+    * @brief Inserts up to MAX_BATCH_ENTITY_COUNT entities with one request (entity group transaction)
+    *        All entities must have the same PartitionKey. Either all entities are inserted or none
+    *
+    * @param[in] tableName The name of the table
+    * @param[in] pEntities The entities
+    * @param[in] pEntityCount The number of entities (1 - MAX_BATCH_ENTITY_COUNT)
+    * @param[out] outResponsHeaderDate The DateTime of the 'Date' header of the response
+    * @return 202 (Accepted) if all entities were inserted, otherwise the status code of the failed operation
+    */
+    az_http_status_code InsertTableEntities(const char * tableName, DateTime pDateTimeUtcNow, TableEntity pEntities[], size_t pEntityCount, DateTime * outResponsHeaderDate, bool useSharedKeyLite = false);
+    // content nullptr: pMd5Hash already holds the hex Md5 hash of the body (hashed while it was generated)
     void CreateTableAuthorizationHeader(const char * content, const char * canonicalResource, const char * ptimeStamp, const char * pHttpVerb, az_span pConentType, char * pMd5Hash, char pAutorizationHeader[], bool useSharedKeyLite = false);
     int32_t dow(int32_t year, int32_t month, int32_t day);
+
+    // Microseconds the last request needed to build the body, hash and sign it (SharedKey vs. SAS)
+    uint32_t GetPrepareMicros();
 };
 #endif 
\ No newline at end of file
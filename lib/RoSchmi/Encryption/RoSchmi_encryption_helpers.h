@@ -23,6 +23,31 @@ int base64_decodeRoSchmi(const char * input, char * output);
 
 int base64_encodeRoSchmi(const char * input, const size_t inputLength, char * output, const size_t outputLength);
 
+// Streaming API: the data can be hashed in chunks (init, update for each chunk, finish),
+// e.g. while a request body is generated. Finish releases the context
+// All functions return 0 if everthing worked o.k. and 1 in case of some error
+
+int md5HashInit(mbedtls_md5_context * ctx);
+
+int md5HashUpdate(mbedtls_md5_context * ctx, const char * input, size_t inputLength);
+
+int md5HashFinish(mbedtls_md5_context * ctx, uint8_t output16Bytes[16]);
+
+int sha256HashInit(mbedtls_sha256_context * ctx);
+
+int sha256HashUpdate(mbedtls_sha256_context * ctx, const char * input, size_t inputLength);
+
+int sha256HashFinish(mbedtls_sha256_context * ctx, uint8_t output32Bytes[32]);
+
+int hmacSha256Init(mbedtls_md_context_t * ctx, const char * key, size_t keyLength);
+
+int hmacSha256Update(mbedtls_md_context_t * ctx, const char * input, size_t inputLength);
+
+int hmacSha256Finish(mbedtls_md_context_t * ctx, uint8_t output32Bytes[32]);
+
+// Unlike stringToHexString the input may contain 0 bytes (binary hashes), output needs 2 * inputLength + 1 chars
+void bytesToHexString(char * output, const uint8_t * input, size_t inputLength);
+
 
 #ifdef __cplusplus
 }
@@ -7,14 +7,16 @@ int createSHA256Hash(char * output32Bytes, size_t outputLength, const char * inp
     if (outputLength >= 33)
     {
         uint8_t hmacResult[32];
-        mbedtls_md_context_t ctxSHA256;          
-        mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;            
-        mbedtls_md_init(&ctxSHA256);
-        volatile int setUpResult = mbedtls_md_setup(&ctxSHA256, mbedtls_md_info_from_type(md_type), 1); 
-        volatile int startResult = mbedtls_md_hmac_starts( &ctxSHA256, (const unsigned char *) key, keyLength);
-        volatile int updateResult = mbedtls_md_hmac_update(&ctxSHA256, (const unsigned char *) input, inputLength);
-        volatile int finishResult = mbedtls_md_hmac_finish(&ctxSHA256, hmacResult);
-        mbedtls_md_free(&ctxSHA256);
+        mbedtls_md_context_t ctxSHA256;
+        if (hmacSha256Init(&ctxSHA256, key, keyLength) != 0)
+        {
+            return 1;
+        }
+        hmacSha256Update(&ctxSHA256, input, inputLength);
+        if (hmacSha256Finish(&ctxSHA256, hmacResult) != 0)
+        {
+            return 1;
+        }
 
         char * ptr = &output32Bytes[0];
         for (int i = 0; i < 32; i++) {
@@ -40,31 +42,99 @@ int createMd5Hash(char * output17Bytes, size_t outputLength, const char * input)
     if (outputLength >= 17)
     {
         mbedtls_md5_context ctxMd5; 
-             
-        mbedtls_md5_init(&ctxMd5);
-        //RoSchmi
-        //mbedtls_md5_starts(&ctxMd5);
-        mbedtls_md5_starts_ret(&ctxMd5);   
-        mbedtls_md5_update(&ctxMd5, (const uint8_t*) input, strlen(input));           
-        mbedtls_md5_finish(&ctxMd5, md5hash);
+        md5HashInit(&ctxMd5);
+        md5HashUpdate(&ctxMd5, input, strlen(input));
+        if (md5HashFinish(&ctxMd5, md5hash) != 0)
+        {
+            return 1;
+        }
                 
         char * ptr = &output17Bytes[0];
         for (int i = 0; i < 16; i++) {
             ptr[i] = md5hash[i];
         }
         ptr[16] = '\0';
-
-        mbedtls_md5_free(&ctxMd5);
         return 0;
     }
     else
     {
-        int dummy34 = 1;
-        dummy34++;
         return 1;
     }  
 }
 
+int md5HashInit(mbedtls_md5_context * ctx)
+{
+    mbedtls_md5_init(ctx);
+    //RoSchmi
+    //mbedtls_md5_starts(ctx);
+    return mbedtls_md5_starts_ret(ctx) == 0 ? 0 : 1;
+}
+
+int md5HashUpdate(mbedtls_md5_context * ctx, const char * input, size_t inputLength)
+{
+    return mbedtls_md5_update_ret(ctx, (const uint8_t *) input, inputLength) == 0 ? 0 : 1;
+}
+
+int md5HashFinish(mbedtls_md5_context * ctx, uint8_t output16Bytes[16])
+{
+    int result = mbedtls_md5_finish_ret(ctx, output16Bytes);
+    mbedtls_md5_free(ctx);
+    return result == 0 ? 0 : 1;
+}
+
+int sha256HashInit(mbedtls_sha256_context * ctx)
+{
+    mbedtls_sha256_init(ctx);
+    return mbedtls_sha256_starts_ret(ctx, 0) == 0 ? 0 : 1;     // 0 = SHA-256 (not SHA-224)
+}
+
+int sha256HashUpdate(mbedtls_sha256_context * ctx, const char * input, size_t inputLength)
+{
+    return mbedtls_sha256_update_ret(ctx, (const uint8_t *) input, inputLength) == 0 ? 0 : 1;
+}
+
+int sha256HashFinish(mbedtls_sha256_context * ctx, uint8_t output32Bytes[32])
+{
+    int result = mbedtls_sha256_finish_ret(ctx, output32Bytes);
+    mbedtls_sha256_free(ctx);
+    return result == 0 ? 0 : 1;
+}
+
+int hmacSha256Init(mbedtls_md_context_t * ctx, const char * key, size_t keyLength)
+{
+    mbedtls_md_init(ctx);
+    if (mbedtls_md_setup(ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) != 0
+        || mbedtls_md_hmac_starts(ctx, (const unsigned char *) key, keyLength) != 0)
+    {
+        mbedtls_md_free(ctx);
+        return 1;
+    }
+    return 0;
+}
+
+int hmacSha256Update(mbedtls_md_context_t * ctx, const char * input, size_t inputLength)
+{
+    return mbedtls_md_hmac_update(ctx, (const unsigned char *) input, inputLength) == 0 ? 0 : 1;
+}
+
+int hmacSha256Finish(mbedtls_md_context_t * ctx, uint8_t output32Bytes[32])
+{
+    int result = mbedtls_md_hmac_finish(ctx, output32Bytes);
+    mbedtls_md_free(ctx);
+    return result == 0 ? 0 : 1;
+}
+
+void bytesToHexString(char * output, const uint8_t * input, size_t inputLength)
+{
+    const char _hexCharacterTable[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+    for (size_t i = 0; i < inputLength; i++)
+    {
+        output[2 * i] = _hexCharacterTable[(input[i] & 0xF0) >> 4];
+        output[2 * i + 1] = _hexCharacterTable[input[i] & 0x0F];
+    }
+    output[2 * inputLength] = '\0';
+}
+
 
 
 // result can be retrieved from output
@@ -102,6 +102,8 @@ class Timezone
     
     time_t  toLocal(const time_t& utc);
     time_t  toLocal(const time_t& utc, TimeChangeRule **tcr);
+    // RoSchmi: local time and the offset to UTC (minutes, incl. DST) with one lookup
+    time_t  toLocalWithOffset(const time_t& utc, int * offsetMinutes);
     time_t  toUTC(const time_t& local);
     bool    utcIsDST(const time_t& utc);
     bool    locIsDST(const time_t& local);
@@ -131,6 +133,7 @@ class Timezone
      void    calcTimeChanges(int yr);
      void    initTimeChanges();
      time_t  toTime_t(const TimeChangeRule& r, int yr);
+     int     utcSegment(const time_t& utc);
     
     TimeChangeRule m_dst;   // rule for start of dst or summer time for any year
     TimeChangeRule m_std;   // rule for start of standard time for any year
@@ -140,6 +143,15 @@ class Timezone
     time_t m_dstLoc;        // dst start for given/current year, given in local time
     time_t m_stdLoc;        // std time start for given/current year, given in local time
     
+    // RoSchmi: transition table of the cached year. The year is divided by the two changes
+    // into three segments, so a conversion is two compares and a table lookup
+    time_t  m_yearStartUTC = 0;   // Jan 1 00:00 of the cached year (UTC), empty range: not yet calculated
+    time_t  m_yearEndUTC = 0;     // Jan 1 00:00 of the following year (UTC)
+    time_t  m_firstChangeUTC;     // earlier of the two changes (UTC)
+    time_t  m_secondChangeUTC;    // later of the two changes (UTC)
+    int     m_segmentOffset[3];   // offset to UTC in minutes of the three segments
+    bool    m_segmentIsDST[3];
+    
     void      readTZData();
     void      writeTZData(int address);
     
@@ -238,6 +238,45 @@ void Timezone::calcTimeChanges(int yr)
   m_stdLoc = toTime_t(m_std, yr);
   m_dstUTC = m_dstLoc - m_std.offset * SECS_PER_MIN;
   m_stdUTC = m_stdLoc - m_dst.offset * SECS_PER_MIN;
+  
+  // RoSchmi: transition table for the cached conversions
+  tmElements_t tm;
+  tm.Hour   = 0;
+  tm.Minute = 0;
+  tm.Second = 0;
+  tm.Day    = 1;
+  tm.Month  = 1;
+  tm.Year   = yr - 1970;
+  m_yearStartUTC = makeTime(tm);
+  tm.Year   = yr + 1 - 1970;
+  m_yearEndUTC = makeTime(tm);
+  
+  bool dstFirst = m_dstUTC < m_stdUTC;      // northern hemisphere
+  bool noDST = m_dstUTC == m_stdUTC;        // daylight time not observed in this tz
+  m_firstChangeUTC  = dstFirst ? m_dstUTC : m_stdUTC;
+  m_secondChangeUTC = dstFirst ? m_stdUTC : m_dstUTC;
+  
+  m_segmentIsDST[0] = !noDST && !dstFirst;
+  m_segmentIsDST[1] = !noDST && dstFirst;
+  m_segmentIsDST[2] = m_segmentIsDST[0];
+  
+  for (int i = 0; i < 3; i++)
+  {
+    m_segmentOffset[i] = m_segmentIsDST[i] ? m_dst.offset : m_std.offset;
+  }
+}
+
+/*----------------------------------------------------------------------*
+   RoSchmi: Return the segment (0 - 2) of the cached year which
+   contains the given UTC time. The table is only recalculated
+   when the time is in another year.
+  ----------------------------------------------------------------------*/
+int Timezone::utcSegment(const time_t& utc)
+{
+  if (utc < m_yearStartUTC || utc >= m_yearEndUTC)
+    calcTimeChanges(year(utc));
+    
+  return (utc >= m_firstChangeUTC) + (utc >= m_secondChangeUTC);
 }
 
 /*----------------------------------------------------------------------*
@@ -246,16 +285,8 @@ void Timezone::calcTimeChanges(int yr)
   ----------------------------------------------------------------------*/
 bool Timezone::utcIsDST(const time_t& utc)
 {
-  // recalculate the time change points if needed
-  if (year(utc) != year(m_dstUTC)) 
-    calcTimeChanges(year(utc));
-
-  if (m_stdUTC == m_dstUTC)       // daylight time not observed in this tz
-    return false;
-  else if (m_stdUTC > m_dstUTC)   // northern hemisphere
-    return (utc >= m_dstUTC && utc < m_stdUTC);
-  else                            // southern hemisphere
-    return !(utc >= m_stdUTC && utc < m_dstUTC);
+  // RoSchmi: uses the transition table of the year
+  return m_segmentIsDST[utcSegment(utc)];
 }
 
 /*----------------------------------------------------------------------*
@@ -267,6 +298,10 @@ void Timezone::initTimeChanges()
   m_stdLoc = 0;
   m_dstUTC = 0;
   m_stdUTC = 0;
+  
+  // empty range: the next conversion calculates the table
+  m_yearStartUTC = 0;
+  m_yearEndUTC = 0;
 }
 
 /*----------------------------------------------------------------------*
@@ -489,14 +524,18 @@ void Timezone::initStorage(uint32_t address)
   ----------------------------------------------------------------------*/
 time_t Timezone::toLocal(const time_t& utc)
 {
-  // recalculate the time change points if needed
-  if (year(utc) != year(m_dstUTC)) 
-    calcTimeChanges(year(utc));
+  return utc + m_segmentOffset[utcSegment(utc)] * SECS_PER_MIN;
+}
 
-  if (utcIsDST(utc))
-    return utc + m_dst.offset * SECS_PER_MIN;
-  else
-    return utc + m_std.offset * SECS_PER_MIN;
+/*----------------------------------------------------------------------*
+   RoSchmi: Convert the given UTC time to local time and return
+   the offset to UTC in minutes (incl. DST) as well.
+  ----------------------------------------------------------------------*/
+time_t Timezone::toLocalWithOffset(const time_t& utc, int * offsetMinutes)
+{
+  int offset = m_segmentOffset[utcSegment(utc)];
+  *offsetMinutes = offset;
+  return utc + offset * SECS_PER_MIN;
 }
 /*----------------------------------------------------------------------*
    Read or update the daylight and standard time rules from RAM.
@@ -0,0 +1,194 @@
+#include <Arduino.h>
+#include <Datetime.h>
+#include "DataContainerWio.h"
+
+#ifndef _ANALOGROLLUP_H_
+#define _ANALOGROLLUP_H_
+
+// Aggregation periods of the rollup
+enum class RollupPeriod
+{
+    Hour = 0,
+    Day = 1
+};
+
+#define ROLLUP_PERIODS_COUNT 2
+
+// One completed aggregation period (one row of a ...Hours or ...Days table)
+template<size_t N>
+struct RollupRowT
+{
+    DateTime Start = DateTime();      // local time of the begin of the period
+    DateTime End = DateTime();        // local time of the last second of the period
+    IntervalStats Stats[N];
+};
+
+// Aggregates the readings of N analog channels into hourly and daily
+// min/max/mean values. A period is closed with the first reading of the
+// next period, then the row can be retrieved and written to Azure
+// Charts4Azure month and year views then need only a few rows
+template<size_t N>
+class AnalogRollupT
+{
+public:
+    typedef RollupRowT<N> RollupRow;
+    static constexpr size_t ChannelCount = N;
+
+    AnalogRollupT(float pMagicNumberInvalid = 999.9);
+
+    /**
+    * @brief Adds a reading of one channel to the running hour and day
+    *
+    * @param[in] pIndex The index of the channel (0 - N-1)
+    * @param[in] pLocalTime The local time of the reading
+    * @param[in] pValue The reading (MagicNumberInvalid is ignored)
+    */
+    void AddSample(uint32_t pIndex, DateTime pLocalTime, float pValue);
+
+    // Returns true if a completed period is waiting to be sent
+    bool HasToBeSent(RollupPeriod pPeriod);
+
+    /**
+    * @brief Returns the completed period, it stays waiting until AckRow() is called
+    *
+    * @param[in] pPeriod RollupPeriod::Hour or RollupPeriod::Day
+    */
+    RollupRow PeekRow(RollupPeriod pPeriod);
+
+    // The row of the period was stored in Azure, it is not sent again
+    void AckRow(RollupPeriod pPeriod);
+
+    float MagicNumberInvalid = 999.9;
+
+    // Year of the ...Hours and ...Days table which was created last
+    uint16_t Year[ROLLUP_PERIODS_COUNT] = {1900, 1900};
+
+private:
+    typedef struct
+    {
+        uint32_t Count = 0;
+        float Min = 0.0;
+        float Max = 0.0;
+        float Mean = 0.0;
+        float M2 = 0.0;
+    }
+    Accumulator;
+
+    typedef struct
+    {
+        bool IsOpen = false;
+        DateTime Start = DateTime();
+        Accumulator Accumulators[N];
+    }
+    Bucket;
+
+    static DateTime periodStart(RollupPeriod pPeriod, DateTime pLocalTime);
+    static DateTime periodEnd(RollupPeriod pPeriod, DateTime pStart);
+    void closeBucket(int pPeriod);
+
+    Bucket _buckets[ROLLUP_PERIODS_COUNT];
+    RollupRow _rows[ROLLUP_PERIODS_COUNT];
+    bool _hasToBeSent[ROLLUP_PERIODS_COUNT] = {false};
+};
+
+// The rollup for the containers with 4 channels which are used in this App
+typedef AnalogRollupT<4> AnalogRollup;
+
+template<size_t N>
+AnalogRollupT<N>::AnalogRollupT(float pMagicNumberInvalid)
+{
+    MagicNumberInvalid = pMagicNumberInvalid;
+}
+
+template<size_t N>
+DateTime AnalogRollupT<N>::periodStart(RollupPeriod pPeriod, DateTime pLocalTime)
+{
+    return pPeriod == RollupPeriod::Hour ? DateTime(pLocalTime.year(), pLocalTime.month(), pLocalTime.day(), pLocalTime.hour(), 0, 0)
+                                         : DateTime(pLocalTime.year(), pLocalTime.month(), pLocalTime.day(), 0, 0, 0);
+}
+
+template<size_t N>
+DateTime AnalogRollupT<N>::periodEnd(RollupPeriod pPeriod, DateTime pStart)
+{
+    return pPeriod == RollupPeriod::Hour ? pStart.operator+(TimeSpan(0, 0, 59, 59)) : pStart.operator+(TimeSpan(0, 23, 59, 59));
+}
+
+template<size_t N>
+void AnalogRollupT<N>::AddSample(uint32_t pIndex, DateTime pLocalTime, float pValue)
+{
+    if (pIndex >= N || (pValue < (MagicNumberInvalid + 0.11) && pValue > (MagicNumberInvalid - 0.11)))
+    {
+        return;
+    }
+    for (int p = 0; p < ROLLUP_PERIODS_COUNT; p++)
+    {
+        DateTime start = periodStart((RollupPeriod)p, pLocalTime);
+        if (_buckets[p].IsOpen && start.operator!=(_buckets[p].Start))
+        {
+            closeBucket(p);
+        }
+        if (!_buckets[p].IsOpen)
+        {
+            _buckets[p] = Bucket();
+            _buckets[p].IsOpen = true;
+            _buckets[p].Start = start;
+        }
+        Accumulator * acc = &_buckets[p].Accumulators[pIndex];
+        acc ->Count++;
+        if (acc ->Count == 1)
+        {
+            acc ->Min = pValue;
+            acc ->Max = pValue;
+        }
+        else
+        {
+            acc ->Min = pValue < acc ->Min ? pValue : acc ->Min;
+            acc ->Max = pValue > acc ->Max ? pValue : acc ->Max;
+        }
+        float delta = pValue - acc ->Mean;
+        acc ->Mean += delta / acc ->Count;
+        acc ->M2 += delta * (pValue - acc ->Mean);
+    }
+}
+
+template<size_t N>
+void AnalogRollupT<N>::closeBucket(int pPeriod)
+{
+    // A row which was not acknowledged before (e.g. Azure not reachable for a whole period)
+    // is overwritten by the newer one
+    RollupRow * row = &_rows[pPeriod];
+    row ->Start = _buckets[pPeriod].Start;
+    row ->End = periodEnd((RollupPeriod)pPeriod, _buckets[pPeriod].Start);
+    for (size_t i = 0; i < N; i++)
+    {
+        Accumulator * acc = &_buckets[pPeriod].Accumulators[i];
+        IntervalStats * stats = &row ->Stats[i];
+        stats ->Count = acc ->Count;
+        stats ->Min = acc ->Count > 0 ? acc ->Min : MagicNumberInvalid;
+        stats ->Max = acc ->Count > 0 ? acc ->Max : MagicNumberInvalid;
+        stats ->Mean = acc ->Count > 0 ? acc ->Mean : MagicNumberInvalid;
+        stats ->Variance = acc ->Count > 1 ? acc ->M2 / (acc ->Count - 1) : 0.0;
+    }
+    _buckets[pPeriod].IsOpen = false;
+    _hasToBeSent[pPeriod] = true;
+}
+
+template<size_t N>
+bool AnalogRollupT<N>::HasToBeSent(RollupPeriod pPeriod)
+{
+    return _hasToBeSent[(int)pPeriod];
+}
+
+template<size_t N>
+RollupRowT<N> AnalogRollupT<N>::PeekRow(RollupPeriod pPeriod)
+{
+    return _rows[(int)pPeriod];
+}
+
+template<size_t N>
+void AnalogRollupT<N>::AckRow(RollupPeriod pPeriod)
+{
+    _hasToBeSent[(int)pPeriod] = false;
+}
+
+#endif  // _ANALOGROLLUP_H_
@@ -1,12 +1,11 @@
 #include <Arduino.h>
 #include <Datetime.h>
 #include "config.h"
+#include "SensorScheduler.h"
 
 #ifndef _ANALOGSENSORMGR_H_
 #define _ANALOGSENSORMGR_H_
 
-#define SENSOR_COUNT 4
-
 typedef struct
 {
     // For Sensors which can read up to three values with one command
@@ -19,23 +18,166 @@ typedef struct
 }
 AnalogSensor;
 
-class AnalogSensorMgr
+// Manages the read intervals of N sensors (channels) of one group
+template<size_t N>
+class AnalogSensorMgrT
 {
     public:
-    
-    AnalogSensorMgr(float pMagicNumberInvalid);
+
+    static constexpr size_t SensorCount = N;
+
+    AnalogSensorMgrT(float pMagicNumberInvalid);
     void SetReadInterval(uint32_t pInterval);
     void SetReadInterval(int sensorIndex, uint32_t pInterval);
     bool HasToBeRead(int pSensorIndex, DateTime now, bool pReset = false);
     void SetReadTimeAndValues(int pSensorIndex, DateTime now, float pReadValue_1, float pReadValue_2, float pReadValue_3);
-    
+
     AnalogSensor GetSensorDates(int pSensorIndex);
-    
-    AnalogSensor readValues[SENSOR_COUNT];
-    
+
+    /**
+    * @brief Registers the sensors of this group in a scheduler, which then
+    *        always knows the time when the next sensor of all groups has to be read
+    *
+    * @param[in] pScheduler The scheduler which is shared by all groups
+    * @param[in] pSource The number of this group in the scheduler
+    * @param[in] pChannelMask Bit i set: sensor i is read with HasToBeRead() and gets a deadline
+    *            Sensors which are never read would stay due forever
+    * @return false if the scheduler has no room for the sensors
+    */
+    bool AttachScheduler(SensorScheduler * pScheduler, uint8_t pSource, uint32_t pChannelMask = UINT32_MAX);
+
+    // Inactive sensors are never due and have no deadline in the scheduler
+    void SetSensorActive(int pSensorIndex, bool pIsActive);
+
+    AnalogSensor readValues[N];
+
+    float MagicNumberInvalid = 999.9;
+
     private:
-      
+    void updateDeadline(int pSensorIndex);
+
+    SensorScheduler * scheduler = nullptr;
+    int schedulerIds[N];
 };
 
-#endif  // _ANALOGSENSORMGR_H_
+// The sensor manager with 4 sensors which is used in this App
+typedef AnalogSensorMgrT<4> AnalogSensorMgr;
 
+template<size_t N>
+AnalogSensorMgrT<N>::AnalogSensorMgrT(float pMagicNumberInvalid)
+{
+    MagicNumberInvalid = pMagicNumberInvalid;
+}
+
+template<size_t N>
+void AnalogSensorMgrT<N>::SetReadInterval(uint32_t pInterval)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        readValues[i].ReadInterval = TimeSpan(pInterval);
+        updateDeadline(i);
+    }
+}
+
+template<size_t N>
+void AnalogSensorMgrT<N>::SetReadInterval(int sensorIndex, uint32_t pInterval)
+{
+    readValues[sensorIndex].ReadInterval = TimeSpan(pInterval);
+    updateDeadline(sensorIndex);
+}
+
+template<size_t N>
+bool AnalogSensorMgrT<N>::HasToBeRead(int pSensorIndex, DateTime now, bool pReset)
+{
+    // For each sensor (index 0 - N-1) of this group a dedicated Timespan
+    // is set. Only when this timespan has expired, the value is tranferred to DataContainerWio
+    // Only in rate conditions it is needed to set these timespans to longer values
+
+    if (readValues[pSensorIndex].IsActive && now.operator>(readValues[pSensorIndex].LastReadTime.operator+(readValues[pSensorIndex].ReadInterval)))
+    {
+        #if SERIAL_PRINT == 1
+        Serial.printf("Transf value of AI (VI)-Sensor to DataCont. Interval: %d Id: %d after %d secs\n",readValues[pSensorIndex].ReadInterval.totalseconds(),
+           pSensorIndex, now.secondstime() - readValues[pSensorIndex].LastReadTime.secondstime());
+        #endif
+
+        // Set LastReadTime to actual time if wanted
+        if (pReset)
+        {
+            readValues[pSensorIndex].LastReadTime = now;
+            updateDeadline(pSensorIndex);
+        }
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<size_t N>
+void AnalogSensorMgrT<N>::SetReadTimeAndValues(int pSensorIndex, DateTime now, float pReadValue_1, float pReadValue_2, float pReadValue_3)
+{
+    readValues[pSensorIndex].LastReadTime = now;
+    readValues[pSensorIndex].Value_1 = pReadValue_1;
+    readValues[pSensorIndex].Value_2 = pReadValue_2;
+    readValues[pSensorIndex].Value_3 = pReadValue_3;
+    updateDeadline(pSensorIndex);
+}
+
+template<size_t N>
+AnalogSensor AnalogSensorMgrT<N>::GetSensorDates(int pSensorIndex)
+{
+    return readValues[pSensorIndex];
+}
+
+template<size_t N>
+bool AnalogSensorMgrT<N>::AttachScheduler(SensorScheduler * pScheduler, uint8_t pSource, uint32_t pChannelMask)
+{
+    scheduler = pScheduler;
+    for (size_t i = 0; i < N; i++)
+    {
+        schedulerIds[i] = SENSOR_SCHEDULER_INVALID_ID;
+    }
+    for (size_t i = 0; i < N; i++)
+    {
+        if ((pChannelMask & (1UL << i)) == 0)
+        {
+            continue;
+        }
+        schedulerIds[i] = scheduler ->Register(pSource, i);
+        if (schedulerIds[i] == SENSOR_SCHEDULER_INVALID_ID)
+        {
+            return false;
+        }
+        updateDeadline(i);
+    }
+    return true;
+}
+
+template<size_t N>
+void AnalogSensorMgrT<N>::SetSensorActive(int pSensorIndex, bool pIsActive)
+{
+    readValues[pSensorIndex].IsActive = pIsActive;
+    updateDeadline(pSensorIndex);
+}
+
+template<size_t N>
+void AnalogSensorMgrT<N>::updateDeadline(int pSensorIndex)
+{
+    if (scheduler == nullptr || schedulerIds[pSensorIndex] == SENSOR_SCHEDULER_INVALID_ID)
+    {
+        return;
+    }
+    if (readValues[pSensorIndex].IsActive)
+    {
+        // HasToBeRead() is true when the interval is exceeded, so one second more
+        DateTime due = readValues[pSensorIndex].LastReadTime.operator+(readValues[pSensorIndex].ReadInterval).operator+(TimeSpan(1));
+        scheduler ->Schedule(schedulerIds[pSensorIndex], due);
+    }
+    else
+    {
+        scheduler ->Unschedule(schedulerIds[pSensorIndex]);
+    }
+}
+
+#endif  // _ANALOGSENSORMGR_H_
@@ -4,7 +4,7 @@
 #ifndef _DATACONTAINERWIO_H_
 #define _DATACONTAINERWIO_H_
 
-#define PROPERTY_COUNT 4
+#define LAST_SAMPLES_COUNT 8     // Number of last samples kept per channel (must be a power of two)
 
 typedef struct
 {
@@ -13,6 +13,34 @@ typedef struct
   float thisDayBaseValue;
 }  ValueStruct;
 
+// Defines when a channel causes the container to be sent
+enum class SendPolicy
+{
+    Interval,       // send when SendInterval has elapsed
+    Deadband        // send when the value moved beyond the deadband since the last send,
+                    // or at the latest when the heartbeat interval has elapsed
+};
+
+typedef struct
+{
+    SendPolicy Policy = SendPolicy::Interval;
+    float Deadband = 0.0;
+    TimeSpan Heartbeat = TimeSpan(0, 1, 0, 0);
+    float LastSentValue = 999.9;
+}
+ChannelSendPolicy;
+
+// Statistics of the samples of one channel in one send interval
+typedef struct
+{
+    uint32_t Count = 0;
+    float Min = 999.9;
+    float Max = 999.9;
+    float Mean = 999.9;
+    float Variance = 0.0;
+}
+IntervalStats;
+
 typedef struct
 {
     uint32_t feedCount = 0;
@@ -23,40 +51,77 @@ typedef struct
     float UnClippedValue = 0.0;
     float LastValue = 999.9;
     float UnClippedLastValue = 0.0;
-    float LastSendUnClippedValue = 0; 
-    DateTime LastUpdateValueTime = DateTime();   
-    DateTime LastSendTime;  
+    float LastSendUnClippedValue = 0;
+    DateTime LastUpdateValueTime = DateTime();
+    DateTime LastSendTime;
+    IntervalStats Stats;    // is set when the values are retrieved from the container
 }
-SampleValue; 
-    
-typedef struct
-{  
+SampleValue;
+
+template<size_t N>
+struct SampleValueSetT
+{
     DateTime LastSendTime = DateTime();
     DateTime LastUpdateTime= DateTime();
     DateTime SecondToLastUpdateTime = DateTime();
-    SampleValue SampleValues[PROPERTY_COUNT];
+    SampleValue SampleValues[N];
+};
+
+// Fixed point sample with one place after the decimal point (e.g. temperatures)
+// needs half the memory of a float sample
+typedef struct
+{
+    int16_t Raw = 0;
 }
-SampleValueSet; 
+FixedPoint1;
+
+// Conversion of the type in which the last samples are stored from/to float
+template<typename Sample>
+struct SampleTraits
+{
+    static Sample FromFloat(float pValue) { return (Sample)pValue; }
+    static float ToFloat(Sample pSample) { return (float)pSample; }
+};
+
+template<>
+struct SampleTraits<FixedPoint1>
+{
+    static FixedPoint1 FromFloat(float pValue)
+    {
+        FixedPoint1 sample;
+        float scaled = pValue * 10.0f;
+        scaled = scaled > 32767.0f ? 32767.0f : (scaled < -32768.0f ? -32768.0f : scaled);
+        sample.Raw = (int16_t)lroundf(scaled);
+        return sample;
+    }
+    static float ToFloat(FixedPoint1 pSample) { return (float)pSample.Raw / 10.0f; }
+};
 
-class DataContainerWio
+// Container for N analog channels which are sent together in one table row
+// N is the number of channels (columns T_1 ... T_N)
+// Sample is the type in which the last samples of each channel are stored (float or FixedPoint1)
+template<size_t N, typename Sample = float>
+class DataContainerT
 {
 
 public:
-    
-    DataContainerWio(TimeSpan pSendInterval, TimeSpan pInvalidateInterval, float pLowerLimit, float pUpperLimit, float pMagicNumberInvalid); 
-    
-    String floToStr(float value);   
+    static constexpr size_t ChannelCount = N;
+
+    typedef SampleValueSetT<N> SampleValueSetType;
+
+    DataContainerT(TimeSpan pSendInterval, TimeSpan pInvalidateInterval, float pLowerLimit, float pUpperLimit, float pMagicNumberInvalid);
+
     SampleValue checkedSampleValue(SampleValue inSampleValue, float lowLimit, float upperLimit, float invalidSubstitute,  DateTime actDateTime, TimeSpan);
-    
+
     void SetNewValue(uint32_t pIndex, DateTime pActDateTime, float pSampleValue);
-    
+
     void SetNewValueStruct(uint32_t pIndex, DateTime pActDateTime, ValueStruct pValueSet, bool pIsConsumption);
-    
 
-    SampleValueSet getCheckedSampleValues(DateTime pActDateTime, bool pUpdateSentFlags);
-      
-    SampleValueSet getSampleValues(DateTime pActDateTime, bool pUpdateSentFlags);
-    
+
+    SampleValueSetType getCheckedSampleValues(DateTime pActDateTime, bool pUpdateSentFlags = true);
+
+    SampleValueSetType getSampleValues(DateTime pActDateTime, bool pUpdateSentFlags = true);
+
     void setHasToBeSentFlag();
     bool hasToBeSent();
     void setLowerLimit(float pLowerLimit);
@@ -65,12 +130,38 @@ public:
     /**
     * @brief Sets the Year (of the last upload)
     *
-    * @param[in] sensorIndex The index of 4 OnOff-Tables (0 - 3)
-    * @param[in] year The year 
-    * 
-    */  
+    * @param[in] year The year
+    *
+    */
     void Set_Year(uint16_t year);
 
+    /**
+    * @brief Gets min, max, mean and variance of the samples of the running send interval
+    *
+    * @param[in] pIndex The index of the channel (0 - N-1)
+    */
+    IntervalStats GetIntervalStats(uint32_t pIndex);
+
+    /**
+    * @brief Copies the last samples of a channel (oldest first)
+    *
+    * @param[in] pIndex The index of the channel (0 - N-1)
+    * @param[out] outSamples Buffer for the samples
+    * @param[in] pMaxCount Length of the buffer
+    * @return The number of samples copied (max LAST_SAMPLES_COUNT)
+    */
+    uint32_t GetLastSamples(uint32_t pIndex, float * outSamples, uint32_t pMaxCount);
+
+    /**
+    * @brief Sets the send policy of a channel (report by exception)
+    *
+    * @param[in] pIndex The index of the channel (0 - N-1)
+    * @param[in] pPolicy SendPolicy::Interval (default) or SendPolicy::Deadband
+    * @param[in] pDeadband Minimal change of the value which causes a send (only SendPolicy::Deadband)
+    * @param[in] pHeartbeat Maximal time between two sends (only SendPolicy::Deadband)
+    */
+    void SetSendPolicy(uint32_t pIndex, SendPolicy pPolicy, float pDeadband, TimeSpan pHeartbeat);
+
     bool _isFirstTransmission = true;
 
     TimeSpan SendInterval;
@@ -81,12 +172,331 @@ public:
 
     bool _hasToBeSent = false;
     uint16_t Year = 1900;
-    
+
     //RoSchmi added 27.03.25
     float _baseValue;
     DateTime _lastSentTime;
-    SampleValue SampleValues[PROPERTY_COUNT];
-    SampleValueSet _SampleValuesSet;
+    SampleValue SampleValues[N];
+    SampleValueSetType _SampleValuesSet;
+
+private:
+    // Running values of the send interval (Welford's algorithm), O(1) per sample
+    typedef struct
+    {
+        uint32_t Count = 0;
+        float Min = 0.0;
+        float Max = 0.0;
+        float Mean = 0.0;
+        float M2 = 0.0;
+    }
+    IntervalAccumulator;
+
+    void addToInterval(uint32_t pIndex, float pValue);
+    void resetInterval(uint32_t pIndex);
+    void prepareSend(DateTime pActDateTime);
+
+    IntervalAccumulator _intervalAccumulators[N];
+    Sample _lastSamples[N][LAST_SAMPLES_COUNT];
+    uint32_t _lastSamplesWriteCount[N] = {0};
+
+    bool channelHasToBeSent(uint32_t pIndex, DateTime pActDateTime, float pValue);
+    void updateLastSentValues();
+
+    ChannelSendPolicy _sendPolicies[N];
 };
 
-#endif  // _DATACONTAINERWIO_H_
\ No newline at end of file
+// The container with 4 channels (T_1 ... T_4) which is used in this App
+typedef DataContainerT<4> DataContainerWio;
+typedef SampleValueSetT<4> SampleValueSet;
+
+template<size_t N, typename Sample>
+SampleValue DataContainerT<N, Sample>::checkedSampleValue(SampleValue inSampleValue, float lowerLimit, float upperLimit, float invalidateSubstitute, DateTime actDateTime, TimeSpan invalidateTime)
+{
+    SampleValue workSampleValue = inSampleValue;
+
+    workSampleValue.AverageValue = ((inSampleValue.AverageValue < lowerLimit) || (inSampleValue.AverageValue > upperLimit)) ? invalidateSubstitute : inSampleValue.AverageValue;
+    workSampleValue.Value = ((inSampleValue.Value < lowerLimit) || (inSampleValue.Value > upperLimit)) ? invalidateSubstitute : inSampleValue.Value;
+    if (actDateTime.operator-(invalidateTime).operator>=(workSampleValue.LastSendTime))
+    {
+        workSampleValue.AverageValue = invalidateSubstitute;
+        workSampleValue.Value = invalidateSubstitute;
+        workSampleValue.Stats.Count = 0;
+    }
+    if (workSampleValue.Stats.Count == 0)
+    {
+        workSampleValue.Stats.Min = invalidateSubstitute;
+        workSampleValue.Stats.Max = invalidateSubstitute;
+        workSampleValue.Stats.Mean = invalidateSubstitute;
+        workSampleValue.Stats.Variance = 0.0;
+    }
+    return workSampleValue;
+}
+
+template<size_t N, typename Sample>
+DataContainerT<N, Sample>::DataContainerT(TimeSpan pSendInterval, TimeSpan pInvalidateInterval, float pLowerLimit, float pUpperLimit, float pMagicNumberInvalid)
+{
+    SendInterval = pSendInterval,
+    InvalidateInterval = pInvalidateInterval;
+    LowerLimit = pLowerLimit;
+    UpperLimit = pUpperLimit;
+    MagicNumberInvalid = pMagicNumberInvalid;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::SetNewValue(uint32_t pIndex, DateTime pActDateTime, float pSampleValue)
+{
+    ValueStruct transferValueStruct = {
+        .displayValue = pSampleValue,
+        .unClippedValue = pSampleValue,
+        .thisDayBaseValue = 55.0 };
+    SetNewValueStruct(pIndex, pActDateTime, transferValueStruct, false);
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::SetNewValueStruct(uint32_t pIndex, DateTime pActDateTime, ValueStruct pValueStruct, bool pIsConsumption)
+{
+    // Ignore invalid readings with value 999.9 (MagicNumberInvalid)
+
+    if (pValueStruct.displayValue > (MagicNumberInvalid + 0.11) || pValueStruct.displayValue < (MagicNumberInvalid - 0.11))
+    {
+        if (!pIsConsumption)
+        {
+            SampleValues[pIndex].feedCount++;
+            SampleValues[pIndex].SummedValues += pValueStruct.displayValue;
+            SampleValues[pIndex].AverageValue = SampleValues[pIndex].SummedValues / SampleValues[pIndex].feedCount;
+        }
+
+        addToInterval(pIndex, pValueStruct.displayValue);
+
+        if (pIsConsumption)
+        {
+            SampleValues[pIndex].BaseValue = pValueStruct.thisDayBaseValue;
+        }
+
+        SampleValues[pIndex].LastValue = SampleValues[pIndex].Value;
+        SampleValues[pIndex].UnClippedLastValue = SampleValues[pIndex].UnClippedValue;
+
+        SampleValues[pIndex].UnClippedValue = pValueStruct.unClippedValue;
+        SampleValues[pIndex].Value = pValueStruct.displayValue;
+
+        // RoSchmi evaluate if next line is correct
+        SampleValues[pIndex].LastSendTime = pActDateTime;
+        // RoSchmi new 04.04.25
+        SampleValues[pIndex].LastUpdateValueTime = pActDateTime;
+        _SampleValuesSet.SecondToLastUpdateTime = _SampleValuesSet.LastUpdateTime;
+        _SampleValuesSet.LastUpdateTime = pActDateTime;
+
+
+        if (_isFirstTransmission)
+        {
+             _hasToBeSent = true;
+            _lastSentTime = pActDateTime;
+            _isFirstTransmission = false;
+
+            SampleValues[pIndex].LastSendTime = pActDateTime;
+            SampleValues[pIndex].LastSendUnClippedValue = SampleValues[pIndex].UnClippedValue;
+            Serial.println(F("Set new value in first transmission"));
+        }
+        else
+        {                  // SendInterval elapsed (or deadband exceeded/heartbeat elapsed)
+            if (channelHasToBeSent(pIndex, pActDateTime, pValueStruct.displayValue))
+            {
+               #if SERIAL_PRINT == 1
+               Serial.println(F("AiOnTheEdge Sent Flag set ************"));
+               #endif
+
+            // RoSchmi: next line deleted, is already done in getCheckedSampleValues
+              _lastSentTime = pActDateTime;
+
+            SampleValues[pIndex].LastSendUnClippedValue = SampleValues[pIndex].UnClippedValue;
+            _hasToBeSent = true;
+            }
+        }
+    }
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::Set_Year(uint16_t year)
+{
+    Year = year;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::addToInterval(uint32_t pIndex, float pValue)
+{
+    IntervalAccumulator * acc = &_intervalAccumulators[pIndex];
+    acc ->Count++;
+    if (acc ->Count == 1)
+    {
+        acc ->Min = pValue;
+        acc ->Max = pValue;
+    }
+    else
+    {
+        acc ->Min = pValue < acc ->Min ? pValue : acc ->Min;
+        acc ->Max = pValue > acc ->Max ? pValue : acc ->Max;
+    }
+    float delta = pValue - acc ->Mean;
+    acc ->Mean += delta / acc ->Count;
+    acc ->M2 += delta * (pValue - acc ->Mean);
+
+    _lastSamples[pIndex][_lastSamplesWriteCount[pIndex] & (LAST_SAMPLES_COUNT - 1)] = SampleTraits<Sample>::FromFloat(pValue);
+    _lastSamplesWriteCount[pIndex]++;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::SetSendPolicy(uint32_t pIndex, SendPolicy pPolicy, float pDeadband, TimeSpan pHeartbeat)
+{
+    _sendPolicies[pIndex].Policy = pPolicy;
+    _sendPolicies[pIndex].Deadband = pDeadband < 0.0 ? -pDeadband : pDeadband;
+    _sendPolicies[pIndex].Heartbeat = pHeartbeat;
+}
+
+template<size_t N, typename Sample>
+bool DataContainerT<N, Sample>::channelHasToBeSent(uint32_t pIndex, DateTime pActDateTime, float pValue)
+{
+    ChannelSendPolicy * policy = &_sendPolicies[pIndex];
+    if (policy ->Policy == SendPolicy::Deadband)
+    {
+        // Flat values are suppressed until the heartbeat interval has elapsed
+        float change = pValue - policy ->LastSentValue;
+        change = change < 0.0 ? -change : change;
+        return (change > policy ->Deadband) || _lastSentTime.operator<=(pActDateTime.operator-(policy ->Heartbeat));
+    }
+    return _lastSentTime.operator<=(pActDateTime.operator-(SendInterval));
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::updateLastSentValues()
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        _sendPolicies[i].LastSentValue = SampleValues[i].Value;
+    }
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::resetInterval(uint32_t pIndex)
+{
+    _intervalAccumulators[pIndex] = IntervalAccumulator();
+}
+
+template<size_t N, typename Sample>
+IntervalStats DataContainerT<N, Sample>::GetIntervalStats(uint32_t pIndex)
+{
+    IntervalStats stats;
+    IntervalAccumulator * acc = &_intervalAccumulators[pIndex];
+    stats.Count = acc ->Count;
+    if (acc ->Count > 0)
+    {
+        stats.Min = acc ->Min;
+        stats.Max = acc ->Max;
+        stats.Mean = acc ->Mean;
+        stats.Variance = acc ->Count > 1 ? acc ->M2 / (acc ->Count - 1) : 0.0;
+    }
+    else
+    {
+        stats.Min = MagicNumberInvalid;
+        stats.Max = MagicNumberInvalid;
+        stats.Mean = MagicNumberInvalid;
+    }
+    return stats;
+}
+
+template<size_t N, typename Sample>
+uint32_t DataContainerT<N, Sample>::GetLastSamples(uint32_t pIndex, float * outSamples, uint32_t pMaxCount)
+{
+    uint32_t written = _lastSamplesWriteCount[pIndex];
+    uint32_t count = written < LAST_SAMPLES_COUNT ? written : LAST_SAMPLES_COUNT;
+    count = count < pMaxCount ? count : pMaxCount;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        outSamples[i] = SampleTraits<Sample>::ToFloat(_lastSamples[pIndex][(written - count + i) & (LAST_SAMPLES_COUNT - 1)]);
+    }
+    return count;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::setUpperLimit(float pUpperLimit)
+{
+    UpperLimit = pUpperLimit;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::setLowerLimit(float pLowerLimit)
+{
+    LowerLimit = pLowerLimit;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::setMagigNumberInvalid(float pMagicNumberInvalid)
+{
+   MagicNumberInvalid = pMagicNumberInvalid;
+}
+
+template<size_t N, typename Sample>
+bool DataContainerT<N, Sample>::hasToBeSent()
+{
+    return _hasToBeSent;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::setHasToBeSentFlag()
+{
+    _hasToBeSent = true;
+}
+
+template<size_t N, typename Sample>
+void DataContainerT<N, Sample>::prepareSend(DateTime pActDateTime)
+{
+    _hasToBeSent = false;
+    _isFirstTransmission = false;
+    _SampleValuesSet.LastSendTime = _lastSentTime;
+    _lastSentTime = pActDateTime;
+    updateLastSentValues();
+
+    for (size_t i = 0; i < N; i++)
+    {
+        resetInterval(i);
+        SampleValues[i].feedCount = 0;
+        SampleValues[i].SummedValues = 0.0;
+    }
+}
+
+template<size_t N, typename Sample>
+SampleValueSetT<N> DataContainerT<N, Sample>::getSampleValues(DateTime pActDateTime, bool pUpdateSentFlags)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        SampleValues[i].Stats = GetIntervalStats(i);
+    }
+    if (pUpdateSentFlags)
+    {
+        prepareSend(pActDateTime);
+    }
+    for (size_t i = 0; i < N; i++)
+    {
+        _SampleValuesSet.SampleValues[i] = SampleValues[i];
+    }
+    return _SampleValuesSet;
+}
+
+template<size_t N, typename Sample>
+SampleValueSetT<N> DataContainerT<N, Sample>::getCheckedSampleValues(DateTime pActDateTime, bool pUpdateSentFlags)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        SampleValues[i].Stats = GetIntervalStats(i);
+    }
+    if (pUpdateSentFlags)
+    {
+        prepareSend(pActDateTime);
+    }
+    for (size_t i = 0; i < N; i++)
+    {
+        _SampleValuesSet.SampleValues[i] = checkedSampleValue(SampleValues[i], LowerLimit, UpperLimit, MagicNumberInvalid, pActDateTime, InvalidateInterval);
+    }
+    return _SampleValuesSet;
+}
+
+#endif  // _DATACONTAINERWIO_H_
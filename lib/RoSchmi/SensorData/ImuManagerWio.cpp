@@ -27,50 +27,153 @@ void ImuManagerWio::SetNewImuReadings(ImuSampleValues imuReadings)
     sampleSet.ImuSampleSet[currentIndex].Y_Read = imuReadings.Y_Read;
     sampleSet.ImuSampleSet[currentIndex].Z_Read = imuReadings.Z_Read;
 
-    averageX =  floatingAverage(sampleSet, IMU_ARRAY_ELEMENT_COUNT, 'X');
-    averageY =  floatingAverage(sampleSet, IMU_ARRAY_ELEMENT_COUNT, 'Y');
-    averageZ =  floatingAverage(sampleSet, IMU_ARRAY_ELEMENT_COUNT, 'Z');
+    // The few elements are summed up again, float running sums would drift
+    float sumX = 0;
+    float sumY = 0;
+    float sumZ = 0;
+    for (int i = 0; i < IMU_ARRAY_ELEMENT_COUNT; i++)
+    {
+        sumX += sampleSet.ImuSampleSet[i].X_Read;
+        sumY += sampleSet.ImuSampleSet[i].Y_Read;
+        sumZ += sampleSet.ImuSampleSet[i].Z_Read;
+    }
+    averageX = sumX / IMU_ARRAY_ELEMENT_COUNT;
+    averageY = sumY / IMU_ARRAY_ELEMENT_COUNT;
+    averageZ = sumZ / IMU_ARRAY_ELEMENT_COUNT;
 
-    //Serial.println(averageX);
-    //Serial.println(averageY);
-    //Serial.println(averageZ);
-    //Serial.println("");  
+    addReading(&imuReadings);
+    updateVibrationState();
 }
 
-float ImuManagerWio::floatingAverage(ImuSampleValueSet sampleSet, int arrayElementCnt, char axis)
+uint32_t ImuManagerWio::SetWindowLength(uint32_t pLength)
 {
-    float sum = 0;
+    uint32_t length = 1;
+    while (length < pLength && length < IMU_MAX_WINDOW_LENGTH)
+    {
+        length <<= 1;
+    }
+    windowLength = length;
+    ringHead = 0;
+    ringCount = 0;
+    for (int i = 0; i < IMU_AXIS_COUNT; i++)
+    {
+        axisSum[i] = 0;
+        axisSumOfSquares[i] = 0;
+    }
+    vibrationState = false;
+    return windowLength;
+}
 
-    for (int i = 0; i < arrayElementCnt; i++)
+void ImuManagerWio::AddImuReadings(const ImuSampleValues * pReadings, size_t pCount)
+{
+    for (size_t i = 0; i < pCount; i++)
     {
-        switch (axis)
+        addReading(&pReadings[i]);
+    }
+    // The state is evaluated once per batch
+    updateVibrationState();
+}
+
+void ImuManagerWio::addReading(const ImuSampleValues * pReading)
+{
+    float values[IMU_AXIS_COUNT] = {pReading ->X_Read, pReading ->Y_Read, pReading ->Z_Read};
+    uint32_t mask = windowLength - 1;
+    uint32_t position = (ringHead + ringCount) & mask;
+    bool isFull = ringCount == windowLength;
+    for (int i = 0; i < IMU_AXIS_COUNT; i++)
+    {
+        float scaled = values[i] * IMU_VALUE_SCALE;
+        int16_t value = scaled > INT16_MAX ? INT16_MAX : scaled < INT16_MIN ? INT16_MIN : (int16_t)scaled;
+        if (isFull)
         {
-            case 'X':
-                {
-                    sum += sampleSet.ImuSampleSet[i].X_Read;
-                }
-                break;
-                case 'Y':
-                {
-                    sum += sampleSet.ImuSampleSet[i].Y_Read;
-                }
-                break;
-                case 'Z':
-                {
-                    sum += sampleSet.ImuSampleSet[i].Z_Read;
-                }
-                break;
-                default:
-                {
-                    while (true)
-                    {
-                        Serial.println(F("Error in ImuManagerWio"));
-                        delay(1000);
-                    }                                   
-            }
+            // position is the oldest reading, it leaves the window
+            int32_t oldValue = ring[position][i];
+            axisSum[i] -= oldValue;
+            axisSumOfSquares[i] -= oldValue * oldValue;
         }
-    }   
-    return sum / arrayElementCnt;
+        ring[position][i] = value;
+        axisSum[i] += value;
+        axisSumOfSquares[i] += (int32_t)value * value;
+    }
+    if (isFull)
+    {
+        ringHead = (ringHead + 1) & mask;
+    }
+    else
+    {
+        ringCount++;
+    }
+}
+
+float ImuManagerWio::GetAxisMean(uint8_t pAxis)
+{
+    if (pAxis >= IMU_AXIS_COUNT || ringCount == 0)
+    {
+        return 0;
+    }
+    return (float)axisSum[pAxis] / ringCount / IMU_VALUE_SCALE;
+}
+
+float ImuManagerWio::GetAxisVariance(uint8_t pAxis)
+{
+    if (pAxis >= IMU_AXIS_COUNT || ringCount < 2)
+    {
+        return 0;
+    }
+    // (n * sum(x^2) - sum(x)^2) / n^2 is exact in integers
+    int64_t numerator = (int64_t)ringCount * axisSumOfSquares[pAxis] - (int64_t)axisSum[pAxis] * axisSum[pAxis];
+    return (float)numerator / ((float)ringCount * ringCount) / (IMU_VALUE_SCALE * IMU_VALUE_SCALE);
+}
+
+float ImuManagerWio::GetVibrationLevel()
+{
+    return sqrtf(GetAxisVariance(0) + GetAxisVariance(1) + GetAxisVariance(2));
+}
+
+void ImuManagerWio::SetVibrationThreshold(float pOnLevel, float pHysteresis)
+{
+    vibrationOnLevel = pOnLevel;
+    vibrationHysteresis = pHysteresis;
+}
+
+void ImuManagerWio::updateVibrationState()
+{
+    // The state is only evaluated with a complete window
+    if (ringCount < windowLength)
+    {
+        return;
+    }
+    float level = GetVibrationLevel();
+    if (vibrationState)
+    {
+        vibrationState = level >= (vibrationOnLevel - vibrationHysteresis);
+    }
+    else
+    {
+        vibrationState = level >= vibrationOnLevel;
+    }
+}
+
+bool ImuManagerWio::GetVibrationState()
+{
+    return isActive && vibrationState;
+}
+
+uint32_t ImuManagerWio::GetWindowFillCount()
+{
+    return ringCount;
+}
+
+// Returns true once after each change of the vibration state
+bool ImuManagerWio::hasToggled()
+{
+    bool state = GetVibrationState();
+    if (state != reportedVibrationState)
+    {
+        reportedVibrationState = state;
+        return true;
+    }
+    return false;
 }
     
 ImuSampleValues ImuManagerWio::GetLastImuReadings()
@@ -6,6 +6,11 @@
 
 #define IMU_ARRAY_ELEMENT_COUNT 5
 
+#define IMU_MAX_WINDOW_LENGTH 256       // must be a power of two
+#define IMU_DEFAULT_WINDOW_LENGTH 64
+#define IMU_VALUE_SCALE 1000.0          // readings are stored in milli g
+#define IMU_AXIS_COUNT 3
+
 typedef struct
 {
     float X_Read = 0;
@@ -33,13 +38,61 @@ public:
     void SetNewImuReadings(ImuSampleValues imuReadings);
     float GetVibrationValue();
     ImuSampleValues GetLastImuReadings();
-    bool hasToggled(DateTime actUtcTime);  
+    bool hasToggled();
+
+    // Vibration engine:
+    // The readings are kept in a ring with a power-of-two length, sum and sum of squares
+    // of each axis are updated when a reading enters or leaves the window. So mean and
+    // variance cost O(1) per reading, independent of the window length and the sample rate.
+    // The sums are integers (milli g), so they do not drift
+
+    /**
+    * @brief Sets the number of readings of the window and clears the window
+    *
+    * @param[in] pLength Is rounded up to the next power of two (max IMU_MAX_WINDOW_LENGTH)
+    * @return The length which is used
+    */
+    uint32_t SetWindowLength(uint32_t pLength);
+
+    /**
+    * @brief Adds a batch of readings (e.g. the content of the FIFO of the IMU)
+    *
+    * @param[in] pReadings The readings, oldest first
+    * @param[in] pCount Number of readings
+    */
+    void AddImuReadings(const ImuSampleValues * pReadings, size_t pCount);
+
+    /**
+    * @brief Sets the level of the vibration where the state becomes 'on'
+    *
+    * @param[in] pOnLevel RMS of the vibration (g) where the state becomes 'on'
+    * @param[in] pHysteresis The state becomes 'off' below pOnLevel - pHysteresis
+    */
+    void SetVibrationThreshold(float pOnLevel, float pHysteresis);
+
+    float GetAxisMean(uint8_t pAxis);           // 0 = X, 1 = Y, 2 = Z (g)
+    float GetAxisVariance(uint8_t pAxis);       // g^2
+    float GetVibrationLevel();                  // RMS of the deviation of all axes (g)
+    bool GetVibrationState();
+    uint32_t GetWindowFillCount();
 
 private:
     bool isActive = false;
     int currentIndex = 0;
     bool averageIsReady = false;
-    float floatingAverage(ImuSampleValueSet sampleSet, int arrayElementCnt, char axis);
+
+    void addReading(const ImuSampleValues * pReading);
+    void updateVibrationState();
+    int16_t ring[IMU_MAX_WINDOW_LENGTH][IMU_AXIS_COUNT];
+    uint32_t windowLength = IMU_DEFAULT_WINDOW_LENGTH;
+    uint32_t ringHead = 0;
+    uint32_t ringCount = 0;
+    int32_t axisSum[IMU_AXIS_COUNT] = {0};
+    int64_t axisSumOfSquares[IMU_AXIS_COUNT] = {0};
+    float vibrationOnLevel = 0.05;
+    float vibrationHysteresis = 0.01;
+    bool vibrationState = false;
+    bool reportedVibrationState = false;
 
 };
 
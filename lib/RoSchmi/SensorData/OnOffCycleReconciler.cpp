@@ -0,0 +1,70 @@
+#include "OnOffCycleReconciler.h"
+
+OnOffCycleReconciler::OnOffCycleReconciler(uint32_t pMaxInferredCycles)
+{
+    maxInferredCycles = pMaxInferredCycles;
+}
+
+uint32_t OnOffCycleReconciler::Reconcile(uint32_t pStartsCounter, bool pLastState, bool pNewState, DateTime pPollTimeUtc)
+{
+    lastInferredCount = 0;
+
+    // The first poll and a counter which went backwards (e.g. replaced control unit) only set the base
+    if (!hasBase || pStartsCounter < lastCounter || pPollTimeUtc.unixtime() <= lastPollTime.unixtime())
+    {
+        hasBase = true;
+        lastCounter = pStartsCounter;
+        lastPollTime = pPollTimeUtc;
+        balance = 0;
+        return 0;
+    }
+
+    uint32_t seenStarts = (!pLastState && pNewState) ? 1 : 0;
+    balance += (int32_t)(pStartsCounter - lastCounter) - (int32_t)seenStarts;
+
+    intervalStart = lastPollTime;
+    intervalSeconds = pPollTimeUtc.unixtime() - lastPollTime.unixtime();
+    lastCounter = pStartsCounter;
+    lastPollTime = pPollTimeUtc;
+
+    if (balance <= 0)
+    {
+        // A lagging counter is balanced with the next polls, but not forever
+        balance = balance < -(int32_t)maxInferredCycles ? 0 : balance;
+        return 0;
+    }
+    if ((uint32_t)balance > maxInferredCycles)
+    {
+        discardedCycleCount += balance;
+        balance = 0;
+        return 0;
+    }
+    lastInferredCount = balance;
+    inferredCycleCount += balance;
+    balance = 0;
+    return lastInferredCount;
+}
+
+DateTime OnOffCycleReconciler::GetInferredSwitchTime(uint32_t pIndex)
+{
+    // The 2 * n switches divide the interval between the polls into 2 * n + 1 equal parts
+    uint32_t parts = 2 * lastInferredCount + 1;
+    return intervalStart.operator+(TimeSpan((int32_t)((intervalSeconds * (pIndex + 1)) / parts)));
+}
+
+void OnOffCycleReconciler::Reset()
+{
+    hasBase = false;
+    balance = 0;
+    lastInferredCount = 0;
+}
+
+uint32_t OnOffCycleReconciler::GetInferredCycleCount()
+{
+    return inferredCycleCount;
+}
+
+uint32_t OnOffCycleReconciler::GetDiscardedCycleCount()
+{
+    return discardedCycleCount;
+}
@@ -0,0 +1,59 @@
+#include <Arduino.h>
+#include <Datetime.h>
+
+#ifndef _ON_OFF_CYCLE_RECONCILER_H_
+#define _ON_OFF_CYCLE_RECONCILER_H_
+
+#define ON_OFF_DEFAULT_MAX_INFERRED_CYCLES 10
+
+// Detects switch cycles which were not seen since they happened between two polls
+// The device counts its starts (e.g. 'starts' of heating.burners.0.statistics). With each poll
+// the counter delta is compared with the starts which were seen (Off -> On between the polls).
+// Missing cycles are returned as On/Off pairs (or Off/On pairs if the sensor was 'on'),
+// evenly spread between the two polls, so the number of cycles stays exact.
+// If the counter lags behind the seen starts, the difference is credited to the next polls.
+class OnOffCycleReconciler
+{
+public:
+    OnOffCycleReconciler(uint32_t pMaxInferredCycles = ON_OFF_DEFAULT_MAX_INFERRED_CYCLES);
+
+    /**
+    * @brief Compares the counter delta since the last poll with the seen starts
+    *
+    * @param[in] pStartsCounter The actual value of the starts counter of the device
+    * @param[in] pLastState The state of the sensor at the last poll
+    * @param[in] pNewState The state of the sensor at this poll
+    * @param[in] pPollTimeUtc The time of this poll
+    * @return The number of inferred cycles (each cycle are two switches)
+    *         If more than pMaxInferredCycles are missing (e.g. after a long outage), 0 is returned
+    */
+    uint32_t Reconcile(uint32_t pStartsCounter, bool pLastState, bool pNewState, DateTime pPollTimeUtc);
+
+    /**
+    * @brief Returns the estimated time of an inferred switch of the last call of Reconcile
+    *
+    * @param[in] pIndex 0 - (2 * number of inferred cycles - 1), in chronological order
+    * @return The first switch of a cycle changes to the opposite of pLastState, the second switches back
+    */
+    DateTime GetInferredSwitchTime(uint32_t pIndex);
+
+    // Forgets the counter value, the next call of Reconcile only takes the new base value
+    void Reset();
+
+    uint32_t GetInferredCycleCount();     // since start
+    uint32_t GetDiscardedCycleCount();    // not inferred since more than pMaxInferredCycles were missing
+
+private:
+    bool hasBase = false;
+    uint32_t lastCounter = 0;
+    int32_t balance = 0;                  // counted starts - seen starts, which are not yet balanced
+    DateTime lastPollTime = DateTime();
+    DateTime intervalStart = DateTime();
+    uint32_t intervalSeconds = 0;
+    uint32_t lastInferredCount = 0;
+    uint32_t maxInferredCycles = ON_OFF_DEFAULT_MAX_INFERRED_CYCLES;
+    uint32_t inferredCycleCount = 0;
+    uint32_t discardedCycleCount = 0;
+};
+
+#endif  // _ON_OFF_CYCLE_RECONCILER_H_
@@ -2,6 +2,19 @@
 
 OnOffSampleValueSet onOffSampleValueSet;
 
+// Ring buffer of the switch events of one sensor
+typedef struct
+{
+    OnOffTransition Transitions[ON_OFF_TRANSITION_RING_SIZE];
+    uint32_t Head = 0;                  // index of the oldest event
+    uint32_t Count = 0;
+    uint32_t DroppedCount = 0;
+    DateTime LastTimeUtc = DateTime();  // time of the last recorded event
+}
+OnOffTransitionRing;
+
+OnOffTransitionRing onOffTransitionRings[ON_OFF_SENSOR_COUNT];
+
 OnOffDataContainerWio::OnOffDataContainerWio()
 {}
 
@@ -14,7 +27,7 @@ const char * tableName_2, const char * tableName_3, const char * tableName_4)
     strcpy(onOffSampleValueSet.OnOffSampleValues[2].tableName, tableName_3);
     strcpy(onOffSampleValueSet.OnOffSampleValues[3].tableName, tableName_4);
 
-    for (int i = 0; i < PROPERTY_COUNT; i++)
+    for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)
     {
         onOffSampleValueSet.OnOffSampleValues[i].actState = false;
         onOffSampleValueSet.OnOffSampleValues[i].lastState = true;
@@ -28,14 +41,17 @@ const char * tableName_2, const char * tableName_3, const char * tableName_4)
 // If state is different to the value it had before, actstate is changed and lastState
 // is set to the value which actstate was before
 // LastSwitchTime is set to the value passed in parameter time
-// The hasToBeSent flag is set
+// The hasToBeSent flag is set and the event is stored in the ring buffer of the sensor
 // If we have a new day (local time), a new OnTimeDay is calculated
 // If we have a new day the 'dayIsLocked' flag is cleared 
-void OnOffDataContainerWio::SetNewOnOffValue(int sensorIndex, bool state, DateTime pTimeUtc, int offsetUtcMinutes)
+void OnOffDataContainerWio::SetNewOnOffValue(int sensorIndex, bool state, DateTime pTimeUtc, int offsetUtcMinutes, bool isInferred)
 {
     // change incoming state if inputInverter is active
     bool _state = onOffSampleValueSet.OnOffSampleValues[sensorIndex].inputInverter ? !state : state;
 
+    // The Off pulse at the end of the day is set together with the 'resetToOnIsNeeded' flag
+    bool _isDayEndPulse = onOffSampleValueSet.OnOffSampleValues[sensorIndex].resetToOnIsNeeded;
+
     DateTime _localTime = pTimeUtc.operator+(TimeSpan(offsetUtcMinutes * 60));   
     DateTime _localTimeOfLastSwitch = onOffSampleValueSet.OnOffSampleValues[sensorIndex].LastSwitchTime;  
     TimeSpan _timeFromLast = _localTime.operator-(_localTimeOfLastSwitch);
@@ -69,12 +85,17 @@ void OnOffDataContainerWio::SetNewOnOffValue(int sensorIndex, bool state, DateTi
         }          
     }
         
+    // 'On' as written to the table
+    bool _isOn = _state == onOffSampleValueSet.OnOffSampleValues[sensorIndex].outInverter;
+    updateDutyCycle(sensorIndex, _isOn, _localTime, _isDayEndPulse);
+
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].lastState = onOffSampleValueSet.OnOffSampleValues[sensorIndex].actState;               
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].actState = _state;
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].TimeFromLast = _timeFromLast.days() < 100 ? _timeFromLast : TimeSpan(0);
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].LastSwitchTime = _localTime;
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].hasToBeSent = true;
-   
+
+    recordTransition(sensorIndex, pTimeUtc, offsetUtcMinutes, isInferred);
 }
 
 void OnOffDataContainerWio::PresetOnOffState(int sensorIndex, bool state, bool lastState, DateTime time)
@@ -136,7 +157,7 @@ bool OnOffDataContainerWio::One_hasToBeBeSent(DateTime pLocalNow)
     // and the actual state is 'on'
     bool ret = false;
     
-    for (int i = 0; i < PROPERTY_COUNT; i++)
+    for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)
     { 
         ret = onOffSampleValueSet.OnOffSampleValues[i].hasToBeSent == true ? true : ret;
                      
@@ -165,5 +186,165 @@ void OnOffDataContainerWio::Set_OnTimeDay(int sensorIndex, TimeSpan pOnTimeDay)
     onOffSampleValueSet.OnOffSampleValues[sensorIndex].OnTimeDay = pOnTimeDay;  
 }
 
+void OnOffDataContainerWio::updateDutyCycle(int sensorIndex, bool isOn, DateTime localTime, bool isDayEndPulse)
+{
+    OnOffDutyCycle * dc = &onOffSampleValueSet.OnOffSampleValues[sensorIndex].DutyCycle;
+
+    DateTime hourStart = DateTime(localTime.year(), localTime.month(), localTime.day(), localTime.hour(), 0, 0);
+    DateTime dayStart = DateTime(localTime.year(), localTime.month(), localTime.day(), 0, 0, 0);
+    if (hourStart.operator!=(dc ->HourStart))
+    {
+        dc ->HourStart = hourStart;
+        dc ->StartsHour = 0;
+    }
+    if (dayStart.operator!=(dc ->DayStart))
+    {
+        dc ->DayStart = dayStart;
+        dc ->StartsDay = 0;
+        dc ->OnCount = 0;
+        dc ->OnSeconds = 0;
+        dc ->OnMinSeconds = 0;
+        dc ->OnMaxSeconds = 0;
+        dc ->OffCount = 0;
+        dc ->OffSeconds = 0;
+    }
+
+    // The pulse doesn't end the running period
+    if (isDayEndPulse)
+    {
+        dc ->InDayEndPulse = true;
+        return;
+    }
+    if (dc ->InDayEndPulse)
+    {
+        dc ->InDayEndPulse = false;
+        if (isOn == dc ->IsOn)
+        {
+            return;
+        }
+    }
+    if (dc ->HasState && isOn == dc ->IsOn)
+    {
+        return;
+    }
+
+    if (dc ->HasState)
+    {
+        int32_t periodSeconds = (localTime.operator-(dc ->RunStart)).totalseconds();
+        uint32_t seconds = periodSeconds > 0 ? (uint32_t)periodSeconds : 0;
+        if (dc ->IsOn)
+        {
+            dc ->OnMinSeconds = (dc ->OnCount == 0 || seconds < dc ->OnMinSeconds) ? seconds : dc ->OnMinSeconds;
+            dc ->OnMaxSeconds = seconds > dc ->OnMaxSeconds ? seconds : dc ->OnMaxSeconds;
+            dc ->OnCount++;
+            dc ->OnSeconds += seconds;
+        }
+        else
+        {
+            dc ->OffCount++;
+            dc ->OffSeconds += seconds;
+        }
+        if (isOn)
+        {
+            dc ->StartsHour++;
+            dc ->StartsDay++;
+        }
+    }
+    dc ->HasState = true;
+    dc ->IsOn = isOn;
+    dc ->RunStart = localTime;
+}
+
+uint32_t OnOffDataContainerWio::MeanOnSeconds(OnOffDutyCycle pDutyCycle)
+{
+    return pDutyCycle.OnCount > 0 ? pDutyCycle.OnSeconds / pDutyCycle.OnCount : 0;
+}
+
+uint32_t OnOffDataContainerWio::MeanOffSeconds(OnOffDutyCycle pDutyCycle)
+{
+    return pDutyCycle.OffCount > 0 ? pDutyCycle.OffSeconds / pDutyCycle.OffCount : 0;
+}
+
+void OnOffDataContainerWio::recordTransition(int sensorIndex, DateTime pTimeUtc, int offsetUtcMinutes, bool isInferred)
+{
+    OnOffTransitionRing * ring = &onOffTransitionRings[sensorIndex];
+    OnOffSampleValue * sampleValue = &onOffSampleValueSet.OnOffSampleValues[sensorIndex];
+
+    // When the ring is full the oldest event is overwritten
+    if (ring ->Count == ON_OFF_TRANSITION_RING_SIZE)
+    {
+        ring ->Head = (ring ->Head + 1) % ON_OFF_TRANSITION_RING_SIZE;
+        ring ->Count--;
+        ring ->DroppedCount++;
+    }
+
+    // The RowKey has a resolution of one second, two events of a sensor in the same second would have the same RowKey
+    DateTime timeUtc = pTimeUtc;
+    if (ring ->LastTimeUtc != DateTime() && timeUtc.unixtime() <= ring ->LastTimeUtc.unixtime())
+    {
+        timeUtc = ring ->LastTimeUtc.operator+(TimeSpan(1));
+    }
+    ring ->LastTimeUtc = timeUtc;
+
+    OnOffTransition * transition = &ring ->Transitions[(ring ->Head + ring ->Count) % ON_OFF_TRANSITION_RING_SIZE];
+    transition ->actState = sampleValue ->actState;
+    transition ->lastState = sampleValue ->lastState;
+    transition ->Inferred = isInferred;
+    transition ->TimeUtc = timeUtc;
+    transition ->OffsetUtcMinutes = offsetUtcMinutes;
+    transition ->OnTimeDay = sampleValue ->OnTimeDay;
+    transition ->TimeFromLast = sampleValue ->TimeFromLast;
+    transition ->DutyCycle = sampleValue ->DutyCycle;
+    ring ->Count++;
+}
+
+uint32_t OnOffDataContainerWio::GetTransitionCount(int sensorIndex)
+{
+    return onOffTransitionRings[sensorIndex].Count;
+}
+
+OnOffTransition OnOffDataContainerWio::GetTransition(int sensorIndex, uint32_t pPosition)
+{
+    OnOffTransitionRing * ring = &onOffTransitionRings[sensorIndex];
+    return ring ->Transitions[(ring ->Head + pPosition) % ON_OFF_TRANSITION_RING_SIZE];
+}
+
+void OnOffDataContainerWio::RemoveTransitions(int sensorIndex, uint32_t pCount)
+{
+    OnOffTransitionRing * ring = &onOffTransitionRings[sensorIndex];
+    pCount = pCount < ring ->Count ? pCount : ring ->Count;
+    ring ->Head = (ring ->Head + pCount) % ON_OFF_TRANSITION_RING_SIZE;
+    ring ->Count -= pCount;
+    if (ring ->Count == 0)
+    {
+        onOffSampleValueSet.OnOffSampleValues[sensorIndex].hasToBeSent = false;
+    }
+}
 
+uint32_t OnOffDataContainerWio::GetDroppedTransitionCount(int sensorIndex)
+{
+    return onOffTransitionRings[sensorIndex].DroppedCount;
+}
 
+bool OnOffDataContainerWio::TransitionsHaveToBeFlushed(DateTime pUtcNow, uint32_t pMaxCount, uint32_t pMaxAgeSeconds)
+{
+    for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)
+    {
+        OnOffTransitionRing * ring = &onOffTransitionRings[i];
+        if (ring ->Count == 0)
+        {
+            continue;
+        }
+        if (ring ->Count >= pMaxCount)
+        {
+            return true;
+        }
+        // The age is calculated from the unixtime, a jump of the system time must not block the upload
+        uint32_t oldestTime = ring ->Transitions[ring ->Head].TimeUtc.unixtime();
+        if (pUtcNow.unixtime() < oldestTime || pUtcNow.unixtime() - oldestTime >= pMaxAgeSeconds)
+        {
+            return true;
+        }
+    }
+    return false;
+}
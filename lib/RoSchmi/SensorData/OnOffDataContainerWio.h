@@ -4,7 +4,31 @@
 #ifndef _ON_OFF_DATACONTAINERWIO_H_
 #define _ON_OFF_DATACONTAINERWIO_H_
 
-#define PROPERTY_COUNT 4
+#define ON_OFF_SENSOR_COUNT 4     // Number of OnOff-Tables (each sensor has its own table)
+#define ON_OFF_TRANSITION_RING_SIZE 16  // Switch events which are buffered per sensor until they are uploaded
+
+// Duty cycle statistics of one OnOff channel (e.g. burner short-cycling)
+// Are updated with every switch in O(1), no history of the switch events is stored
+// 'On' is the state as written to the table (considering outInverter)
+// Hour and day are local time, the values of the day are reset with the first switch of a new day
+typedef struct
+{
+    bool HasState = false;
+    bool IsOn = false;
+    bool InDayEndPulse = false;     // the artificial Off/On pulse at the end of the day is not counted
+    DateTime RunStart = DateTime(); // begin of the actual On or Off period
+    DateTime HourStart = DateTime();
+    DateTime DayStart = DateTime();
+    uint32_t StartsHour = 0;        // switches to 'On' in the actual hour
+    uint32_t StartsDay = 0;         // switches to 'On' on this day
+    uint32_t OnCount = 0;           // completed On periods on this day
+    uint32_t OnSeconds = 0;
+    uint32_t OnMinSeconds = 0;
+    uint32_t OnMaxSeconds = 0;      // longest completed run on this day
+    uint32_t OffCount = 0;          // completed Off periods on this day
+    uint32_t OffSeconds = 0;
+}
+OnOffDutyCycle;
 
 typedef struct
 {
@@ -21,15 +45,31 @@ typedef struct
     char tableName[50];
     uint32_t insertCounter = 0;
     uint16_t Year = 1900;
+    OnOffDutyCycle DutyCycle;
 }
 OnOffSampleValue; 
     
 typedef struct
 {    
-    OnOffSampleValue OnOffSampleValues[PROPERTY_COUNT];
+    OnOffSampleValue OnOffSampleValues[ON_OFF_SENSOR_COUNT];
 }
 OnOffSampleValueSet;
 
+// One switch event as it is written to the table (one row)
+// The values are taken at the moment of the switch, so the event can be uploaded later
+typedef struct
+{
+    bool actState = false;
+    bool lastState = true;
+    bool Inferred = false;              // the switch was not seen, time is estimated
+    DateTime TimeUtc = DateTime();      // time of the switch
+    int16_t OffsetUtcMinutes = 0;       // offset of local time at the time of the switch
+    TimeSpan OnTimeDay = TimeSpan(0);
+    TimeSpan TimeFromLast = TimeSpan(0);
+    OnOffDutyCycle DutyCycle;
+}
+OnOffTransition;
+
 class OnOffDataContainerWio
 {
 
@@ -50,8 +90,9 @@ public:
  * @param[in] state Sets the 'state'-variable of the selected OnOff-Sensor representation
  * @param[in] time Sets the 'LastSwitchTime'-variable of the selected OnOff-Sensor representation.
  *              If time = nullptr or time is not passed, 'LastSwitchTime' is not changed
+ * @param[in] isInferred The switch was not seen but concluded (e.g. from a starts counter)
  */
-    void SetNewOnOffValue(int sensorIndex, bool state, DateTime time, int offsetUtcMinutes);
+    void SetNewOnOffValue(int sensorIndex, bool state, DateTime time, int offsetUtcMinutes, bool isInferred = false);
 
 /**
  * @brief Sets State and LastState without affecting 'hasToBeSent"-State.
@@ -155,6 +196,64 @@ public:
     bool One_hasToBeBeSent(DateTime localNow);
      
     OnOffSampleValueSet GetOnOffValueSet();   
+
+/**
+ * @brief Returns the mean duration of the completed On periods of the day in seconds (0 if none)
+ *
+ * @param[in] pDutyCycle The duty cycle statistics of one sensor
+ */
+    static uint32_t MeanOnSeconds(OnOffDutyCycle pDutyCycle);
+
+/**
+ * @brief Returns the mean duration of the completed Off periods of the day in seconds (0 if none)
+ *
+ * @param[in] pDutyCycle The duty cycle statistics of one sensor
+ */
+    static uint32_t MeanOffSeconds(OnOffDutyCycle pDutyCycle);
+
+/**
+ * @brief Returns the number of buffered switch events which were not yet uploaded
+ *
+ * @param[in] sensorIndex The index of 4 OnOff-Tables (0 - 3)
+ */
+    uint32_t GetTransitionCount(int sensorIndex);
+
+/**
+ * @brief Returns a buffered switch event
+ *
+ * @param[in] sensorIndex The index of 4 OnOff-Tables (0 - 3)
+ * @param[in] pPosition 0 = the oldest event, GetTransitionCount() - 1 = the newest event
+ */
+    OnOffTransition GetTransition(int sensorIndex, uint32_t pPosition);
+
+/**
+ * @brief Removes the oldest buffered switch events (after they were uploaded)
+ *        When no event is left, the 'hasToBeSent'-flag is reset
+ *
+ * @param[in] sensorIndex The index of 4 OnOff-Tables (0 - 3)
+ * @param[in] pCount The number of events to remove
+ */
+    void RemoveTransitions(int sensorIndex, uint32_t pCount);
+
+/**
+ * @brief Returns the number of switch events which were overwritten since the buffer was full
+ *
+ * @param[in] sensorIndex The index of 4 OnOff-Tables (0 - 3)
+ */
+    uint32_t GetDroppedTransitionCount(int sensorIndex);
+
+/**
+ * @brief Returns true if the events of at least one sensor have to be uploaded
+ *
+ * @param[in] pUtcNow The actual time (UTC)
+ * @param[in] pMaxCount A sensor has at least this number of buffered events
+ * @param[in] pMaxAgeSeconds The oldest buffered event of a sensor is at least this old
+ */
+    bool TransitionsHaveToBeFlushed(DateTime pUtcNow, uint32_t pMaxCount, uint32_t pMaxAgeSeconds);
+
+private:
+    void updateDutyCycle(int sensorIndex, bool isOn, DateTime localTime, bool isDayEndPulse);
+    void recordTransition(int sensorIndex, DateTime pTimeUtc, int offsetUtcMinutes, bool isInferred);
 };
 
 #endif  // _ON_OFF_DATACONTAINERWIO_H_
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "SensorScheduler.h"
+
+// Constructor
+SensorScheduler::SensorScheduler()
+{
+    for (int i = 0; i < SENSOR_SCHEDULER_CAPACITY; i++)
+    {
+        positions[i] = -1;
+    }
+}
+
+int SensorScheduler::Register(uint8_t pSource, uint8_t pIndex)
+{
+    if (registeredCount >= SENSOR_SCHEDULER_CAPACITY)
+    {
+        return SENSOR_SCHEDULER_INVALID_ID;
+    }
+    int id = registeredCount++;
+    entries[id].Source = pSource;
+    entries[id].Index = pIndex;
+    positions[id] = -1;
+    return id;
+}
+
+void SensorScheduler::Schedule(int pId, DateTime pDueTime)
+{
+    if (pId < 0 || pId >= (int)registeredCount)
+    {
+        return;
+    }
+    uint32_t oldDue = entries[pId].DueUnixtime;
+    entries[pId].DueUnixtime = pDueTime.unixtime();
+    if (positions[pId] < 0)
+    {
+        heap[heapCount] = pId;
+        positions[pId] = heapCount;
+        heapCount++;
+        siftUp(heapCount - 1);
+    }
+    else if (entries[pId].DueUnixtime < oldDue)
+    {
+        siftUp(positions[pId]);
+    }
+    else
+    {
+        siftDown(positions[pId]);
+    }
+}
+
+void SensorScheduler::Unschedule(int pId)
+{
+    if (pId < 0 || pId >= (int)registeredCount || positions[pId] < 0)
+    {
+        return;
+    }
+    size_t position = positions[pId];
+    heapCount--;
+    if (position != heapCount)
+    {
+        // The last node takes the place of the removed one
+        swapNodes(position, heapCount);
+        positions[pId] = -1;
+        siftUp(position);
+        siftDown(position);
+    }
+    else
+    {
+        positions[pId] = -1;
+    }
+}
+
+bool SensorScheduler::HasDeadline()
+{
+    return heapCount > 0;
+}
+
+DateTime SensorScheduler::nextDeadline()
+{
+    return heapCount > 0 ? DateTime(entries[heap[0]].DueUnixtime) : DateTime((uint32_t)0);
+}
+
+bool SensorScheduler::PeekDue(DateTime pNow, SensorDeadline * outDeadline)
+{
+    if (heapCount == 0 || entries[heap[0]].DueUnixtime > pNow.unixtime())
+    {
+        return false;
+    }
+    *outDeadline = entries[heap[0]];
+    return true;
+}
+
+size_t SensorScheduler::GetScheduledCount()
+{
+    return heapCount;
+}
+
+void SensorScheduler::swapNodes(size_t pA, size_t pB)
+{
+    uint8_t id = heap[pA];
+    heap[pA] = heap[pB];
+    heap[pB] = id;
+    positions[heap[pA]] = pA;
+    positions[heap[pB]] = pB;
+}
+
+void SensorScheduler::siftUp(size_t pPosition)
+{
+    while (pPosition > 0)
+    {
+        size_t parent = (pPosition - 1) / 2;
+        if (entries[heap[parent]].DueUnixtime <= entries[heap[pPosition]].DueUnixtime)
+        {
+            break;
+        }
+        swapNodes(parent, pPosition);
+        pPosition = parent;
+    }
+}
+
+void SensorScheduler::siftDown(size_t pPosition)
+{
+    while (true)
+    {
+        size_t smallest = pPosition;
+        size_t left = 2 * pPosition + 1;
+        size_t right = left + 1;
+        if (left < heapCount && entries[heap[left]].DueUnixtime < entries[heap[smallest]].DueUnixtime)
+        {
+            smallest = left;
+        }
+        if (right < heapCount && entries[heap[right]].DueUnixtime < entries[heap[smallest]].DueUnixtime)
+        {
+            smallest = right;
+        }
+        if (smallest == pPosition)
+        {
+            break;
+        }
+        swapNodes(pPosition, smallest);
+        pPosition = smallest;
+    }
+}
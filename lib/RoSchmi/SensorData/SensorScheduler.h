@@ -0,0 +1,76 @@
+#include <Arduino.h>
+#include <Datetime.h>
+
+#ifndef _SENSOR_SCHEDULER_H_
+#define _SENSOR_SCHEDULER_H_
+
+#define SENSOR_SCHEDULER_CAPACITY 16      // sensors of all groups (sources)
+#define SENSOR_SCHEDULER_INVALID_ID -1
+
+// One sensor which waits to be read
+typedef struct
+{
+    uint32_t DueUnixtime = 0;
+    uint8_t Source = 0;      // e.g. the number of the AnalogSensorMgr
+    uint8_t Index = 0;       // index of the sensor in its source
+}
+SensorDeadline;
+
+// Keeps the next read time of the sensors of all sources in a min-heap
+// The next deadline is available in O(1), a sensor is (re)scheduled in O(log n)
+// So the main loop can wait until the next sensor is due instead of polling all of them
+class SensorScheduler
+{
+public:
+    SensorScheduler();
+
+    /**
+    * @brief Registers a sensor, it has no deadline until it is scheduled
+    *
+    * @param[in] pSource The number of the source (sensor group)
+    * @param[in] pIndex The index of the sensor in the source
+    * @return The id of the sensor or SENSOR_SCHEDULER_INVALID_ID if the scheduler is full
+    */
+    int Register(uint8_t pSource, uint8_t pIndex);
+
+    /**
+    * @brief Sets the next read time of a sensor (inserts or moves it in the heap)
+    *
+    * @param[in] pId The id which was returned by Register()
+    * @param[in] pDueTime The time when the sensor has to be read
+    */
+    void Schedule(int pId, DateTime pDueTime);
+
+    // Removes the deadline of a sensor (e.g. for inactive sensors)
+    void Unschedule(int pId);
+
+    bool HasDeadline();
+
+    // The earliest deadline of all sensors, DateTime(0) if there is none
+    DateTime nextDeadline();
+
+    /**
+    * @brief Returns the sensor with the earliest deadline if it is due
+    *        The sensor keeps its deadline until it is scheduled again
+    *
+    * @param[in] pNow The actual time
+    * @param[out] outDeadline The sensor
+    * @return false if no sensor is due
+    */
+    bool PeekDue(DateTime pNow, SensorDeadline * outDeadline);
+
+    size_t GetScheduledCount();
+
+private:
+    void swapNodes(size_t pA, size_t pB);
+    void siftUp(size_t pPosition);
+    void siftDown(size_t pPosition);
+
+    SensorDeadline entries[SENSOR_SCHEDULER_CAPACITY];     // indexed by id
+    int16_t positions[SENSOR_SCHEDULER_CAPACITY];          // position of the id in the heap, -1 if not scheduled
+    uint8_t heap[SENSOR_SCHEDULER_CAPACITY];               // ids, ordered by DueUnixtime
+    size_t registeredCount = 0;
+    size_t heapCount = 0;
+};
+
+#endif  // _SENSOR_SCHEDULER_H_
@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifndef _SOUND_BLOCK_KERNEL_H_
+#define _SOUND_BLOCK_KERNEL_H_
+
+// Level of one block of I2S samples
+typedef struct
+{
+    uint32_t SampleCount = 0;   // samples of the used channel
+    int32_t Min = 0;
+    int32_t Max = 0;
+    float Rms = 0.0;            // without the DC offset of the microphone
+    float BandRms = 0.0;        // RMS in the Goertzel bins (spectral mode)
+    float BandRatio = 0.0;      // part of the energy of the block which is in the bins
+    uint32_t Millis = 0;        // time when the block was complete
+}
+SoundBlockLevel;
+
+// Calculates min, max and RMS of a block of 32 bit I2S samples in integer arithmetic
+// Only every pStride-th sample starting at pFirst is used (pStride = 2 for the interleaved
+// channels of the SPH0645, the other channel is 0), samples which are 0 are regular values
+// The loop has no branches and no float operations, so it can be unrolled/vectorized
+// by the compiler and runs on the host as well as on the Esp32
+inline SoundBlockLevel computeSoundBlockLevel(const int32_t * pSamples, size_t pCount, size_t pStride = 1, size_t pFirst = 0, int pShift = 14)
+{
+    int64_t sum = 0;
+    int64_t sumOfSquares = 0;
+    uint32_t count = 0;
+    int32_t minValue = INT32_MAX;
+    int32_t maxValue = INT32_MIN;
+
+    for (size_t i = pFirst; i < pCount; i += pStride)
+    {
+        int32_t value = pSamples[i] >> pShift;
+        sum += value;
+        sumOfSquares += (int64_t)value * value;
+        count++;
+        minValue = value < minValue ? value : minValue;
+        maxValue = value > maxValue ? value : maxValue;
+    }
+
+    SoundBlockLevel level;
+    level.SampleCount = count;
+    if (count > 0)
+    {
+        level.Min = minValue;
+        level.Max = maxValue;
+        // Variance = (n * sum(x^2) - sum(x)^2) / n^2, the DC offset is removed this way
+        int64_t numerator = (int64_t)count * sumOfSquares - sum * sum;
+        level.Rms = numerator > 0 ? sqrtf((float)numerator) / count : 0.0;
+    }
+    return level;
+}
+
+// Index of the channel of an interleaved block which carries the signal
+// The SPH0645 delivers its samples in the left or the right slot, depending on the SEL pin,
+// the other slot is always 0. The slot with more samples which are not 0 is taken.
+inline size_t findUsedChannel(const int32_t * pSamples, size_t pCount, size_t pStride)
+{
+    size_t bestChannel = 0;
+    size_t bestCount = 0;
+    for (size_t channel = 0; channel < pStride; channel++)
+    {
+        size_t count = 0;
+        for (size_t i = channel; i < pCount; i += pStride)
+        {
+            count += pSamples[i] != 0;
+        }
+        if (count > bestCount)
+        {
+            bestCount = count;
+            bestChannel = channel;
+        }
+    }
+    return bestChannel;
+}
+
+#define SOUND_GOERTZEL_COEFF_SHIFT 14
+
+// Goertzel coefficient 2 * cos(2 * pi * f / fs) in fixed point (Q14)
+inline int32_t computeGoertzelCoefficient(float pFrequency, float pSampleRate)
+{
+    return (int32_t)lroundf(2.0f * cosf(2.0f * (float)M_PI * pFrequency / pSampleRate) * (1 << SOUND_GOERTZEL_COEFF_SHIFT));
+}
+
+// Mean square of the signal in one Goertzel bin of a block of 32 bit I2S samples
+// The samples are selected and scaled like in computeSoundBlockLevel()
+// For a sine with amplitude A in the center of the bin the result is A^2 / 2, so it
+// can be compared with the square of the RMS of the block
+// Costs one multiplication per sample and bin, much cheaper than a FFT for a few bins
+inline float computeGoertzelMeanSquare(const int32_t * pSamples, size_t pCount, int32_t pCoeff, size_t pStride = 1, size_t pFirst = 0, int pShift = 14)
+{
+    int64_t s1 = 0;
+    int64_t s2 = 0;
+    uint32_t count = 0;
+    for (size_t i = pFirst; i < pCount; i += pStride)
+    {
+        int64_t s0 = (int64_t)(pSamples[i] >> pShift) + ((pCoeff * s1) >> SOUND_GOERTZEL_COEFF_SHIFT) - s2;
+        s2 = s1;
+        s1 = s0;
+        count++;
+    }
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    float f1 = (float)s1;
+    float f2 = (float)s2;
+    float power = f1 * f1 + f2 * f2 - ((float)pCoeff / (1 << SOUND_GOERTZEL_COEFF_SHIFT)) * f1 * f2;
+    return power > 0.0f ? 2.0f * power / ((float)count * count) : 0.0;
+}
+
+#endif  // _SOUND_BLOCK_KERNEL_H_
@@ -81,9 +81,10 @@ static const i2s_pin_config_t pin_config = {
 };
 */
 
-SoundSwitcher::SoundSwitcher(i2s_pin_config_t config, MicType micType)
+SoundSwitcher::SoundSwitcher(i2s_pin_config_t config, MicType pMicType)
 {
   pin_config = config;
+  micType = pMicType;
   if (micType == MicType::SPH0645LM4H)
   {
     // https://www.esp32.com/viewtopic.php?t=4997
@@ -149,7 +150,13 @@ FeedResponse SoundSwitcher::feed()
         if (millis() - lastFeedTimeMillis > feedIntervalMs)
         { 
             lastFeedTimeMillis = millis(); 
-            soundVolume = getSoundFromMicro();
+            bool volumeIsValid = true;
+            soundVolume = captureIsRunning ? getSoundFromCapturedBlocks(&volumeIsValid) : getSoundFromMicro();
+            if (!volumeIsValid)
+            {
+                hasSwitched = false;
+                return feedResponse;
+            }
             if (bufferIsFilled)
             {
                 // limit the effect of short very high sound levels
@@ -263,48 +270,163 @@ void SoundSwitcher::SetActive()
 float SoundSwitcher::getSoundFromMicro()
 {   
     int32_t audio_buf[BUFLEN];
-    size_t bytes_read;
+    size_t bytes_read = 0;
     i2s_read(i2s_num, audio_buf, sizeof(audio_buf), &bytes_read, portMAX_DELAY);  
-    int32_t cleanBuf[BUFLEN / 2] {0};
-    int cleanBufIdx = 0;
-    for (int i = 0; i < BUFLEN; i++)
+    return volumeFromLevel(analyseBlock(audio_buf, bytes_read / sizeof(int32_t)));
+}
+
+SoundBlockLevel SoundSwitcher::analyseBlock(const int32_t * pSamples, size_t pCount)
+{
+    // Only one of the interleaved channels of the SPH0645 carries samples
+    const size_t stride = micType == MicType::SPH0645LM4H ? 2 : 1;
+    const size_t first = stride > 1 ? findUsedChannel(pSamples, pCount, stride) : 0;
+    SoundBlockLevel level = computeSoundBlockLevel(pSamples, pCount, stride, first);
+    if (spectralBinCount > 0 && level.SampleCount > 0)
     {
-      if (audio_buf[i] != 0)    // Exclude values from other channel
-      {
-          cleanBuf[cleanBufIdx] = audio_buf[i] >> 14;
-          cleanBufIdx++;
-      }
+        float bandMeanSquare = 0.0;
+        for (size_t i = 0; i < spectralBinCount; i++)
+        {
+            bandMeanSquare += computeGoertzelMeanSquare(pSamples, pCount, spectralCoeffs[i], stride, first);
+        }
+        level.BandRms = sqrtf(bandMeanSquare);
+        float meanSquare = level.Rms * level.Rms;
+        level.BandRatio = meanSquare > 0.0 ? bandMeanSquare / meanSquare : 0.0;
+    }
+    return level;
+}
+
+// Value which is compared to find the loudest block
+float SoundSwitcher::loudness(SoundBlockLevel pLevel)
+{
+    if (spectralBinCount > 0)
+    {
+        return pLevel.BandRatio < minBandRatio ? 0.0 : pLevel.BandRms;
+    }
+    return (float)(pLevel.Max - pLevel.Min);
+}
+
+// The volume is the 'peak to peak' value of the block
+// In the spectral mode it is the level in the bins (2 * sqrt(2) * RMS, the peak to peak value of a sine)
+float SoundSwitcher::volumeFromLevel(SoundBlockLevel pLevel)
+{
+    if (pLevel.SampleCount == 0)
+    {
+        return 0.0;
+    }
+    float amplitude = spectralBinCount > 0 ? 2.0f * 1.4142f * loudness(pLevel) : loudness(pLevel);
+    float retValue = amplitude * calibFactor + calibOffset;
+    return retValue <= 0.0 ? 0.0 : retValue;
+}
+
+void SoundSwitcher::SetSpectralBands(const float * pFrequencies, size_t pCount, float pMinBandRatio)
+{
+    float sampleRate = micType == MicType::SPH0645LM4H ? i2s_config_SPH0645LM4H.sample_rate : i2s_config_INMP441.sample_rate;
+    pCount = pCount < SOUND_MAX_SPECTRAL_BINS ? pCount : SOUND_MAX_SPECTRAL_BINS;
+    for (size_t i = 0; i < pCount; i++)
+    {
+        spectralCoeffs[i] = computeGoertzelCoefficient(pFrequencies[i], sampleRate);
+    }
+    minBandRatio = pMinBandRatio;
+    spectralBinCount = pCount;
+}
+
+float SoundSwitcher::getSoundFromCapturedBlocks(bool * outIsValid)
+{
+    SoundBlockLevel level;
+    SoundBlockLevel loudestLevel;
+    bool hasBlock = false;
+    while (xQueueReceive(blockQueue, &level, 0) == pdTRUE)
+    {
+        if (!hasBlock || loudness(level) > loudness(loudestLevel))
+        {
+            loudestLevel = level;
+        }
+        hasBlock = true;
     }
-    float meanval = 0;
-    int volCount = 0;
-    for (int i=0; i < BUFLEN / 2; i++) 
+    *outIsValid = hasBlock;
+    if (!hasBlock)
     {
-         if (cleanBuf[i] != 0)
-         {
-          meanval += cleanBuf[i];
-          volCount++;
-         }
+        return 0.0;
     }
-    meanval /= volCount;
+    lastBlockLevel = loudestLevel;
+    return volumeFromLevel(loudestLevel);
+}
 
-    // subtract it from all sapmles to get a 'normalized' output
-    for (int i=0; i< volCount; i++) 
+bool SoundSwitcher::StartCapture(UBaseType_t pPriority, BaseType_t pCore)
+{
+    if (captureIsRunning)
+    {
+        return true;
+    }
+    if (blockQueue == NULL)
+    {
+        blockQueue = xQueueCreate(SOUND_CAPTURE_QUEUE_LENGTH, sizeof(SoundBlockLevel));
+        if (blockQueue == NULL)
+        {
+            return false;
+        }
+    }
+    captureIsRunning = true;
+    if (xTaskCreatePinnedToCore(captureTask, "SoundCapture", SOUND_CAPTURE_STACK_SIZE, this, pPriority, &captureTaskHandle, pCore) != pdPASS)
     {
-        cleanBuf[i] -= meanval;
+        captureIsRunning = false;
+        return false;
     }
+    return true;
+}
+
+void SoundSwitcher::StopCapture()
+{
+    // The task ends itself after the running read
+    captureIsRunning = false;
+}
+
+// Reads exactly one DMA buffer with each i2s_read, so every sample is used
+void SoundSwitcher::captureTask(void * pParameter)
+{
+    SoundSwitcher * soundSwitcher = (SoundSwitcher *)pParameter;
 
-    // find the 'peak to peak' max
-    float maxsample, minsample;
-    minsample = 100000;
-    maxsample = -100000;
-    for (int i=0; i<volCount; i++) {
-      minsample = _min(minsample, cleanBuf[i]);
-      maxsample = _max(maxsample, cleanBuf[i]);
+    // Both channels are delivered for SPH0645LM4H, only the left one for INMP441
+    const i2s_config_t * config = soundSwitcher ->micType == MicType::SPH0645LM4H ? &i2s_config_SPH0645LM4H : &i2s_config_INMP441;
+    const size_t channels = soundSwitcher ->micType == MicType::SPH0645LM4H ? 2 : 1;
+    const size_t blockBytes = config ->dma_buf_len * channels * sizeof(int32_t);
+
+    int32_t block[BUFLEN];
+    while (soundSwitcher ->captureIsRunning)
+    {
+        size_t bytes_read = 0;
+        if ((i2s_read(i2s_num, block, blockBytes <= sizeof(block) ? blockBytes : sizeof(block), &bytes_read, pdMS_TO_TICKS(100)) != ESP_OK) || (bytes_read == 0))
+        {
+            continue;
+        }
+        SoundBlockLevel level = soundSwitcher ->analyseBlock(block, bytes_read / sizeof(int32_t));
+        level.Millis = millis();
+        soundSwitcher ->capturedBlockCount++;
+
+        // If feed() is not called in time, the oldest level is dropped
+        if (xQueueSend(soundSwitcher ->blockQueue, &level, 0) != pdTRUE)
+        {
+            SoundBlockLevel dropped;
+            xQueueReceive(soundSwitcher ->blockQueue, &dropped, 0);
+            xQueueSend(soundSwitcher ->blockQueue, &level, 0);
+            soundSwitcher ->droppedBlockCount++;
+        }
     }
-       
-    float retValue = (maxsample - minsample) * calibFactor + calibOffset;
-    retValue = retValue <= 0.0 ? 0.0 : retValue;
-    //Serial.print("Volume: ");
-    //Serial.println(retValue); 
-    return retValue;   
-}
\ No newline at end of file
+    soundSwitcher ->captureTaskHandle = NULL;
+    vTaskDelete(NULL);
+}
+
+uint32_t SoundSwitcher::GetCapturedBlockCount()
+{
+    return capturedBlockCount;
+}
+
+uint32_t SoundSwitcher::GetDroppedBlockCount()
+{
+    return droppedBlockCount;
+}
+
+SoundBlockLevel SoundSwitcher::GetLastBlockLevel()
+{
+    return lastBlockLevel;
+}
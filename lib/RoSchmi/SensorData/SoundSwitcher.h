@@ -30,15 +30,31 @@
 //                        If .isValid is true, Feedresponse.hasToggled is checked
 //                        If .hasToggled is true, your reaction on the change of the
 //                        state has to be performed
+//
+// soundSwitcher.StartCapture() : Is optional. A task reads every I2S DMA block continuously
+//                        and puts the level of the block into a queue. feed() then uses the
+//                        loudest of all blocks which arrived since the last update interval
+//                        instead of reading one buffer, so short bursts are not missed
+//
+// soundSwitcher.SetSpectralBands() : Is optional. Instead of the broadband volume the level in
+//                        a few frequency bins (Goertzel) is used, e.g. the hum of the burner.
+//                        Blocks where the bins have less than minBandRatio of the energy
+//                        (voices, washing machine) count as silence.
+//                        Has to be called before StartCapture()
 
 
 #include <Arduino.h>
 #include <driver/i2s.h>
 #include "soc/i2s_reg.h"
+#include "SoundBlockKernel.h"
 
 #ifndef _SOUND_SWITCHER_H_
 #define _SOUND_SWITCHER_H_
 
+#define SOUND_CAPTURE_QUEUE_LENGTH 32     // levels of DMA blocks which can wait for feed()
+#define SOUND_CAPTURE_STACK_SIZE 3072
+#define SOUND_MAX_SPECTRAL_BINS 4
+
 typedef struct
     {
         bool isValid = false;
@@ -96,6 +112,30 @@ public:
     bool hasToggled();
     bool GetState();
 
+    /**
+    * @brief Starts the task which reads the I2S DMA blocks continuously
+    *
+    * @param[in] pPriority Priority of the task
+    * @param[in] pCore The core the task runs on
+    * @return false if the task or the queue could not be created
+    */
+    bool StartCapture(UBaseType_t pPriority = 2, BaseType_t pCore = 0);
+    void StopCapture();
+    uint32_t GetCapturedBlockCount();
+    uint32_t GetDroppedBlockCount();      // blocks which were not taken by feed() in time
+
+    /**
+    * @brief Switches to the spectral mode, the volume is the level in the given frequency bins
+    *
+    * @param[in] pFrequencies Center frequencies of the bins in Hz (max SOUND_MAX_SPECTRAL_BINS)
+    * @param[in] pCount Number of bins, 0 switches back to the broadband volume
+    * @param[in] pMinBandRatio Part of the energy of a block which must be in the bins (0.0 - 1.0)
+    */
+    void SetSpectralBands(const float * pFrequencies, size_t pCount, float pMinBandRatio = 0.3);
+
+    // The level of the loudest block of the last update interval (capture mode)
+    SoundBlockLevel GetLastBlockLevel();
+
 private:
 
      i2s_pin_config_t pin_config = {
@@ -113,6 +153,21 @@ private:
     bool hasSwitched = false;
     bool analogSendIsPending = false;
     float getSoundFromMicro();
+    float getSoundFromCapturedBlocks(bool * outIsValid);
+    float volumeFromLevel(SoundBlockLevel pLevel);
+    SoundBlockLevel analyseBlock(const int32_t * pSamples, size_t pCount);
+    float loudness(SoundBlockLevel pLevel);
+    int32_t spectralCoeffs[SOUND_MAX_SPECTRAL_BINS];
+    size_t spectralBinCount = 0;
+    float minBandRatio = 0.3;
+    static void captureTask(void * pParameter);
+    MicType micType = MicType::INMP441;
+    TaskHandle_t captureTaskHandle = NULL;
+    QueueHandle_t blockQueue = NULL;
+    volatile bool captureIsRunning = false;
+    volatile uint32_t capturedBlockCount = 0;
+    volatile uint32_t droppedBlockCount = 0;
+    SoundBlockLevel lastBlockLevel;
     float soundVolume;
     float threshold;
     int hysteresis;
@@ -478,6 +478,18 @@ uint32_t DateTime::unixtime(void) const {
   return t;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Return the number of the day: days since 1 Jan 1970.
+    Two DateTimes are on the same date if their day numbers are equal,
+    this is much cheaper than comparing the formatted dates.
+    @return Number of days since 1970-01-01.
+*/
+/**************************************************************************/
+uint32_t DateTime::daysSinceEpoch() const {
+  return date2days(yOff, m, d) + SECONDS_FROM_1970_TO_2000 / SECONDS_PER_DAY;
+}
+
 /**************************************************************************/
 /*!
     @brief  Convert the DateTime to seconds since 1 Jan 2000
@@ -587,6 +599,132 @@ String DateTime::timestamp(timestampOpt opt) {
   return String(buffer);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Write two digits of a value (0--99) to a buffer
+    @param p Pointer to the position in the buffer
+    @param v The value
+    @return Pointer to the position after the digits
+*/
+/**************************************************************************/
+static char *put2d(char *p, uint8_t v) {
+  *p++ = '0' + v / 10;
+  *p++ = '0' + v % 10;
+  return p;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write an ISO 8601 timestamp to a buffer.
+    Same formats as `timestamp()`, but without a heap allocation and
+    without sprintf.
+    @param buffer Buffer for the timestamp
+    @param size Size of the buffer, at least 20 for `TIMESTAMP_FULL`,
+        11 for `TIMESTAMP_DATE` and 9 for `TIMESTAMP_TIME`
+    @param opt Format of the timestamp
+    @return Length of the timestamp, 0 if the buffer is too small (then
+        the buffer is left empty).
+*/
+/**************************************************************************/
+size_t DateTime::format_to(char *buffer, size_t size,
+                           timestampOpt opt) const {
+  size_t length = opt == TIMESTAMP_FULL ? 19 : opt == TIMESTAMP_DATE ? 10 : 8;
+  if (buffer == nullptr || size == 0) {
+    return 0;
+  }
+  if (size <= length) {
+    buffer[0] = '\0';
+    return 0;
+  }
+  char *p = buffer;
+  if (opt != TIMESTAMP_TIME) {
+    p = put2d(p, 20);
+    p = put2d(p, yOff);
+    *p++ = '-';
+    p = put2d(p, m);
+    *p++ = '-';
+    p = put2d(p, d);
+  }
+  if (opt == TIMESTAMP_FULL) {
+    *p++ = 'T';
+  }
+  if (opt != TIMESTAMP_DATE) {
+    p = put2d(p, hh);
+    *p++ = ':';
+    p = put2d(p, mm);
+    *p++ = ':';
+    p = put2d(p, ss);
+  }
+  *p = '\0';
+  return length;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read a number with a fixed count of digits
+    @param p Pointer to the first digit
+    @param count Number of digits
+    @param out The value
+    @return false if one of the chars is not a digit
+*/
+/**************************************************************************/
+static bool parseDigits(const char *p, uint8_t count, uint16_t *out) {
+  uint16_t v = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (p[i] < '0' || p[i] > '9') {
+      return false;
+    }
+    v = v * 10 + (p[i] - '0');
+  }
+  *out = v;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parse an ISO 8601 date or date and time string.
+    Unlike the `DateTime(const char *)` constructor the string is
+    validated, accepted are "YYYY-MM-DD" and "YYYY-MM-DDThh:mm:ss"
+    (also with ' ' instead of 'T'), chars which follow are ignored.
+    @param iso8601dateTime The string, e.g. "2020-06-25T15:29:37"
+    @param outDateTime The parsed DateTime, unchanged if the string is not
+        valid
+    @return true if the string was a valid date (2000--2099)
+*/
+/**************************************************************************/
+bool DateTime::parse(const char *iso8601dateTime, DateTime *outDateTime) {
+  if (iso8601dateTime == nullptr || outDateTime == nullptr) {
+    return false;
+  }
+  const char *p = iso8601dateTime;
+  uint16_t year, month, day, hour = 0, minute = 0, second = 0;
+  if (!parseDigits(p, 4, &year) || p[4] != '-' ||
+      !parseDigits(p + 5, 2, &month) || p[7] != '-' ||
+      !parseDigits(p + 8, 2, &day)) {
+    return false;
+  }
+  if (p[10] == 'T' || p[10] == ' ') {
+    if (!parseDigits(p + 11, 2, &hour) || p[13] != ':' ||
+        !parseDigits(p + 14, 2, &minute) || p[16] != ':' ||
+        !parseDigits(p + 17, 2, &second)) {
+      return false;
+    }
+  }
+  if (year < 2000 || year > 2099 || month < 1 || month > 12 || day < 1 ||
+      hour > 23 || minute > 59 || second > 59) {
+    return false;
+  }
+  uint8_t monthDays = month == 12 ? 31 : pgm_read_byte(daysInMonth + month - 1);
+  if (month == 2 && year % 4 == 0) {
+    monthDays++;
+  }
+  if (day > monthDays) {
+    return false;
+  }
+  *outDateTime = DateTime(year, month, day, hour, minute, second);
+  return true;
+}
+
 /**************************************************************************/
 /*!
     @brief  Create a new TimeSpan object in seconds
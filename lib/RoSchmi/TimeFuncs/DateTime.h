@@ -85,6 +85,7 @@ public:
   DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0,
            uint8_t min = 0, uint8_t sec = 0);
   DateTime(const DateTime &copy);
+  DateTime &operator=(const DateTime &copy) = default;
   DateTime(const char *date, const char *time);
   DateTime(const __FlashStringHelper *date, const __FlashStringHelper *time);
   DateTime(const char *iso8601date);
@@ -138,6 +139,9 @@ public:
   /* 32-bit times as seconds since 1970-01-01. */
   uint32_t unixtime(void) const;
 
+  /* Number of the day, days since 1970-01-01. */
+  uint32_t daysSinceEpoch() const;
+
   /*!
       Format of the ISO 8601 timestamp generated by `timestamp()`. Each
       option corresponds to a `toString()` format as follows:
@@ -148,6 +152,9 @@ public:
     TIMESTAMP_DATE  //!< `YYYY-MM-DD`
   };
   String timestamp(timestampOpt opt = TIMESTAMP_FULL);
+  size_t format_to(char *buffer, size_t size,
+                   timestampOpt opt = TIMESTAMP_FULL) const;
+  static bool parse(const char *iso8601dateTime, DateTime *outDateTime);
 
   DateTime operator+(const TimeSpan &span);
   DateTime operator-(const TimeSpan &span);
@@ -0,0 +1,131 @@
+#include "ClockDiscipline.h"
+#include <esp_timer.h>
+
+// References before this (e.g. the DateTime() of a header which could not be parsed) are ignored
+#define CLOCK_MIN_VALID_UTC_SECONDS 1577836800      // 2020-01-01
+
+// Constructor
+ClockDiscipline::ClockDiscipline()
+{}
+
+void ClockDiscipline::Begin(uint32_t pStepThresholdSeconds, uint32_t pMaxSlewPpm, uint32_t pDriftBaselineSeconds)
+{
+    portENTER_CRITICAL(&lock);
+    stepThresholdUs = (int64_t)pStepThresholdSeconds * 1000000;
+    maxSlewRate = pMaxSlewPpm * 1e-6f;
+    driftBaselineUs = (int64_t)pDriftBaselineSeconds * 1000000;
+    portEXIT_CRITICAL(&lock);
+}
+
+int64_t ClockDiscipline::utcMicrosAt(int64_t pMonoUs)
+{
+    int64_t elapsedUs = pMonoUs - refMonoUs;
+    // The pending offset is corrected with max slew rate, so the time never runs backwards
+    int64_t maxSlewUs = (int64_t)(elapsedUs * maxSlewRate);
+    int64_t slewUs = pendingSlewUs > maxSlewUs ? maxSlewUs : pendingSlewUs < -maxSlewUs ? -maxSlewUs : pendingSlewUs;
+    return refUtcUs + elapsedUs + (int64_t)(elapsedUs * driftRate) + slewUs;
+}
+
+void ClockDiscipline::rebase(int64_t pMonoUs)
+{
+    int64_t utcUs = utcMicrosAt(pMonoUs);
+    pendingSlewUs -= utcUs - refUtcUs - (pMonoUs - refMonoUs) - (int64_t)((pMonoUs - refMonoUs) * driftRate);
+    refUtcUs = utcUs;
+    refMonoUs = pMonoUs;
+}
+
+bool ClockDiscipline::AddReference(uint32_t pUtcSeconds, ClockSource pSource)
+{
+    if (pUtcSeconds < CLOCK_MIN_VALID_UTC_SECONDS)
+    {
+        return false;
+    }
+    int64_t monoUs = esp_timer_get_time();
+    int64_t referenceUs = (int64_t)pUtcSeconds * 1000000;
+
+    portENTER_CRITICAL(&lock);
+    stats.ReferenceCount++;
+    stats.NtpCount += pSource == ClockSource::Ntp ? 1 : 0;
+    lastReferenceMonoUs = monoUs;
+
+    int64_t clockUs = isSynchronized ? utcMicrosAt(monoUs) : 0;
+    // The reference is truncated to the second: the clock is right, if it is within this second,
+    // otherwise it is corrected to the middle of the second
+    int64_t offsetUs = (clockUs >= referenceUs && clockUs < referenceUs + 1000000) ? 0 : referenceUs + 500000 - clockUs;
+    stats.LastOffsetMs = isSynchronized ? (int32_t)(offsetUs / 1000) : 0;
+
+    if (!isSynchronized || offsetUs >= stepThresholdUs || offsetUs <= -stepThresholdUs)
+    {
+        refMonoUs = monoUs;
+        refUtcUs = referenceUs + 500000;
+        pendingSlewUs = 0;
+        stats.StepCount += isSynchronized ? 1 : 0;
+        isSynchronized = true;
+        // A step would falsify the drift measurement
+        driftAnchorIsValid = false;
+    }
+    else
+    {
+        rebase(monoUs);
+        pendingSlewUs = offsetUs;
+    }
+
+    if (!driftAnchorIsValid)
+    {
+        driftAnchorIsValid = true;
+        driftAnchorMonoUs = monoUs;
+        driftAnchorUtcUs = referenceUs;
+    }
+    else if (monoUs - driftAnchorMonoUs >= driftBaselineUs)
+    {
+        // Rate error of the crystal, independent of the correction which is applied
+        int64_t monoSpanUs = monoUs - driftAnchorMonoUs;
+        double measuredRate = (double)((referenceUs - driftAnchorUtcUs) - monoSpanUs) / monoSpanUs;
+        if (measuredRate < CLOCK_MAX_DRIFT_PPM * 1e-6 && measuredRate > -CLOCK_MAX_DRIFT_PPM * 1e-6)
+        {
+            rebase(monoUs);
+            // The first measurement is taken as is, then the measurements are smoothed
+            driftRate = driftIsMeasured ? driftRate + (measuredRate - driftRate) * 0.25 : measuredRate;
+            driftIsMeasured = true;
+            stats.DriftPpm = (float)(driftRate * 1e6);
+        }
+        driftAnchorMonoUs = monoUs;
+        driftAnchorUtcUs = referenceUs;
+    }
+    portEXIT_CRITICAL(&lock);
+    return true;
+}
+
+int64_t ClockDiscipline::GetUtcMicros()
+{
+    int64_t monoUs = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    int64_t utcUs = isSynchronized ? utcMicrosAt(monoUs) : 0;
+    portEXIT_CRITICAL(&lock);
+    return utcUs;
+}
+
+uint32_t ClockDiscipline::GetUtcSeconds()
+{
+    return (uint32_t)(GetUtcMicros() / 1000000);
+}
+
+bool ClockDiscipline::IsSynchronized()
+{
+    return isSynchronized;
+}
+
+bool ClockDiscipline::ReferenceIsDue(uint32_t pMaxAgeSeconds)
+{
+    return !isSynchronized || (esp_timer_get_time() - lastReferenceMonoUs) >= (int64_t)pMaxAgeSeconds * 1000000;
+}
+
+ClockStats ClockDiscipline::GetStats()
+{
+    int64_t monoUs = esp_timer_get_time();
+    portENTER_CRITICAL(&lock);
+    ClockStats result = stats;
+    result.SecondsSinceReference = (uint32_t)((monoUs - lastReferenceMonoUs) / 1000000);
+    portEXIT_CRITICAL(&lock);
+    return result;
+}
@@ -0,0 +1,100 @@
+#include <Arduino.h>
+
+#ifndef _CLOCKDISCIPLINE_H_
+#define _CLOCKDISCIPLINE_H_
+
+#define CLOCK_DEFAULT_STEP_THRESHOLD_SECONDS 2     // larger offsets are stepped, smaller ones are slewed
+#define CLOCK_DEFAULT_MAX_SLEW_PPM 5000            // 5 ms per second
+#define CLOCK_DEFAULT_DRIFT_BASELINE_SECONDS 43200 // min time between two drift measurements
+#define CLOCK_MAX_DRIFT_PPM 500                    // larger estimates are not plausible for a crystal
+
+// Source of a reference timestamp
+enum class ClockSource
+{
+    Ntp = 0,
+    Azure = 1           // 'Date' header of an Azure response
+};
+
+typedef struct
+{
+    uint32_t ReferenceCount = 0;
+    uint32_t NtpCount = 0;
+    uint32_t StepCount = 0;
+    int32_t LastOffsetMs = 0;           // offset of the last reference to the disciplined clock
+    float DriftPpm = 0.0;               // estimated rate error of the crystal (positive: crystal is slow)
+    uint32_t SecondsSinceReference = 0;
+}
+ClockStats;
+
+// Disciplined system time: the time runs on the esp_timer (microseconds since boot), corrected by
+// the estimated drift of the crystal. NTP replies and the 'Date' headers of the Azure responses are
+// only references: small offsets are slewed with a limited rate, so the time never jumps or runs
+// backwards, only large offsets (first reference, long outage) are stepped.
+// The drift is measured from references which are at least the drift baseline apart, this averages
+// out the one second resolution of the references. With frequent uploads the Azure references keep
+// the clock correct, then NTP is only needed when ReferenceIsDue()
+// Thread safe, the time can be read from all tasks
+class ClockDiscipline
+{
+public:
+    ClockDiscipline();
+
+    /**
+    * @brief Sets the limits of the discipline
+    *
+    * @param[in] pStepThresholdSeconds Offsets of at least this are corrected by a step
+    * @param[in] pMaxSlewPpm Max rate of the correction of smaller offsets
+    * @param[in] pDriftBaselineSeconds Min time between two references which are used to measure the drift
+    */
+    void Begin(uint32_t pStepThresholdSeconds = CLOCK_DEFAULT_STEP_THRESHOLD_SECONDS, uint32_t pMaxSlewPpm = CLOCK_DEFAULT_MAX_SLEW_PPM,
+               uint32_t pDriftBaselineSeconds = CLOCK_DEFAULT_DRIFT_BASELINE_SECONDS);
+
+    /**
+    * @brief Adds a reference timestamp
+    *
+    * @param[in] pUtcSeconds The UTC time of the reference (seconds since 1970, truncated)
+    * @param[in] pSource The source of the reference
+    * @return false if the timestamp was not plausible and was ignored
+    */
+    bool AddReference(uint32_t pUtcSeconds, ClockSource pSource);
+
+    // Disciplined UTC time in seconds since 1970 (0 before the first reference)
+    uint32_t GetUtcSeconds();
+
+    // Disciplined UTC time in microseconds since 1970
+    int64_t GetUtcMicros();
+
+    bool IsSynchronized();
+
+    /**
+    * @brief Returns true if the last reference is older than pMaxAgeSeconds (an NTP update is needed)
+    */
+    bool ReferenceIsDue(uint32_t pMaxAgeSeconds);
+
+    ClockStats GetStats();
+
+private:
+    int64_t utcMicrosAt(int64_t pMonoUs);
+    void rebase(int64_t pMonoUs);
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    bool isSynchronized = false;
+    int64_t stepThresholdUs = (int64_t)CLOCK_DEFAULT_STEP_THRESHOLD_SECONDS * 1000000;
+    float maxSlewRate = CLOCK_DEFAULT_MAX_SLEW_PPM * 1e-6f;
+    int64_t driftBaselineUs = (int64_t)CLOCK_DEFAULT_DRIFT_BASELINE_SECONDS * 1000000;
+
+    int64_t refMonoUs = 0;          // esp_timer time of the last rebase
+    int64_t refUtcUs = 0;           // disciplined time at the last rebase
+    int64_t pendingSlewUs = 0;      // offset which is corrected after the last rebase
+    double driftRate = 0.0;         // rate correction (1e-6 = 1 ppm)
+    bool driftIsMeasured = false;
+
+    bool driftAnchorIsValid = false;
+    int64_t driftAnchorMonoUs = 0;
+    int64_t driftAnchorUtcUs = 0;
+
+    int64_t lastReferenceMonoUs = 0;
+    ClockStats stats;
+};
+
+#endif  // _CLOCKDISCIPLINE_H_
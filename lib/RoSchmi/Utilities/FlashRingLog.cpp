@@ -0,0 +1,225 @@
+#include "FlashRingLog.h"
+#include "DateTime.h"
+#include <rom/crc.h>
+
+// Constructor
+FlashRingLog::FlashRingLog()
+{}
+
+bool FlashRingLog::Begin(fs::FS * pFileSystem, const char * pPath, uint32_t pSectorCount)
+{
+    if (logMutex == NULL)
+    {
+        logMutex = xSemaphoreCreateMutex();
+    }
+    fileSystem = pFileSystem;
+    strncpy(path, pPath, sizeof(path) - 1);
+    slotsPerSector = RING_LOG_SECTOR_SIZE / sizeof(Record);
+    slotCount = slotsPerSector * (pSectorCount > 0 ? pSectorCount : 1);
+    uint32_t fileSize = (slotCount / slotsPerSector) * RING_LOG_SECTOR_SIZE;
+    nextSlot = 0;
+    nextSequence = 1;
+    count = 0;
+
+    File file = fileSystem ->open(path, "r");
+    if (!file || file.size() != fileSize)
+    {
+        if (file)
+        {
+            file.close();
+        }
+        // New log or other number of sectors: the file is created once with its final size
+        return create(fileSize);
+    }
+
+    // The newest entry has the highest sequence number, the entry behind it is the oldest
+    RingLogEntry entry;
+    for (uint32_t slot = 0; slot < slotCount; slot++)
+    {
+        if (readSlot(&file, slot, &entry))
+        {
+            count++;
+            if (entry.Sequence >= nextSequence)
+            {
+                nextSequence = entry.Sequence + 1;
+                nextSlot = (slot + 1) % slotCount;
+                newest = entry;
+            }
+        }
+    }
+    file.close();
+    return true;
+}
+
+bool FlashRingLog::create(uint32_t pFileSize)
+{
+    File file = fileSystem ->open(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    uint8_t zeros[256] = {0};
+    for (uint32_t written = 0; written < pFileSize; written += sizeof(zeros))
+    {
+        if (file.write(zeros, sizeof(zeros)) != sizeof(zeros))
+        {
+            file.close();
+            fileSystem ->remove(path);
+            return false;
+        }
+    }
+    file.close();
+    return true;
+}
+
+bool FlashRingLog::Append(uint32_t pLocalTime, const char * pLogType, const char * pLogMessage)
+{
+    if (fileSystem == nullptr || slotCount == 0 || logMutex == NULL)
+    {
+        return false;
+    }
+    // Two tasks must not take the same slot and sequence number
+    xSemaphoreTake(logMutex, portMAX_DELAY);
+    // The padding is part of the CRC, so the record is cleared first
+    Record record;
+    memset((void *)&record, 0, sizeof(Record));
+    record.Entry.Sequence = nextSequence;
+    record.Entry.LocalTime = pLocalTime;
+    strncpy(record.Entry.LogType, pLogType, RING_LOG_MAX_TYPE_LENGTH);
+    strncpy(record.Entry.LogMessage, pLogMessage, RING_LOG_MAX_MESSAGE_LENGTH);
+    record.Crc = calcCrc(&record.Entry);
+
+    // Only the slot is overwritten, LittleFS copies the block which holds it (copy-on-write)
+    File file = fileSystem ->open(path, "r+");
+    bool result = file && file.seek(slotPosition(nextSlot)) && file.write((const uint8_t *)&record, sizeof(Record)) == sizeof(Record);
+    if (file)
+    {
+        file.close();
+    }
+    // If it failed, the slot is written again with the next entry
+    if (result)
+    {
+        newest = record.Entry;
+        nextSequence++;
+        nextSlot = (nextSlot + 1) % slotCount;
+        count += count < slotCount ? 1 : 0;
+    }
+    xSemaphoreGive(logMutex);
+    return result;
+}
+
+bool FlashRingLog::GetNewest(RingLogEntry * outEntry)
+{
+    if (logMutex == NULL)
+    {
+        return false;
+    }
+    xSemaphoreTake(logMutex, portMAX_DELAY);
+    bool result = count > 0;
+    if (result)
+    {
+        *outEntry = newest;
+    }
+    xSemaphoreGive(logMutex);
+    return result;
+}
+
+// Writes the string with the quotes and backslashes escaped
+static void printJsonString(Print * pOutput, const char * pString)
+{
+    pOutput ->print('"');
+    for (const char * c = pString; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            pOutput ->print('\\');
+        }
+        pOutput ->print(*c);
+    }
+    pOutput ->print('"');
+}
+
+uint32_t FlashRingLog::ExportJson(Print * pOutput, uint32_t pMaxCount)
+{
+    pOutput ->print('[');
+    uint32_t exported = 0;
+    if (logMutex == NULL)
+    {
+        pOutput ->print(']');
+        return exported;
+    }
+    // No entry is appended while the slots are read
+    xSemaphoreTake(logMutex, portMAX_DELAY);
+    File file;
+    if (fileSystem != nullptr && count > 0)
+    {
+        file = fileSystem ->open(path, "r");
+    }
+    if (file)
+    {
+        // The last n slots before the next slot, the oldest first
+        uint32_t n = pMaxCount < count ? pMaxCount : count;
+        uint32_t firstSlot = (nextSlot + slotCount - n) % slotCount;
+        RingLogEntry entry;
+        char timeBuffer[20] = {'\0'};
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (!readSlot(&file, (firstSlot + i) % slotCount, &entry))
+            {
+                continue;
+            }
+            DateTime(entry.LocalTime).format_to(timeBuffer, sizeof(timeBuffer));
+            pOutput ->print(exported > 0 ? ",{\"time\":" : "{\"time\":");
+            printJsonString(pOutput, timeBuffer);
+            pOutput ->print(",\"logType\":");
+            printJsonString(pOutput, entry.LogType);
+            pOutput ->print(",\"logMess\":");
+            printJsonString(pOutput, entry.LogMessage);
+            pOutput ->print('}');
+            exported++;
+        }
+        file.close();
+    }
+    xSemaphoreGive(logMutex);
+    pOutput ->print(']');
+    return exported;
+}
+
+uint32_t FlashRingLog::GetCapacity()
+{
+    return slotCount;
+}
+
+uint32_t FlashRingLog::GetCount()
+{
+    return count;
+}
+
+uint32_t FlashRingLog::calcCrc(const RingLogEntry * pEntry)
+{
+    // CRC32 routine of the ESP32 ROM
+    return crc32_le(0, (const uint8_t *)pEntry, sizeof(RingLogEntry));
+}
+
+uint32_t FlashRingLog::slotPosition(uint32_t pSlot)
+{
+    // The rest of a sector, which cannot hold a whole record, is not used, so an append
+    // touches only one block of the file system
+    return (pSlot / slotsPerSector) * RING_LOG_SECTOR_SIZE + (pSlot % slotsPerSector) * sizeof(Record);
+}
+
+bool FlashRingLog::readSlot(File * pFile, uint32_t pSlot, RingLogEntry * outEntry)
+{
+    Record record;
+    if (!pFile ->seek(slotPosition(pSlot)) || pFile ->read((uint8_t *)&record, sizeof(Record)) != sizeof(Record))
+    {
+        return false;
+    }
+    // Empty slot or damaged record
+    if (record.Entry.Sequence == 0 || calcCrc(&record.Entry) != record.Crc)
+    {
+        return false;
+    }
+    *outEntry = record.Entry;
+    return true;
+}
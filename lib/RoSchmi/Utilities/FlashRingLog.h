@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <Print.h>
+
+#ifndef _FLASHRINGLOG_H_
+#define _FLASHRINGLOG_H_
+
+#define RING_LOG_SECTOR_SIZE 4096
+#define RING_LOG_DEFAULT_SECTORS 2
+#define RING_LOG_MAX_TYPE_LENGTH 7
+#define RING_LOG_MAX_MESSAGE_LENGTH 50
+#define RING_LOG_PATH_LENGTH 32
+
+// One entry of the log
+typedef struct
+{
+    uint32_t Sequence = 0;          // increments with every entry, 0 = empty slot
+    uint32_t LocalTime = 0;         // seconds since 1970 (local time)
+    char LogType[RING_LOG_MAX_TYPE_LENGTH + 1] = {'\0'};
+    char LogMessage[RING_LOG_MAX_MESSAGE_LENGTH + 1] = {'\0'};
+}
+RingLogEntry;
+
+// Log of error conditions etc. in a file of fixed size (whole flash sectors), which is created once.
+// The file is divided into slots of one record (entry + CRC32), records never cross a sector boundary.
+// An entry overwrites the oldest slot at a known position, so the file never grows and the log is
+// never read, parsed and written again as a whole.
+// LittleFS is copy-on-write: overwriting a slot writes the whole 4 kB block which holds it to a new
+// place and commits the file metadata on close, so an append costs about one block erase and program,
+// not a small write. Spreading the wear is done by LittleFS (its wear leveling), not by the ring.
+// As a slot never crosses a block boundary, an append copies one block and not two.
+// A power loss keeps the old or the new state of the file, the CRC finds a damaged record.
+// At boot the slots are scanned once to find the newest entry
+// The entries can be appended and read by several tasks (the state of the ring is guarded by a mutex)
+class FlashRingLog
+{
+public:
+    FlashRingLog();
+
+    /**
+    * @brief Opens the log file, creates it if it does not exist or has a different size
+    *
+    * @param[in] pFileSystem The file system (e.g. &LittleFS)
+    * @param[in] pPath The path of the log file
+    * @param[in] pSectorCount Size of the log file in flash sectors
+    * @return false if the log file could not be read or created
+    */
+    bool Begin(fs::FS * pFileSystem, const char * pPath, uint32_t pSectorCount = RING_LOG_DEFAULT_SECTORS);
+
+    /**
+    * @brief Appends an entry, the oldest entry is overwritten when the log is full
+    *
+    * @param[in] pLocalTime Timestamp of the entry (seconds since 1970)
+    * @param[in] pLogType Type of the entry (max RING_LOG_MAX_TYPE_LENGTH chars)
+    * @param[in] pLogMessage The message (max RING_LOG_MAX_MESSAGE_LENGTH chars)
+    * @return true if the record was written
+    */
+    bool Append(uint32_t pLocalTime, const char * pLogType, const char * pLogMessage);
+
+    /**
+    * @brief Copies the newest entry
+    *
+    * @param[out] outEntry The entry
+    * @return false if the log is empty
+    */
+    bool GetNewest(RingLogEntry * outEntry);
+
+    /**
+    * @brief Reads the newest entries one after the other (oldest first) and writes them as a Json array
+    *        [{"time":"...","logType":"...","logMess":"..."},...]
+    *
+    * @param[in] pOutput Destination (e.g. &Serial or a File)
+    * @param[in] pMaxCount Max number of entries
+    * @return Number of entries written
+    */
+    uint32_t ExportJson(Print * pOutput, uint32_t pMaxCount);
+
+    // Number of entries a full log holds
+    uint32_t GetCapacity();
+    uint32_t GetCount();
+
+private:
+    typedef struct
+    {
+        uint32_t Crc;       // CRC32 of the entry
+        RingLogEntry Entry;
+    }
+    Record;
+
+    static uint32_t calcCrc(const RingLogEntry * pEntry);
+    uint32_t slotPosition(uint32_t pSlot);
+    bool readSlot(File * pFile, uint32_t pSlot, RingLogEntry * outEntry);
+    bool create(uint32_t pFileSize);
+
+    fs::FS * fileSystem = nullptr;
+    char path[RING_LOG_PATH_LENGTH] = {'\0'};
+    uint32_t slotsPerSector = 0;
+    uint32_t slotCount = 0;
+    uint32_t nextSlot = 0;          // slot of the next entry (holds the oldest entry when the log is full)
+    uint32_t nextSequence = 1;
+    uint32_t count = 0;
+    RingLogEntry newest;
+    SemaphoreHandle_t logMutex = NULL;
+};
+
+#endif  // _FLASHRINGLOG_H_
@@ -0,0 +1,213 @@
+#include "JournaledStateStore.h"
+#include <rom/crc.h>
+
+#define JOURNAL_RECORD_MAGIC 0xA5
+
+// Constructor
+JournaledStateStore::JournaledStateStore()
+{}
+
+bool JournaledStateStore::Begin(fs::FS * pFileSystem, const char * pPath, size_t pMaxFileSize)
+{
+    fileSystem = pFileSystem;
+    strncpy(path, pPath, sizeof(path) - 1);
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    maxFileSize = pMaxFileSize;
+
+    // A compaction may have been interrupted by a reset
+    if (fileSystem ->exists(path))
+    {
+        if (fileSystem ->exists(tempPath))
+        {
+            fileSystem ->remove(tempPath);
+        }
+    }
+    else
+    {
+        if (fileSystem ->exists(tempPath))
+        {
+            fileSystem ->rename(tempPath, path);
+        }
+    }
+
+    if (!replay())
+    {
+        return false;
+    }
+    // Records behind a damaged record would never be read, so the damaged part is removed
+    if (discardedBytes > 0)
+    {
+        return Compact();
+    }
+    return true;
+}
+
+bool JournaledStateStore::replay()
+{
+    for (int i = 0; i < JOURNAL_MAX_KEYS; i++)
+    {
+        entries[i].IsValid = false;
+    }
+    fileSize = 0;
+    recordCount = 0;
+    discardedBytes = 0;
+
+    if (!fileSystem ->exists(path))
+    {
+        return true;
+    }
+    File file = fileSystem ->open(path, "r");
+    if (!file)
+    {
+        return false;
+    }
+    size_t size = file.size();
+    size_t position = 0;
+    uint8_t data[JOURNAL_MAX_VALUE_LENGTH];
+    while (position + sizeof(RecordHeader) <= size)
+    {
+        RecordHeader header;
+        if (file.read((uint8_t *)&header, sizeof(RecordHeader)) != sizeof(RecordHeader))
+        {
+            break;
+        }
+        if (header.Magic != JOURNAL_RECORD_MAGIC || header.Key >= JOURNAL_MAX_KEYS || header.Length > JOURNAL_MAX_VALUE_LENGTH)
+        {
+            break;
+        }
+        if (file.read(data, header.Length) != header.Length || calcCrc(header.Key, header.Length, data) != header.Crc)
+        {
+            // Torn write (power loss) or damaged flash
+            break;
+        }
+        entries[header.Key].IsValid = true;
+        entries[header.Key].Length = header.Length;
+        memcpy(entries[header.Key].Data, data, header.Length);
+        position += sizeof(RecordHeader) + header.Length;
+        recordCount++;
+    }
+    file.close();
+    fileSize = position;
+    discardedBytes = size - position;
+    return true;
+}
+
+bool JournaledStateStore::Put(uint8_t pKey, const void * pData, uint16_t pLength)
+{
+    if (fileSystem == nullptr || pKey >= JOURNAL_MAX_KEYS || pLength > JOURNAL_MAX_VALUE_LENGTH)
+    {
+        return false;
+    }
+    entries[pKey].IsValid = true;
+    entries[pKey].Length = pLength;
+    memcpy(entries[pKey].Data, pData, pLength);
+
+    if (fileSize + sizeof(RecordHeader) + pLength > maxFileSize)
+    {
+        // The new value is already in RAM, so it is written by the compaction
+        return Compact();
+    }
+    File file = fileSystem ->open(path, "a");
+    if (!file)
+    {
+        return false;
+    }
+    bool result = appendRecord(&file, pKey, (const uint8_t *)pData, pLength);
+    file.close();
+    if (!result)
+    {
+        // A partly written record would hide all following records
+        return Compact();
+    }
+    fileSize += sizeof(RecordHeader) + pLength;
+    recordCount++;
+    return true;
+}
+
+bool JournaledStateStore::Get(uint8_t pKey, void * outData, uint16_t pLength)
+{
+    if (pKey >= JOURNAL_MAX_KEYS || !entries[pKey].IsValid || entries[pKey].Length != pLength)
+    {
+        return false;
+    }
+    memcpy(outData, entries[pKey].Data, pLength);
+    return true;
+}
+
+bool JournaledStateStore::Contains(uint8_t pKey)
+{
+    return pKey < JOURNAL_MAX_KEYS && entries[pKey].IsValid;
+}
+
+bool JournaledStateStore::Compact()
+{
+    if (fileSystem == nullptr)
+    {
+        return false;
+    }
+    File file = fileSystem ->open(tempPath, "w");
+    if (!file)
+    {
+        return false;
+    }
+    size_t size = 0;
+    uint32_t count = 0;
+    for (int i = 0; i < JOURNAL_MAX_KEYS; i++)
+    {
+        if (entries[i].IsValid)
+        {
+            if (!appendRecord(&file, i, entries[i].Data, entries[i].Length))
+            {
+                file.close();
+                fileSystem ->remove(tempPath);
+                return false;
+            }
+            size += sizeof(RecordHeader) + entries[i].Length;
+            count++;
+        }
+    }
+    file.close();
+
+    // If a reset occurs between remove and rename, Begin() takes the temporary file
+    fileSystem ->remove(path);
+    if (!fileSystem ->rename(tempPath, path))
+    {
+        return false;
+    }
+    // discardedBytes keeps the damaged bytes found by Begin(), they are gone now
+    fileSize = size;
+    recordCount = count;
+    return true;
+}
+
+uint32_t JournaledStateStore::GetRecordCount()
+{
+    return recordCount;
+}
+
+uint32_t JournaledStateStore::GetDiscardedBytes()
+{
+    return discardedBytes;
+}
+
+uint32_t JournaledStateStore::calcCrc(uint8_t pKey, uint16_t pLength, const uint8_t * pData)
+{
+    // CRC32 routine of the ESP32 ROM
+    uint32_t crc = crc32_le(0, &pKey, sizeof(pKey));
+    crc = crc32_le(crc, (const uint8_t *)&pLength, sizeof(pLength));
+    return crc32_le(crc, pData, pLength);
+}
+
+bool JournaledStateStore::appendRecord(File * pFile, uint8_t pKey, const uint8_t * pData, uint16_t pLength)
+{
+    RecordHeader header;
+    header.Magic = JOURNAL_RECORD_MAGIC;
+    header.Key = pKey;
+    header.Length = pLength;
+    header.Crc = calcCrc(pKey, pLength, pData);
+    if (pFile ->write((const uint8_t *)&header, sizeof(RecordHeader)) != sizeof(RecordHeader))
+    {
+        return false;
+    }
+    return pFile ->write(pData, pLength) == pLength;
+}
@@ -0,0 +1,95 @@
+#include <Arduino.h>
+#include <FS.h>
+
+#ifndef _JOURNALEDSTATESTORE_H_
+#define _JOURNALEDSTATESTORE_H_
+
+#define JOURNAL_MAX_KEYS 8                // Keys 0 - 7
+#define JOURNAL_MAX_VALUE_LENGTH 64       // Max length of one value (bytes)
+#define JOURNAL_DEFAULT_MAX_FILE_SIZE 4096
+#define JOURNAL_PATH_LENGTH 32
+
+// Small key-value store for state which must survive a reset (e.g. the base value of the day of a meter)
+// Every Put appends one record (header with CRC32 + value) to a journal file, so an update costs
+// one small write and a power loss during the write can only destroy the record which was written.
+// At boot the journal is replayed once, the last valid record of each key is kept in RAM,
+// so Get is O(1). When the file exceeds its maximal size it is compacted (only the last record
+// of each key is rewritten to a temporary file, which then replaces the journal)
+class JournaledStateStore
+{
+public:
+    JournaledStateStore();
+
+    /**
+    * @brief Opens the journal and loads the last valid record of each key
+    *
+    * @param[in] pFileSystem The file system (e.g. &LittleFS)
+    * @param[in] pPath The path of the journal file
+    * @param[in] pMaxFileSize When the journal grows beyond this size it is compacted
+    * @return false if the journal could not be read or created
+    */
+    bool Begin(fs::FS * pFileSystem, const char * pPath, size_t pMaxFileSize = JOURNAL_DEFAULT_MAX_FILE_SIZE);
+
+    /**
+    * @brief Appends a new value for a key
+    *
+    * @param[in] pKey The key (0 - JOURNAL_MAX_KEYS-1)
+    * @param[in] pData The value
+    * @param[in] pLength The length of the value (max JOURNAL_MAX_VALUE_LENGTH)
+    * @return true if the record was written
+    */
+    bool Put(uint8_t pKey, const void * pData, uint16_t pLength);
+
+    /**
+    * @brief Copies the last value of a key
+    *
+    * @param[in] pKey The key (0 - JOURNAL_MAX_KEYS-1)
+    * @param[out] outData Buffer for the value
+    * @param[in] pLength Length of the buffer, must be the length the value was stored with
+    * @return false if no value with this length is stored for the key
+    */
+    bool Get(uint8_t pKey, void * outData, uint16_t pLength);
+
+    bool Contains(uint8_t pKey);
+
+    // Rewrites the journal with only the last record of each key
+    bool Compact();
+
+    uint32_t GetRecordCount();
+
+    // Number of damaged bytes (e.g. a torn record) which Begin() found and removed
+    uint32_t GetDiscardedBytes();
+
+private:
+    typedef struct
+    {
+        uint8_t Magic;
+        uint8_t Key;
+        uint16_t Length;
+        uint32_t Crc;       // CRC32 of Key, Length and the value
+    }
+    RecordHeader;
+
+    typedef struct
+    {
+        bool IsValid = false;
+        uint16_t Length = 0;
+        uint8_t Data[JOURNAL_MAX_VALUE_LENGTH];
+    }
+    Entry;
+
+    static uint32_t calcCrc(uint8_t pKey, uint16_t pLength, const uint8_t * pData);
+    bool replay();
+    bool appendRecord(File * pFile, uint8_t pKey, const uint8_t * pData, uint16_t pLength);
+
+    fs::FS * fileSystem = nullptr;
+    char path[JOURNAL_PATH_LENGTH] = {'\0'};
+    char tempPath[JOURNAL_PATH_LENGTH + 4] = {'\0'};
+    size_t maxFileSize = JOURNAL_DEFAULT_MAX_FILE_SIZE;
+    size_t fileSize = 0;
+    uint32_t recordCount = 0;
+    uint32_t discardedBytes = 0;
+    Entry entries[JOURNAL_MAX_KEYS];
+};
+
+#endif  // _JOURNALEDSTATESTORE_H_
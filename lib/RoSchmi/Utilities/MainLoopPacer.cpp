@@ -0,0 +1,206 @@
+#include "MainLoopPacer.h"
+#include <esp_freertos_hooks.h>
+#if CONFIG_PM_ENABLE
+    #include <esp_pm.h>
+#endif
+
+static const uint32_t workBucketLimits[MAIN_LOOP_WORK_BUCKETS] = MAIN_LOOP_WORK_BUCKET_LIMITS;
+
+// Ticks of each core which interrupted another task than the idle task of the core
+static TaskHandle_t idleTaskHandles[MAIN_LOOP_CPU_COUNT] = {NULL};
+static volatile uint32_t busyTicks[MAIN_LOOP_CPU_COUNT] = {0};
+
+static void IRAM_ATTR countBusyTick(int pCore)
+{
+    if (xTaskGetCurrentTaskHandleForCPU(pCore) != idleTaskHandles[pCore])
+    {
+        busyTicks[pCore]++;
+    }
+}
+
+static void IRAM_ATTR tickHookCore0()
+{
+    countBusyTick(0);
+}
+
+#if MAIN_LOOP_CPU_COUNT > 1
+static void IRAM_ATTR tickHookCore1()
+{
+    countBusyTick(1);
+}
+#endif
+
+// Constructor
+MainLoopPacer::MainLoopPacer()
+{}
+
+void MainLoopPacer::Begin(uint32_t pCyclePeriodMs, bool pEnableLightSleep)
+{
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+    cyclePeriodMs = pCyclePeriodMs < 1 ? 1 : pCyclePeriodMs;
+    nextTickMs = millis();
+    lastWaitEndMs = nextTickMs;
+
+    if (idleTaskHandles[0] == NULL)
+    {
+        for (int core = 0; core < MAIN_LOOP_CPU_COUNT; core++)
+        {
+            idleTaskHandles[core] = xTaskGetIdleTaskHandleForCPU(core);
+        }
+        esp_register_freertos_tick_hook_for_cpu(tickHookCore0, 0);
+        #if MAIN_LOOP_CPU_COUNT > 1
+            esp_register_freertos_tick_hook_for_cpu(tickHookCore1, 1);
+        #endif
+    }
+    ResetStats();
+
+    #if CONFIG_PM_ENABLE
+        if (pEnableLightSleep)
+        {
+            // The CPU is clocked down while idle, with tickless idle it enters light sleep
+            // WiFi stays associated (modem sleep)
+            esp_pm_config_esp32_t pmConfig;
+            pmConfig.max_freq_mhz = 240;
+            pmConfig.min_freq_mhz = 80;
+            #if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+                pmConfig.light_sleep_enable = true;
+            #else
+                pmConfig.light_sleep_enable = false;
+            #endif
+            lightSleepIsEnabled = (esp_pm_configure(&pmConfig) == ESP_OK) && pmConfig.light_sleep_enable;
+        }
+    #endif
+}
+
+bool MainLoopPacer::WaitForNextCycle(uint32_t pMaxWaitMs)
+{
+    uint32_t startMs = millis();
+    uint32_t workMs = startMs - lastWaitEndMs;
+    stats.WorkMsMax = workMs > stats.WorkMsMax ? workMs : stats.WorkMsMax;
+    int bucket = 0;
+    while (workMs > workBucketLimits[bucket])
+    {
+        bucket++;
+    }
+    workBuckets[bucket]++;
+
+    // If the last cycle took longer than a period, the missed ticks are skipped
+    if ((int32_t)(startMs - nextTickMs) > (int32_t)cyclePeriodMs)
+    {
+        stats.OverrunCount += (startMs - nextTickMs) / cyclePeriodMs;
+        nextTickMs = startMs;
+    }
+
+    uint32_t waitMs = (int32_t)(nextTickMs - startMs) > 0 ? nextTickMs - startMs : 0;
+    bool isEarly = pMaxWaitMs < waitMs;
+    waitMs = isEarly ? pMaxWaitMs : waitMs;
+
+    bool wasWoken = false;
+    if (waitMs > 0)
+    {
+        wasWoken = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs)) > 0;
+    }
+    else
+    {
+        // Clear a notification which arrived while working
+        ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    uint32_t endMs = millis();
+    blockedMs += endMs - startMs;
+    lastWaitEndMs = endMs;
+    stats.CycleCount++;
+
+    if (wasWoken || isEarly)
+    {
+        stats.EarlyWakeCount++;
+    }
+    else
+    {
+        uint32_t jitterMs = (int32_t)(endMs - nextTickMs) > 0 ? endMs - nextTickMs : 0;
+        jitterSumMs += jitterMs;
+        jitterCount++;
+        stats.MaxJitterMs = jitterMs > stats.MaxJitterMs ? jitterMs : stats.MaxJitterMs;
+        nextTickMs += cyclePeriodMs;
+    }
+    return !wasWoken;
+}
+
+void MainLoopPacer::Wake()
+{
+    if (loopTaskHandle != NULL)
+    {
+        xTaskNotifyGive(loopTaskHandle);
+    }
+}
+
+void IRAM_ATTR MainLoopPacer::WakeFromISR()
+{
+    if (loopTaskHandle != NULL)
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(loopTaskHandle, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+MainLoopStats MainLoopPacer::GetStats()
+{
+    MainLoopStats result = stats;
+    uint32_t elapsedMs = millis() - statsStartMs;
+    result.MeanJitterMs = jitterCount > 0 ? (uint32_t)(jitterSumMs / jitterCount) : 0;
+    result.BlockedPercent = elapsedMs > 0 ? (float)blockedMs * 100.0f / elapsedMs : 0.0;
+    uint32_t elapsedTicks = pdMS_TO_TICKS(elapsedMs);
+    for (int core = 0; core < MAIN_LOOP_CPU_COUNT; core++)
+    {
+        uint32_t coreBusyTicks = busyTicks[core] - busyTicksAtStart[core];
+        coreBusyTicks = coreBusyTicks < elapsedTicks ? coreBusyTicks : elapsedTicks;
+        result.CpuIdlePercent[core] = elapsedTicks > 0 ? 100.0f - (float)coreBusyTicks * 100.0f / elapsedTicks : 0.0;
+    }
+    result.WorkMsP50 = workPercentile(50);
+    result.WorkMsP99 = workPercentile(99);
+    return result;
+}
+
+uint32_t MainLoopPacer::workPercentile(uint32_t pPercent)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < MAIN_LOOP_WORK_BUCKETS; i++)
+    {
+        count += workBuckets[i];
+    }
+    // Smallest bucket which holds at least pPercent of the cycles
+    uint64_t needed = ((uint64_t)count * pPercent + 99) / 100;
+    uint64_t sum = 0;
+    for (int i = 0; i < MAIN_LOOP_WORK_BUCKETS && count > 0; i++)
+    {
+        sum += workBuckets[i];
+        if (sum >= needed)
+        {
+            return workBucketLimits[i] < stats.WorkMsMax ? workBucketLimits[i] : stats.WorkMsMax;
+        }
+    }
+    return 0;
+}
+
+void MainLoopPacer::ResetStats()
+{
+    stats = MainLoopStats();
+    statsStartMs = millis();
+    blockedMs = 0;
+    for (int core = 0; core < MAIN_LOOP_CPU_COUNT; core++)
+    {
+        busyTicksAtStart[core] = busyTicks[core];
+    }
+    jitterSumMs = 0;
+    jitterCount = 0;
+    memset(workBuckets, 0, sizeof(workBuckets));
+}
+
+bool MainLoopPacer::LightSleepIsEnabled()
+{
+    return lightSleepIsEnabled;
+}
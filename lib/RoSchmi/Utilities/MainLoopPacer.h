@@ -0,0 +1,85 @@
+#include <Arduino.h>
+
+#ifndef _MAINLOOPPACER_H_
+#define _MAINLOOPPACER_H_
+
+#define MAIN_LOOP_DEFAULT_CYCLE_MS 1000
+#define MAIN_LOOP_WORK_BUCKETS 12
+#define MAIN_LOOP_CPU_COUNT portNUM_PROCESSORS
+
+// Upper limits (ms) of the buckets of the work times, the last bucket takes the rest
+#define MAIN_LOOP_WORK_BUCKET_LIMITS { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000, UINT32_MAX }
+
+// Statistics of the cycles since the last ResetStats()
+typedef struct
+{
+    uint32_t CycleCount = 0;
+    uint32_t EarlyWakeCount = 0;      // cycles started by Wake() or a deadline before the tick
+    uint32_t OverrunCount = 0;        // ticks which were missed because a cycle took too long
+    uint32_t MeanJitterMs = 0;        // delay of the start of a cycle behind its tick
+    uint32_t MaxJitterMs = 0;
+    float BlockedPercent = 0.0;       // part of the time the loop task was blocked in WaitForNextCycle()
+    float CpuIdlePercent[MAIN_LOOP_CPU_COUNT] = {0.0};   // part of the time the idle task of the core ran
+    uint32_t WorkMsMax = 0;           // longest time between two waits
+    uint32_t WorkMsP50 = 0;           // percentiles of the time between two waits
+    uint32_t WorkMsP99 = 0;           // (upper limit of the bucket, at most WorkMsMax)
+}
+MainLoopStats;
+
+// Replaces the busy loop: WaitForNextCycle() blocks the loop task on a FreeRTOS task
+// notification until the next tick of a fixed period (or an earlier deadline, or Wake()).
+// While the task is blocked the idle task runs, which with power management enabled
+// (CONFIG_PM_ENABLE and tickless idle) lets the Esp32 enter light sleep
+// The cycle period no longer depends on the CPU speed or the compiler optimization
+// The idle time of the cores is sampled in the tick interrupt of each core: a tick which
+// interrupts the idle task counts as idle. Ticks which are skipped in light sleep
+// (tickless idle) are idle as well, so only the busy ticks are counted
+class MainLoopPacer
+{
+public:
+    MainLoopPacer();
+
+    /**
+    * @brief Has to be called from the task which calls WaitForNextCycle() (setup())
+    *
+    * @param[in] pCyclePeriodMs The period of the cycles
+    * @param[in] pEnableLightSleep Configures automatic light sleep if the framework supports it
+    */
+    void Begin(uint32_t pCyclePeriodMs = MAIN_LOOP_DEFAULT_CYCLE_MS, bool pEnableLightSleep = false);
+
+    /**
+    * @brief Blocks until the next tick, but not longer than pMaxWaitMs
+    *
+    * @param[in] pMaxWaitMs E.g. the time until the next sensor deadline
+    * @return true at the tick or pMaxWaitMs, false when woken by Wake()
+    */
+    bool WaitForNextCycle(uint32_t pMaxWaitMs = UINT32_MAX);
+
+    // Lets WaitForNextCycle() return immediately (e.g. from a button interrupt)
+    void Wake();
+    void WakeFromISR();
+
+    MainLoopStats GetStats();
+    void ResetStats();
+
+    // True if light sleep could be enabled by Begin()
+    bool LightSleepIsEnabled();
+
+private:
+    uint32_t workPercentile(uint32_t pPercent);
+
+    TaskHandle_t loopTaskHandle = NULL;
+    uint32_t cyclePeriodMs = MAIN_LOOP_DEFAULT_CYCLE_MS;
+    uint32_t nextTickMs = 0;
+    uint32_t lastWaitEndMs = 0;
+    uint32_t statsStartMs = 0;
+    uint64_t blockedMs = 0;
+    uint32_t busyTicksAtStart[MAIN_LOOP_CPU_COUNT] = {0};
+    uint64_t jitterSumMs = 0;
+    uint32_t jitterCount = 0;
+    bool lightSleepIsEnabled = false;
+    uint32_t workBuckets[MAIN_LOOP_WORK_BUCKETS] = {0};
+    MainLoopStats stats;
+};
+
+#endif  // _MAINLOOPPACER_H_
@@ -0,0 +1,289 @@
+#include "MetricsRegistry.h"
+#include <rom/crc.h>
+#include <esp_system.h>
+
+#define METRICS_BLOCK_MAGIC 0x4D455452      // 'METR'
+
+// Not initialized at start, keeps its content over all resets except power-on
+RTC_NOINIT_ATTR static MetricsBlock rtcBlock;
+
+static const uint32_t bucketLimits[METRICS_LATENCY_BUCKETS] = METRICS_LATENCY_BUCKET_LIMITS;
+
+// Constructor
+MetricsRegistry::MetricsRegistry()
+{}
+
+int MetricsRegistry::addMetric(const char * pName, char pKind, const char * pNames[], size_t * pCount, size_t pMaxCount)
+{
+    if (isStarted || *pCount >= pMaxCount)
+    {
+        return METRICS_INVALID_ID;
+    }
+    // The layout changes when a metric is added, removed, renamed or moved
+    layout = crc32_le(layout, (const uint8_t *)&pKind, 1);
+    layout = crc32_le(layout, (const uint8_t *)pName, strlen(pName));
+    pNames[*pCount] = pName;
+    return (int)(*pCount)++;
+}
+
+int MetricsRegistry::AddCounter(const char * pName)
+{
+    return addMetric(pName, 'c', counterNames, &counterCount, METRICS_MAX_COUNTERS);
+}
+
+int MetricsRegistry::AddGauge(const char * pName)
+{
+    return addMetric(pName, 'g', gaugeNames, &gaugeCount, METRICS_MAX_GAUGES);
+}
+
+int MetricsRegistry::AddLatency(const char * pName)
+{
+    return addMetric(pName, 'l', latencyNames, &latencyCount, METRICS_MAX_LATENCIES);
+}
+
+bool MetricsRegistry::Begin(fs::FS * pFileSystem, const char * pPath)
+{
+    fileSystem = pFileSystem;
+    path = pPath;
+
+    // After power-on or brownout the content of the RTC memory is undefined
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool rtcIsValid = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && reason != ESP_RST_UNKNOWN
+                   && rtcBlock.Magic == METRICS_BLOCK_MAGIC && rtcBlock.Layout == layout;
+    bool isTaken = rtcIsValid || loadFromFile();
+    if (!isTaken)
+    {
+        clearBlock();
+    }
+    rtcBlock.BootCount++;
+    isStarted = true;
+    return isTaken;
+}
+
+bool MetricsRegistry::loadFromFile()
+{
+    if (fileSystem == nullptr || !fileSystem ->exists(path))
+    {
+        return false;
+    }
+    File file = fileSystem ->open(path, "r");
+    if (!file)
+    {
+        return false;
+    }
+    MetricsBlock fileBlock;
+    bool isValid = file.read((uint8_t *)&fileBlock, sizeof(MetricsBlock)) == sizeof(MetricsBlock)
+                && fileBlock.Magic == METRICS_BLOCK_MAGIC && fileBlock.Layout == layout
+                && fileBlock.Crc == crc32_le(0, (const uint8_t *)&fileBlock, offsetof(MetricsBlock, Crc));
+    file.close();
+    if (isValid)
+    {
+        rtcBlock = fileBlock;
+    }
+    return isValid;
+}
+
+void MetricsRegistry::clearBlock()
+{
+    memset(&rtcBlock, 0, sizeof(MetricsBlock));
+    rtcBlock.Magic = METRICS_BLOCK_MAGIC;
+    rtcBlock.Layout = layout;
+    for (int i = 0; i < METRICS_MAX_LATENCIES; i++)
+    {
+        rtcBlock.Latencies[i].MinMs = UINT32_MAX;
+    }
+}
+
+void MetricsRegistry::Clear()
+{
+    portENTER_CRITICAL(&lock);
+    uint32_t bootCount = rtcBlock.BootCount;
+    clearBlock();
+    rtcBlock.BootCount = bootCount;
+    portEXIT_CRITICAL(&lock);
+}
+
+void MetricsRegistry::Increment(int pCounterId, uint32_t pDelta)
+{
+    if (pCounterId < 0 || pCounterId >= (int)counterCount)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    rtcBlock.Counters[pCounterId] += pDelta;
+    portEXIT_CRITICAL(&lock);
+}
+
+void MetricsRegistry::SetGauge(int pGaugeId, int32_t pValue)
+{
+    if (pGaugeId < 0 || pGaugeId >= (int)gaugeCount)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&lock);
+    rtcBlock.Gauges[pGaugeId] = pValue;
+    portEXIT_CRITICAL(&lock);
+}
+
+void MetricsRegistry::RecordLatency(int pLatencyId, uint32_t pMs)
+{
+    if (pLatencyId < 0 || pLatencyId >= (int)latencyCount)
+    {
+        return;
+    }
+    int bucket = 0;
+    while (pMs > bucketLimits[bucket])
+    {
+        bucket++;
+    }
+    portENTER_CRITICAL(&lock);
+    LatencyHistogram * histogram = &rtcBlock.Latencies[pLatencyId];
+    histogram ->Count++;
+    histogram ->SumMs += pMs;
+    histogram ->MinMs = pMs < histogram ->MinMs ? pMs : histogram ->MinMs;
+    histogram ->MaxMs = pMs > histogram ->MaxMs ? pMs : histogram ->MaxMs;
+    histogram ->Buckets[bucket]++;
+    portEXIT_CRITICAL(&lock);
+}
+
+uint32_t MetricsRegistry::GetCounter(int pCounterId)
+{
+    return (pCounterId >= 0 && pCounterId < (int)counterCount) ? rtcBlock.Counters[pCounterId] : 0;
+}
+
+int32_t MetricsRegistry::GetGauge(int pGaugeId)
+{
+    return (pGaugeId >= 0 && pGaugeId < (int)gaugeCount) ? rtcBlock.Gauges[pGaugeId] : 0;
+}
+
+LatencyHistogram MetricsRegistry::GetLatency(int pLatencyId)
+{
+    LatencyHistogram result = {};
+    if (pLatencyId >= 0 && pLatencyId < (int)latencyCount)
+    {
+        portENTER_CRITICAL(&lock);
+        result = rtcBlock.Latencies[pLatencyId];
+        portEXIT_CRITICAL(&lock);
+    }
+    return result;
+}
+
+LatencyHistogram MetricsRegistry::Difference(LatencyHistogram pNow, LatencyHistogram pBefore)
+{
+    // After Clear() the values before are not part of pNow
+    if (pNow.Count < pBefore.Count)
+    {
+        return pNow;
+    }
+    LatencyHistogram result = pNow;
+    result.Count -= pBefore.Count;
+    result.SumMs -= pBefore.SumMs;
+    for (int b = 0; b < METRICS_LATENCY_BUCKETS; b++)
+    {
+        result.Buckets[b] -= pBefore.Buckets[b];
+    }
+    return result;
+}
+
+uint32_t MetricsRegistry::Percentile(LatencyHistogram pHistogram, uint32_t pPercent)
+{
+    uint64_t needed = ((uint64_t)pHistogram.Count * pPercent + 99) / 100;
+    uint64_t sum = 0;
+    for (int b = 0; b < METRICS_LATENCY_BUCKETS && pHistogram.Count > 0; b++)
+    {
+        sum += pHistogram.Buckets[b];
+        if (sum >= needed)
+        {
+            return bucketLimits[b] < pHistogram.MaxMs ? bucketLimits[b] : pHistogram.MaxMs;
+        }
+    }
+    return 0;
+}
+
+uint32_t MetricsRegistry::GetBootCount()
+{
+    return rtcBlock.BootCount;
+}
+
+bool MetricsRegistry::Flush()
+{
+    if (!isStarted || fileSystem == nullptr)
+    {
+        return false;
+    }
+    portENTER_CRITICAL(&lock);
+    MetricsBlock fileBlock = rtcBlock;
+    portEXIT_CRITICAL(&lock);
+    fileBlock.Crc = crc32_le(0, (const uint8_t *)&fileBlock, offsetof(MetricsBlock, Crc));
+
+    File file = fileSystem ->open(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    bool result = file.write((const uint8_t *)&fileBlock, sizeof(MetricsBlock)) == sizeof(MetricsBlock);
+    file.close();
+    return result;
+}
+
+void MetricsRegistry::PrintStats(Print * pPrint)
+{
+    portENTER_CRITICAL(&lock);
+    MetricsBlock snapshot = rtcBlock;
+    portEXIT_CRITICAL(&lock);
+
+    pPrint ->printf("Metrics (boot %u):", snapshot.BootCount);
+    for (size_t i = 0; i < counterCount; i++)
+    {
+        pPrint ->printf(" %s %u", counterNames[i], snapshot.Counters[i]);
+    }
+    for (size_t i = 0; i < gaugeCount; i++)
+    {
+        pPrint ->printf(" %s %d", gaugeNames[i], snapshot.Gauges[i]);
+    }
+    pPrint ->println();
+    for (size_t i = 0; i < latencyCount; i++)
+    {
+        LatencyHistogram * histogram = &snapshot.Latencies[i];
+        if (histogram ->Count == 0)
+        {
+            continue;
+        }
+        pPrint ->printf("Latency %s: %u, min %u ms, mean %u ms, max %u ms, buckets", latencyNames[i], histogram ->Count,
+            histogram ->MinMs, histogram ->SumMs / histogram ->Count, histogram ->MaxMs);
+        for (int b = 0; b < METRICS_LATENCY_BUCKETS; b++)
+        {
+            pPrint ->printf(" %u", histogram ->Buckets[b]);
+        }
+        pPrint ->println();
+    }
+}
+
+void MetricsRegistry::ExportJson(Print * pOutput)
+{
+    portENTER_CRITICAL(&lock);
+    MetricsBlock snapshot = rtcBlock;
+    portEXIT_CRITICAL(&lock);
+
+    pOutput ->printf("{\"boots\":%u", snapshot.BootCount);
+    for (size_t i = 0; i < counterCount; i++)
+    {
+        pOutput ->printf(",\"%s\":%u", counterNames[i], snapshot.Counters[i]);
+    }
+    for (size_t i = 0; i < gaugeCount; i++)
+    {
+        pOutput ->printf(",\"%s\":%d", gaugeNames[i], snapshot.Gauges[i]);
+    }
+    for (size_t i = 0; i < latencyCount; i++)
+    {
+        LatencyHistogram * histogram = &snapshot.Latencies[i];
+        pOutput ->printf(",\"%s\":{\"count\":%u,\"minMs\":%u,\"maxMs\":%u,\"sumMs\":%u,\"buckets\":[", latencyNames[i],
+            histogram ->Count, histogram ->Count > 0 ? histogram ->MinMs : 0, histogram ->MaxMs, histogram ->SumMs);
+        for (int b = 0; b < METRICS_LATENCY_BUCKETS; b++)
+        {
+            pOutput ->printf(b == 0 ? "%u" : ",%u", histogram ->Buckets[b]);
+        }
+        pOutput ->print("]}");
+    }
+    pOutput ->print('}');
+}
@@ -0,0 +1,125 @@
+#include <Arduino.h>
+#include <FS.h>
+#include <Print.h>
+
+#ifndef _METRICSREGISTRY_H_
+#define _METRICSREGISTRY_H_
+
+#define METRICS_MAX_COUNTERS 12
+#define METRICS_MAX_GAUGES 6
+#define METRICS_MAX_LATENCIES 4
+#define METRICS_LATENCY_BUCKETS 8
+#define METRICS_INVALID_ID -1
+
+// Upper limits (ms) of the buckets of a latency histogram, the last bucket takes the rest
+#define METRICS_LATENCY_BUCKET_LIMITS { 50, 100, 200, 500, 1000, 2000, 5000, UINT32_MAX }
+
+typedef struct
+{
+    uint32_t Count;
+    uint32_t MinMs;
+    uint32_t MaxMs;
+    uint32_t SumMs;
+    uint32_t Buckets[METRICS_LATENCY_BUCKETS];
+}
+LatencyHistogram;
+
+// Values of all metrics, kept in RTC memory (no member initializers, it must not be initialized at start)
+typedef struct
+{
+    uint32_t Magic;
+    uint32_t Layout;        // CRC32 of the names and kinds of the registered metrics
+    uint32_t BootCount;
+    uint32_t Counters[METRICS_MAX_COUNTERS];
+    int32_t Gauges[METRICS_MAX_GAUGES];
+    LatencyHistogram Latencies[METRICS_MAX_LATENCIES];
+    uint32_t Crc;           // only valid in the flush file
+}
+MetricsBlock;
+
+// Metrics which must survive a reset (e.g. counters of requests and errors)
+// The values are kept in RTC slow memory, which is not initialized by ESP.restart(),
+// a watchdog reset or a panic, so the history is still there after the reset
+// which shall be diagnosed. After a power-on reset (RTC memory undefined) the values
+// of the last flush to flash are taken.
+// Metrics are registered once at start, Begin() then takes the stored values if the
+// registered set (names and kinds) did not change, otherwise all values start at 0
+// There is one block in RTC memory, so an App has only one registry
+// Thread safe, the metrics can be updated from all tasks
+class MetricsRegistry
+{
+public:
+    MetricsRegistry();
+
+    /**
+    * @brief Registers a counter (only before Begin())
+    *
+    * @param[in] pName The name which is used in the stats (must outlive the registry)
+    * @return The id of the counter or METRICS_INVALID_ID
+    */
+    int AddCounter(const char * pName);
+
+    // Registers a gauge (last value), returns the id or METRICS_INVALID_ID
+    int AddGauge(const char * pName);
+
+    // Registers a latency histogram (count, min, max, mean and buckets), returns the id or METRICS_INVALID_ID
+    int AddLatency(const char * pName);
+
+    /**
+    * @brief Takes the values from RTC memory, if they are not valid from the flush file
+    *
+    * @param[in] pFileSystem The file system of the flush file (e.g. &LittleFS)
+    * @param[in] pPath The path of the flush file
+    * @return true if stored values were taken, false if all metrics start at 0
+    */
+    bool Begin(fs::FS * pFileSystem, const char * pPath);
+
+    void Increment(int pCounterId, uint32_t pDelta = 1);
+    void SetGauge(int pGaugeId, int32_t pValue);
+    void RecordLatency(int pLatencyId, uint32_t pMs);
+
+    uint32_t GetCounter(int pCounterId);
+    int32_t GetGauge(int pGaugeId);
+    LatencyHistogram GetLatency(int pLatencyId);
+
+    // Values of a histogram which were added after pBefore (e.g. of the last report interval),
+    // min and max are taken from pNow
+    static LatencyHistogram Difference(LatencyHistogram pNow, LatencyHistogram pBefore);
+
+    // Upper limit of the bucket which holds pPercent of the values (at most MaxMs), 0 if empty
+    static uint32_t Percentile(LatencyHistogram pHistogram, uint32_t pPercent);
+
+    // Number of starts since the metrics were cleared
+    uint32_t GetBootCount();
+
+    // Writes the values to the flush file, so they also survive a power loss
+    bool Flush();
+
+    // Sets all values to 0
+    void Clear();
+
+    // Prints one line with the counters and gauges and one line per latency
+    void PrintStats(Print * pPrint);
+
+    // Writes all metrics as Json object
+    void ExportJson(Print * pOutput);
+
+private:
+    int addMetric(const char * pName, char pKind, const char * pNames[], size_t * pCount, size_t pMaxCount);
+    bool loadFromFile();
+    void clearBlock();
+
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    fs::FS * fileSystem = nullptr;
+    const char * path = nullptr;
+    uint32_t layout = 0;
+    bool isStarted = false;
+    const char * counterNames[METRICS_MAX_COUNTERS];
+    const char * gaugeNames[METRICS_MAX_GAUGES];
+    const char * latencyNames[METRICS_MAX_LATENCIES];
+    size_t counterCount = 0;
+    size_t gaugeCount = 0;
+    size_t latencyCount = 0;
+};
+
+#endif  // _METRICSREGISTRY_H_
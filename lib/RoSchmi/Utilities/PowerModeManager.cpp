@@ -0,0 +1,133 @@
+#include "PowerModeManager.h"
+#include <WiFi.h>
+
+// Constructor
+PowerModeManager::PowerModeManager()
+{}
+
+void PowerModeManager::Begin(bool pLowPower, uint32_t pBatchSeconds)
+{
+    if (radioMutex == NULL)
+    {
+        radioMutex = xSemaphoreCreateMutex();
+    }
+    isLowPower = pLowPower;
+    batchMs = pBatchSeconds * 1000;
+    lastBurstMs = millis();
+    ResetStats();
+    if (isLowPower)
+    {
+        setRadioSleep(true);
+    }
+}
+
+bool PowerModeManager::UploadIsAllowed(bool pUrgent)
+{
+    if (!isLowPower || pUrgent || (millis() - lastBurstMs >= batchMs))
+    {
+        return true;
+    }
+    stats.HeldCount++;
+    return false;
+}
+
+void PowerModeManager::BeginUploads()
+{
+    if (burstIsActive)
+    {
+        return;
+    }
+    burstIsActive = true;
+    burstStartMs = millis();
+    BeginRadioActivity();
+}
+
+void PowerModeManager::EndUploads()
+{
+    if (!burstIsActive)
+    {
+        return;
+    }
+    burstIsActive = false;
+    uint32_t now = millis();
+    uint32_t durationMs = now - burstStartMs;
+    lastBurstMs = now;
+    EndRadioActivity();
+    stats.BurstCount++;
+    wakeToDataSumMs += durationMs;
+    stats.MaxWakeToDataMs = durationMs > stats.MaxWakeToDataMs ? durationMs : stats.MaxWakeToDataMs;
+}
+
+void PowerModeManager::BeginRadioActivity()
+{
+    if (radioMutex == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(radioMutex, portMAX_DELAY);
+    // The time is counted once, also when the requests of both tasks overlap
+    if (radioActivityCount++ == 0)
+    {
+        radioWakeMs = millis();
+        if (isLowPower)
+        {
+            setRadioSleep(false);
+        }
+    }
+    xSemaphoreGive(radioMutex);
+}
+
+void PowerModeManager::EndRadioActivity()
+{
+    if (radioMutex == NULL)
+    {
+        return;
+    }
+    xSemaphoreTake(radioMutex, portMAX_DELAY);
+    if (radioActivityCount > 0 && --radioActivityCount == 0)
+    {
+        if (isLowPower)
+        {
+            setRadioSleep(true);
+        }
+        radioActiveMs += millis() - radioWakeMs;
+    }
+    xSemaphoreGive(radioMutex);
+}
+
+bool PowerModeManager::IsLowPower()
+{
+    return isLowPower;
+}
+
+PowerModeStats PowerModeManager::GetStats()
+{
+    PowerModeStats result = stats;
+    uint32_t elapsedMs = millis() - statsStartMs;
+    result.MeanWakeToDataMs = stats.BurstCount > 0 ? (uint32_t)(wakeToDataSumMs / stats.BurstCount) : 0;
+    // In the normal mode the radio is not managed and counts as always on
+    result.RadioDutyPercent = !isLowPower ? 100.0 : (elapsedMs > 0 ? (float)radioActiveMs * 100.0f / elapsedMs : 0.0);
+    return result;
+}
+
+void PowerModeManager::ResetStats()
+{
+    stats = PowerModeStats();
+    statsStartMs = millis();
+    wakeToDataSumMs = 0;
+    if (radioMutex != NULL)
+    {
+        xSemaphoreTake(radioMutex, portMAX_DELAY);
+        // A running request is counted from now on
+        radioWakeMs = statsStartMs;
+        radioActiveMs = 0;
+        xSemaphoreGive(radioMutex);
+    }
+}
+
+void PowerModeManager::setRadioSleep(bool pSleep)
+{
+    // WIFI_PS_MAX_MODEM: the radio sleeps for the listen interval (several beacons),
+    // the connection to the access point is kept
+    WiFi.setSleep(pSleep ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE);
+}
@@ -0,0 +1,83 @@
+#include <Arduino.h>
+
+#ifndef _POWERMODEMANAGER_H_
+#define _POWERMODEMANAGER_H_
+
+typedef struct
+{
+    uint32_t BurstCount = 0;            // upload bursts since the last ResetStats()
+    uint32_t HeldCount = 0;             // cycles with due uploads which waited for the next burst
+    float RadioDutyPercent = 0.0;       // part of the time the radio was fully on (bursts and polls)
+    uint32_t MeanWakeToDataMs = 0;      // time from the begin of a burst until the data are in the cloud
+    uint32_t MaxWakeToDataMs = 0;
+}
+PowerModeStats;
+
+// Low power operation between the polls:
+// WiFi stays in modem sleep (the radio only wakes for the DTIM beacons) and uploads are
+// collected, so the radio is fully on only during one short burst per batch interval,
+// which amortizes the cost of the wakeup and the TLS connections.
+// The polls of the acquisition task wake the radio as well, so every HTTP request is
+// wrapped in BeginRadioActivity() / EndRadioActivity() and the radio sleeps again when
+// the last request of both tasks has finished.
+// The CPU sleeps through MainLoopPacer (light sleep). In the normal mode every due upload
+// is allowed and the radio is never put to sleep, but the stats are collected anyway,
+// so both modes can be compared
+class PowerModeManager
+{
+public:
+    PowerModeManager();
+
+    /**
+    * @brief Selects the mode, has to be called after WiFi is connected
+    *
+    * @param[in] pLowPower true for modem sleep and batched uploads
+    * @param[in] pBatchSeconds Min time between two upload bursts (low power mode)
+    */
+    void Begin(bool pLowPower, uint32_t pBatchSeconds);
+
+    /**
+    * @brief Returns true if due uploads can be sent now
+    *
+    * @param[in] pUrgent Uploads which must not wait (e.g. end of the day, buffer nearly full)
+    */
+    bool UploadIsAllowed(bool pUrgent);
+
+    // Wakes the radio for an upload burst
+    void BeginUploads();
+
+    // Ends the upload burst and puts the radio back to modem sleep
+    void EndUploads();
+
+    /**
+    * @brief Wakes the radio for a request (can be called by all tasks, calls can be nested)
+    */
+    void BeginRadioActivity();
+
+    /**
+    * @brief Ends a request, the radio goes back to modem sleep after the last one
+    */
+    void EndRadioActivity();
+
+    bool IsLowPower();
+    PowerModeStats GetStats();
+    void ResetStats();
+
+private:
+    void setRadioSleep(bool pSleep);
+
+    bool isLowPower = false;
+    bool burstIsActive = false;
+    uint32_t batchMs = 0;
+    uint32_t lastBurstMs = 0;
+    uint32_t burstStartMs = 0;
+    uint32_t statsStartMs = 0;
+    SemaphoreHandle_t radioMutex = NULL;
+    uint32_t radioActivityCount = 0;    // requests which are running now
+    uint32_t radioWakeMs = 0;
+    uint64_t radioActiveMs = 0;
+    uint64_t wakeToDataSumMs = 0;
+    PowerModeStats stats;
+};
+
+#endif  // _POWERMODEMANAGER_H_
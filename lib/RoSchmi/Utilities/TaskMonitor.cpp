@@ -0,0 +1,148 @@
+#include "TaskMonitor.h"
+
+// Constructor
+TaskMonitor::TaskMonitor()
+{}
+
+int TaskMonitor::RegisterTask(const char * pName, TaskHandle_t pHandle, BaseType_t pCore)
+{
+    if (taskCount >= TASK_MONITOR_MAX_TASKS || pHandle == NULL)
+    {
+        return TASK_MONITOR_INVALID_ID;
+    }
+    int id = taskCount++;
+    tasks[id] = TaskStats();
+    tasks[id].Name = pName;
+    tasks[id].Handle = pHandle;
+    tasks[id].Core = pCore;
+    return id;
+}
+
+int TaskMonitor::CreateQueue(const char * pName, uint32_t pLength, uint32_t pItemSize)
+{
+    if (queueCount >= TASK_MONITOR_MAX_QUEUES)
+    {
+        return TASK_MONITOR_INVALID_ID;
+    }
+    QueueHandle_t handle = xQueueCreate(pLength, pItemSize);
+    if (handle == NULL)
+    {
+        return TASK_MONITOR_INVALID_ID;
+    }
+    int id = queueCount++;
+    queues[id] = QueueStats();
+    queues[id].Name = pName;
+    queues[id].Handle = handle;
+    queues[id].Length = pLength;
+    return id;
+}
+
+void TaskMonitor::BeginWork(int pTaskId)
+{
+    if (pTaskId >= 0 && pTaskId < (int)taskCount)
+    {
+        workStartUs[pTaskId] = micros();
+    }
+}
+
+void TaskMonitor::EndWork(int pTaskId)
+{
+    if (pTaskId < 0 || pTaskId >= (int)taskCount)
+    {
+        return;
+    }
+    uint32_t runTimeUs = micros() - workStartUs[pTaskId];
+    tasks[pTaskId].WorkCount++;
+    tasks[pTaskId].RunTimeUs += runTimeUs;
+    tasks[pTaskId].MaxRunTimeUs = runTimeUs > tasks[pTaskId].MaxRunTimeUs ? runTimeUs : tasks[pTaskId].MaxRunTimeUs;
+}
+
+bool TaskMonitor::Send(int pQueueId, const void * pItem)
+{
+    if (pQueueId < 0 || pQueueId >= (int)queueCount)
+    {
+        return false;
+    }
+    QueueStats * queue = &queues[pQueueId];
+    if (xQueueSend(queue ->Handle, pItem, 0) != pdTRUE)
+    {
+        queue ->DroppedCount++;
+        return false;
+    }
+    queue ->SentCount++;
+    uint32_t waiting = uxQueueMessagesWaiting(queue ->Handle);
+    queue ->HighWaterMark = waiting > queue ->HighWaterMark ? waiting : queue ->HighWaterMark;
+    return true;
+}
+
+bool TaskMonitor::Receive(int pQueueId, void * outItem, TickType_t pTimeout)
+{
+    if (pQueueId < 0 || pQueueId >= (int)queueCount)
+    {
+        return false;
+    }
+    return xQueueReceive(queues[pQueueId].Handle, outItem, pTimeout) == pdTRUE;
+}
+
+void TaskMonitor::AddQueueWait(int pTaskId, uint32_t pWaitUs)
+{
+    if (pTaskId < 0 || pTaskId >= (int)taskCount)
+    {
+        return;
+    }
+    tasks[pTaskId].QueueWaitCount++;
+    tasks[pTaskId].QueueWaitUs += pWaitUs;
+    tasks[pTaskId].MaxQueueWaitUs = pWaitUs > tasks[pTaskId].MaxQueueWaitUs ? pWaitUs : tasks[pTaskId].MaxQueueWaitUs;
+}
+
+size_t TaskMonitor::GetTaskCount()
+{
+    return taskCount;
+}
+
+size_t TaskMonitor::GetQueueCount()
+{
+    return queueCount;
+}
+
+TaskStats TaskMonitor::GetTaskStats(int pTaskId)
+{
+    if (pTaskId < 0 || pTaskId >= (int)taskCount)
+    {
+        return TaskStats();
+    }
+    TaskStats stats = tasks[pTaskId];
+    // On the Esp32 the high water mark is in bytes
+    stats.StackHighWaterMark = uxTaskGetStackHighWaterMark(stats.Handle);
+    return stats;
+}
+
+QueueStats TaskMonitor::GetQueueStats(int pQueueId)
+{
+    if (pQueueId < 0 || pQueueId >= (int)queueCount)
+    {
+        return QueueStats();
+    }
+    QueueStats stats = queues[pQueueId];
+    stats.WaitingCount = uxQueueMessagesWaiting(stats.Handle);
+    return stats;
+}
+
+void TaskMonitor::PrintStats(Print * pPrint)
+{
+    for (size_t i = 0; i < taskCount; i++)
+    {
+        TaskStats stats = GetTaskStats(i);
+        pPrint ->printf("Task %-10s core %d: runs %u, run time mean %u us max %u us, free stack %u, queue wait mean %u us max %u us\n",
+            stats.Name, (int)stats.Core, stats.WorkCount,
+            stats.WorkCount > 0 ? (uint32_t)(stats.RunTimeUs / stats.WorkCount) : 0, stats.MaxRunTimeUs,
+            stats.StackHighWaterMark,
+            stats.QueueWaitCount > 0 ? (uint32_t)(stats.QueueWaitUs / stats.QueueWaitCount) : 0, stats.MaxQueueWaitUs);
+    }
+    for (size_t i = 0; i < queueCount; i++)
+    {
+        QueueStats stats = GetQueueStats(i);
+        pPrint ->printf("Queue %-10s: %u/%u waiting, max %u, sent %u, dropped %u\n",
+            stats.Name, stats.WaitingCount, stats.Length, stats.HighWaterMark, stats.SentCount, stats.DroppedCount);
+    }
+}
@@ -0,0 +1,100 @@
+#include <Arduino.h>
+
+#ifndef _TASKMONITOR_H_
+#define _TASKMONITOR_H_
+
+#define TASK_MONITOR_MAX_TASKS 6
+#define TASK_MONITOR_MAX_QUEUES 6
+#define TASK_MONITOR_INVALID_ID -1
+
+typedef struct
+{
+    const char * Name = "";
+    TaskHandle_t Handle = NULL;
+    BaseType_t Core = 0;
+    uint32_t WorkCount = 0;             // number of BeginWork/EndWork pairs
+    uint64_t RunTimeUs = 0;             // summed time between BeginWork and EndWork
+    uint32_t MaxRunTimeUs = 0;
+    uint32_t StackHighWaterMark = 0;    // minimal free stack since start (bytes)
+    uint32_t QueueWaitCount = 0;
+    uint64_t QueueWaitUs = 0;           // summed time the received items waited in a queue
+    uint32_t MaxQueueWaitUs = 0;
+}
+TaskStats;
+
+typedef struct
+{
+    const char * Name = "";
+    QueueHandle_t Handle = NULL;
+    uint32_t Length = 0;
+    uint32_t SentCount = 0;
+    uint32_t DroppedCount = 0;          // items which were not accepted because the queue was full
+    uint32_t HighWaterMark = 0;         // max number of waiting items
+    uint32_t WaitingCount = 0;
+}
+QueueStats;
+
+// Collects the metrics of the tasks and queues of the App in one place
+// Each task marks its work with BeginWork()/EndWork() and reports how long received
+// items waited in a queue. The counters are written only by the task which owns them,
+// readers get a snapshot which may be a few microseconds old
+class TaskMonitor
+{
+public:
+    TaskMonitor();
+
+    /**
+    * @brief Registers a task
+    *
+    * @param[in] pName The name which is used in the stats (must outlive the monitor)
+    * @param[in] pHandle The handle of the task
+    * @param[in] pCore The core the task is pinned to
+    * @return The id of the task or TASK_MONITOR_INVALID_ID
+    */
+    int RegisterTask(const char * pName, TaskHandle_t pHandle, BaseType_t pCore);
+
+    /**
+    * @brief Creates a bounded queue and registers it
+    *
+    * @param[in] pName The name which is used in the stats
+    * @param[in] pLength Max number of items
+    * @param[in] pItemSize Size of one item
+    * @return The id of the queue or TASK_MONITOR_INVALID_ID
+    */
+    int CreateQueue(const char * pName, uint32_t pLength, uint32_t pItemSize);
+
+    void BeginWork(int pTaskId);
+    void EndWork(int pTaskId);
+
+    // Sends without blocking, a full queue counts as dropped item
+    bool Send(int pQueueId, const void * pItem);
+
+    /**
+    * @brief Receives an item
+    *
+    * @param[in] pQueueId The id of the queue
+    * @param[out] outItem Buffer for the item
+    * @param[in] pTimeout Max ticks to wait
+    */
+    bool Receive(int pQueueId, void * outItem, TickType_t pTimeout = 0);
+
+    // Adds the time an item waited between Send and Receive
+    void AddQueueWait(int pTaskId, uint32_t pWaitUs);
+
+    size_t GetTaskCount();
+    size_t GetQueueCount();
+    TaskStats GetTaskStats(int pTaskId);
+    QueueStats GetQueueStats(int pQueueId);
+
+    // Prints one line per task and per queue
+    void PrintStats(Print * pPrint);
+
+private:
+    TaskStats tasks[TASK_MONITOR_MAX_TASKS];
+    QueueStats queues[TASK_MONITOR_MAX_QUEUES];
+    uint32_t workStartUs[TASK_MONITOR_MAX_TASKS] = {0};
+    size_t taskCount = 0;
+    size_t queueCount = 0;
+};
+
+#endif  // _TASKMONITOR_H_
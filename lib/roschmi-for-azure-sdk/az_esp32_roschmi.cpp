@@ -93,7 +93,7 @@ az_http_client_send_request(az_http_request const* request, az_http_response* re
     slashIndex = (slashIndex != -1) ? slashIndex + colonIndex + 3 : -1;       
   }
     
-  char workBuffer[100] {0};
+  char workBuffer[MAX_RESOURCE_LENGTH] {0};
     
   if (slashIndex == -1)
   {
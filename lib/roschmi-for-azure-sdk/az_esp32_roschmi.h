@@ -17,6 +17,7 @@
 
 #define MAX_HEADERNAME_LENGTH 30
 #define MAX_HEADERVALUE_LENGTH 120
+#define MAX_RESOURCE_LENGTH 300     // path and query of the url (with SAS token)
 
 void setHttpClient(HTTPClient * httpClient);
 void setCaCert(const char * caCert);
@@ -37,7 +37,8 @@
 
 #include <azure/core/_az_cfg_prefix.h>
 
-#define ROSCHMI_AZ_HTTP_REQUEST_URL_BUFFER_SIZE 100
+// RoSchmi: 300 leaves room for a SAS token in the query of the url
+#define ROSCHMI_AZ_HTTP_REQUEST_URL_BUFFER_SIZE 300
 
 
 /**
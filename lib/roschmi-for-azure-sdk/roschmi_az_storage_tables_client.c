@@ -213,15 +213,12 @@ AZ_NODISCARD az_result az_storage_tables_upload(
   // create request buffer TODO: define size for a blob upload
   
 
-  uint8_t url_buffer[ROSCHMI_AZ_HTTP_REQUEST_URL_BUFFER_SIZE];
-  az_span request_url_span = AZ_SPAN_FROM_BUFFER(url_buffer);
   // copy url from client
   int32_t uri_size = az_span_size(ref_client->_internal.endpoint);
-  _az_RETURN_IF_NOT_ENOUGH_SIZE(request_url_span, uri_size);
   //az_span_copy(request_url_span, ref_client->_internal.endpoint);
   
-  // RoSchmi
-  request_url_span = az_span_slice(ref_client->_internal.endpoint, 0, uri_size);
+  // RoSchmi: the url is used in place, the size was already checked by az_storage_tables_client_init()
+  az_span request_url_span = az_span_slice(ref_client->_internal.endpoint, 0, uri_size);
   
   uint8_t headers_buffer[_az_STORAGE_HTTP_REQUEST_HEADER_BUFFER_SIZE] = {0};
   
@@ -244,11 +241,18 @@ AZ_NODISCARD az_result az_storage_tables_upload(
 _az_RETURN_IF_FAILED(az_http_request_append_header(
       &request, AZ_STORAGE_TABLES_HEADER_XMS_DATE, timestamp));
 
-_az_RETURN_IF_FAILED(az_http_request_append_header(
+// RoSchmi: with SAS authentication the request is not signed, then both headers are empty
+if (az_span_size(authorizationHeader) > 0)
+{
+  _az_RETURN_IF_FAILED(az_http_request_append_header(
       &request, AZ_STORAGE_TABLES_HEADER_AUTHORIZATION, authorizationHeader));
+}
 
-_az_RETURN_IF_FAILED(az_http_request_append_header(
+if (az_span_size(contentMd5) > 0)
+{
+  _az_RETURN_IF_FAILED(az_http_request_append_header(
       &request, AZ_STORAGE_TABLES_HEADER_CONTENT_MD5, contentMd5));
+}
 
 _az_RETURN_IF_FAILED(az_http_request_append_header(
       &request, AZ_STORAGE_TABLES_HEADER_PREFERE, options->_internal.perferType));
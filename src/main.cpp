@@ -76,6 +76,9 @@
 // through the App "Ai-On-The-Edge-Device" on the Esp32-Cam. The digitized data from the
 // Esp32-Cam are retrieved from there via the REST-Api to be processed by this aplication
 // and stored on Azure Storage Tables.
+// A second AiOnTheEdge device (e.g. on a watermeter) can be read in the same way
+// (see USE_WATERMETER in config.h). Each meter has its own 'MeterPipeline' with
+// account, read schedule, persisted day base value, datacontainer and table.
 
 // For this Esp App Router-WiFi Credentials, Azure Credentials and Viessmann Credentials
 // can be entered via a Captive Portal page which is provided for one minute
@@ -132,6 +135,7 @@
 #include "TableEntityProperty.h"
 #include "TableEntity.h"
 #include "AnalogTableEntity.h"
+#include "AnalogEntityBuilder.h"
 #include "OnOffTableEntity.h"
 
 #include "ViessmannApiAccount.h"
@@ -141,6 +145,14 @@
 #include "RestApiAccount.h"
 #include "AiOnTheEdgeClient.h"
 #include "AiOnTheEdgeApiSelection.h"
+#include "MeterPipeline.h"
+#include "JournaledStateStore.h"
+#include "MainLoopPacer.h"
+#include "TaskMonitor.h"
+#include "PowerModeManager.h"
+#include "ClockDiscipline.h"
+#include "FlashRingLog.h"
+#include "MetricsRegistry.h"
 
 #include "NTPClient_Generic.h"
 #include "Timezone_Generic.h"
@@ -154,7 +166,10 @@
 #include "SoundSwitcher.h"
 #include "ImuManagerWio.h"
 #include "AnalogSensorMgr.h"
+#include "SensorScheduler.h"
+#include "AnalogRollup.h"
 #include "OnOffSensor.h"
+#include "OnOffCycleReconciler.h"
 
 #include "azure/core/az_platform.h"
 #include "azure/core/az_http.h"
@@ -184,9 +199,17 @@ SET_LOOP_TASK_STACK_SIZE ( 16*1024 ); // 16KB
 //const uint16_t bufferStoreLength = 20000;
 const uint16_t bufferStoreLength = 10000; // Test 06.04.2025)
 
+static_assert(bufferStoreLength >= TABLE_CLIENT_BUFFER_STORE_LENGTH, "bufferStore is too small for the buffers of TableClient");
+
 uint8_t bufferStore[bufferStoreLength] {0};
 uint8_t * bufferStorePtr = &bufferStore[0];
 
+// The acquisition task (requests to the Viessmann Cloud)
+// has its own buffer and HTTPClient, so a read never has to wait for an upload to Azure
+const uint16_t acquisitionBufferLength = 10000;
+uint8_t acquisitionBuffer[acquisitionBufferLength] {0};
+uint8_t * acquisitionBufferPtr = &acquisitionBuffer[0];
+
 char viessmannClientId[50] = VIESSMANN_CLIENT_ID;
 //char viessmannAccessToken[1120] = VIESSMANN_ACCESS_TOKEN;
 char viessmannAccessToken[1200] = VIESSMANN_ACCESS_TOKEN;
@@ -199,6 +222,9 @@ char viessmannTokenBaseUri[60] = VIESSMANN_TOKEN_BASE_URI;
 char gasmeterBaseValueOffsetStr[10] = GASMETER_AI_API_BASEVALUE_OFFSET;
 uint32_t gasmeterBaseValueOffsetInt =  strtoul(GASMETER_AI_API_BASEVALUE_OFFSET, NULL, 10);
 
+char watermeterBaseValueOffsetStr[10] = WATERMETER_AI_API_BASEVALUE_OFFSET;
+uint32_t watermeterBaseValueOffsetInt =  strtoul(WATERMETER_AI_API_BASEVALUE_OFFSET, NULL, 10);
+
 DateTime AccessTokenRefreshTime = DateTime();
 TimeSpan AccessTokenRefreshInterval = TimeSpan(VIESSMANN_TOKEN_REFRESH_INTERVAL_SECONDS);
 
@@ -211,6 +237,8 @@ ViessmannApiSelection * viessmannApiSelectionPtr_01 = &viessmannApiSelection_01;
 AiOnTheEdgeApiSelection gasmeterApiSelection("Gasmeter", 0, (int32_t)GASMETER_AI_API_READ_INTERVAL_SECONDS, gasmeterBaseValueOffsetInt);
 AiOnTheEdgeApiSelection * gasmeterApiSelectionPtr = &gasmeterApiSelection;
 
+AiOnTheEdgeApiSelection watermeterApiSelection("Watermeter", 0, (int32_t)WATERMETER_AI_API_READ_INTERVAL_SECONDS, watermeterBaseValueOffsetInt);
+
 bool viessmannUserId_is_read = false;
 const uint16_t viessmannUserBufLen = 1000;
 uint8_t viessmannApiUser [viessmannUserBufLen] {0};
@@ -228,17 +256,15 @@ char Gateways_0_Devices_0_Id[equipBufLen] = {0};
 
 //Feature features[VI_FEATURES_COUNT];
 
-#define AI_FEATURES_COUNT 6
-AiOnTheEdgeApiSelection::Feature ai_features[AI_FEATURES_COUNT];
-
-bool isFirstGasmeterRead = true;
-
 #define IS_ACTIVE true
 OnOffSensor OnOffBurnerStatus(IS_ACTIVE, false, true, true, DateTime());
 OnOffSensor OnOffCirculationPumpStatus(IS_ACTIVE, false, true, true, DateTime());
 OnOffSensor OnOffDhwCircualtionPumpStatus(IS_ACTIVE); // Dhw = domestic hot water
 OnOffSensor OnOffDhwPrimaryPumpStatus(IS_ACTIVE);     // Dhw = domestic hot water
 
+// Concludes burner cycles between two polls from the 'starts' counter
+OnOffCycleReconciler burnerCycleReconciler(ON_OFF_MAX_INFERRED_CYCLES);
+
 //void * StackPtrAtStart;
 //void * StackPtrEnd;
 UBaseType_t * StackPtrAtStart;
@@ -260,6 +286,7 @@ uint8_t lastResetCause = 0;
 bool buttonPressed = false;
 
 const char analogTableName[45] = ANALOG_TABLENAME;
+const char watermeterAnalogTableName[45] = WATERMETER_ANALOG_TABLENAME;
 const char viessmAnalogTableName_01[45] = VIESSMANN_ANALOG_TABLENAME_01;
 
 const char OnOffTableName_1[45] = ON_OFF_TABLENAME_01;
@@ -273,6 +300,9 @@ const char * analogTablePartPrefix = (char *)ANALOG_TABLE_PART_PREFIX;
 // The PartitionKey for the On/Off-tables may have a prefix to be distinguished, here: "Y3_" 
 const char * onOffTablePartPrefix = (char *)ON_OFF_TABLE_PART_PREFIX;
 
+const char healthTableName[45] = HEALTH_TABLENAME;
+const char * healthTablePartPrefix = (char *)HEALTH_TABLE_PART_PREFIX;
+
 // The PartitinKey can be augmented with a string representing year and month (recommended)
 const bool augmentPartitionKey = true;
 
@@ -310,7 +340,8 @@ X509Certificate myX509Certificate = digicert_globalroot_g2_ca;
 // the static client is created one time and stays forever
 static WiFiClientSecure secure_wifi_client;
 
-// plain_wifi_client is used for AiOnTheEdge http requests
+// plain_wifi_client is used for Viessmann Api http requests
+// (the AiOnTheEdge devices are read with the clients of their MeterReader)
 // the static client is created one time and stays forever
 static WiFiClient plain_wifi_client;
 
@@ -324,22 +355,97 @@ static WiFiClient plain_wifi_client;
   // Ptr to HTTPClient
   static HTTPClient * httpPtr = &http;
 
+  // HTTPClient of the acquisition task
+  HTTPClient acquisitionHttp;
+  static HTTPClient * acquisitionHttpPtr = &acquisitionHttp;
+
 // Define Datacontainer with SendInterval and InvalidateInterval as defined in config.h
 int sendIntervalSeconds_Vi = (SENDINTERVAL_MINUTES_VI * 60) < 1 ? 1 : (SENDINTERVAL_MINUTES_VI * 60);
 int sendIntervalSeconds_Ai = (SENDINTERVAL_MINUTES_AI * 60) < 1 ? 1 : (SENDINTERVAL_MINUTES_AI * 60);
 
 DataContainerWio dataContainer(TimeSpan(sendIntervalSeconds_Ai), TimeSpan(0, 0, INVALIDATEINTERVAL_MINUTES % 60, 0), (float)MIN_DATAVALUE_AI, (float)MAX_DATAVALUE_AI, (float)MAGIC_NUMBER_INVALID);
 
+DataContainerWio dataContainerWatermeter(TimeSpan(sendIntervalSeconds_Ai), TimeSpan(0, 0, INVALIDATEINTERVAL_MINUTES % 60, 0), (float)MIN_DATAVALUE_AI, (float)MAX_DATAVALUE_AI, (float)MAGIC_NUMBER_INVALID);
+
 DataContainerWio dataContainerAnalogViessmann01(TimeSpan(sendIntervalSeconds_Vi), TimeSpan(0, 0, INVALIDATEINTERVAL_MINUTES % 60, 0), (float)MIN_DATAVALUE_VI, (float)MAX_DATAVALUE_VI, (float)MAGIC_NUMBER_INVALID);
 
+// Hourly and daily min/max/mean of the Viessmann analog values (...Hours and ...Days tables)
+AnalogRollup analogRollupViessmann01((float)MAGIC_NUMBER_INVALID);
+static_assert(AnalogRollup::ChannelCount == DataContainerWio::ChannelCount, "The rollups take the channels of the containers");
+
 AnalogSensorMgr analogSensorMgr_Ai_01(MAGIC_NUMBER_INVALID);
 
+AnalogSensorMgr analogSensorMgr_Ai_02(MAGIC_NUMBER_INVALID);
+
 AnalogSensorMgr analogSensorMgr_Vi_01(MAGIC_NUMBER_INVALID);
 
+// Knows the next read time of the sensors of all sensor managers
+SensorScheduler sensorScheduler;
+
 OnOffDataContainerWio onOffDataContainer;
  
 OnOffSwitcherWio onOffSwitcherWio;
 
+// Rows of one batch of On/Off events, located in .bss since they are too large for the stack of loop()
+#if ON_OFF_SEND_DUTY_CYCLE_STATS == 1
+  #define ON_OFF_PROPERTY_COUNT (5 + 6 + 1)
+#else
+  #define ON_OFF_PROPERTY_COUNT (5 + 1)
+#endif
+typedef struct
+{
+  EntityProperty Properties[ON_OFF_PROPERTY_COUNT];
+  char SampleTime[25];
+  char PartitionKey[25];
+  char RowKey[25];
+}
+OnOffBatchRow;
+
+OnOffBatchRow onOffBatchRows[MAX_BATCH_ENTITY_COUNT];
+
+// Health row: SampleTime, T_1 ... T_4 (like an analog table) and the extra columns
+#define HEALTH_EXTRA_PROPERTY_COUNT 13
+static_assert(HEALTH_BATCH_ROWS >= 1 && HEALTH_BATCH_ROWS <= MAX_BATCH_ENTITY_COUNT, "HEALTH_BATCH_ROWS must be 1 - MAX_BATCH_ENTITY_COUNT");
+typedef struct
+{
+  EntityProperty Properties[1 + 4 + HEALTH_EXTRA_PROPERTY_COUNT];   // Properties[0] is the SampleTime
+  size_t PropertyCount;
+  DateTime LocalTime;
+  char PartitionKey[25];
+  char RowKey[25];
+}
+HealthBatchRow;
+
+HealthBatchRow healthBatchRows[MAX_BATCH_ENTITY_COUNT];
+size_t healthRowCount = 0;
+int healthTableYear = 0;
+
+// Analog rows are taken from the containers when they are due and held until the next upload
+// (in low power mode the next burst), so no row of the send interval is lost while the upload waits
+// Viessmann rows: SampleTime, T_1 ... T_4 and the interval stats, meter and ...Days rows: SampleTime, T_1 ... T_4
+#if ANALOG_SENSORS_SEND_INTERVAL_STATS == 1
+  #define VI_ANALOG_PROPERTY_COUNT (1 + 4 + 3 * 4)
+#else
+  #define VI_ANALOG_PROPERTY_COUNT (1 + 4)
+#endif
+template<size_t P>
+struct AnalogRowBuffer
+{
+  struct
+  {
+    EntityProperty Properties[P];   // Properties[0] is the SampleTime
+    size_t PropertyCount;
+    DateTime LocalTime;             // the year of the table
+    char PartitionKey[25];
+    char RowKey[25];
+  }
+  Rows[MAX_BATCH_ENTITY_COUNT];
+  size_t Count = 0;
+  int TableYear = 0;
+};
+
+AnalogRowBuffer<VI_ANALOG_PROPERTY_COUNT> viAnalogRows;
+
 // Possible configuration for Adafruit Huzzah Esp32
 static const i2s_pin_config_t pin_config_Adafruit_Huzzah_Esp32 = {
     .bck_io_num = 14,                   // BCKL
@@ -368,15 +474,68 @@ FeedResponse feedResult;
 int soundSwitcherUpdateInterval = SOUNDSWITCHER_UPDATEINTERVAL;
 uint32_t soundSwitcherReadDelayTime = SOUNDSWITCHER_READ_DELAYTIME;
 
-float LastGasmeterReading = 0.0f;
-float LastGasmeterDayConsumption = 0.0f;
+// Paces loop() with a fixed cycle period, the task sleeps between the cycles
+MainLoopPacer loopPacer;
+
+// Modem sleep and batched uploads (LOW_POWER_MODE 1), measures the radio duty cycle in both modes
+PowerModeManager powerModeManager;
+
+// System time: runs on the esp_timer, corrected for the drift of the crystal,
+// NTP and the Date headers of the Azure responses are the references
+ClockDiscipline clockDiscipline;
+
+// Pipeline of tasks: the acquisition task reads the Viessmann Cloud, every active meter is read by
+// its own task (meterTask()), each read posts an event, loop() processes the values (containers,
+// rollups) and uploads them. Requests to a meter which come from loop() are sent as commands to its task
+// The values travel in the events, so loop() never touches the features which the task writes
+#define VI_ON_OFF_STATE_COUNT 4     // burner, circulation pump, dhw circulation pump, dhw primary pump
+#define VI_ANALOG_VALUE_COUNT 4     // the 4 analog values of the Viessmann table
+
+// Features of the analog values T_1 ... T_4 of the Viessmann table (the first value of each feature)
+const char * viAnalogFeatureNames[VI_ANALOG_VALUE_COUNT] = { "heating.sensors.temperature.outside",              // Aussen
+                                                             "heating.circuits.0.sensors.temperature.supply",    // Vorlauf
+                                                             "heating.dhw.sensors.temperature.dhwCylinder",      // Warmwasser
+                                                             "heating.burners.0.modulation" };                   // Modulation
+// The newest analog values of the Viessmann Cloud, taken out of the events by loop()
+char viAnalogValues[VI_ANALOG_VALUE_COUNT][VI_FEATUREVALUELENGTH] = {{'\0'}};
+
+enum class AcquisitionKind : uint8_t
+{
+  Features,                   // the features of the source were read
+  PreValue                    // the pre value of the meter was set (answer to an AcquisitionCommand)
+};
 
-uint32_t GasmeterReadCounter = 0; //only for debugging, should be deleted in future
+typedef struct
+{
+  uint8_t Source;             // 0 = Viessmann, 1 + m = meter pipeline m
+  AcquisitionKind Kind;
+  t_httpCode HttpCode;
+  uint32_t PostedMicros;
+  // Copied from the Viessmann features by the acquisition task, so loop() needs no access to vi_features
+  bool ViOnOffStates[VI_ON_OFF_STATE_COUNT];
+  int64_t BurnerStarts;       // -1 if the 'starts' counter was not delivered
+  char ViAnalogValues[VI_ANALOG_VALUE_COUNT][VI_FEATUREVALUELENGTH];
+  // The features which were read from a meter
+  AiOnTheEdgeApiSelection::Feature MeterFeatures[AI_FEATURES_COUNT];
+}
+AcquisitionEvent;
 
-uint64_t loopCounter = 0;
+typedef struct
+{
+  uint8_t Source;             // 1 + m = meter pipeline m
+  char PreValue[12];          // is set as 'pre' value in the meter device (by the task of the meter)
+  uint32_t PostedMicros;
+}
+AcquisitionCommand;
+
+TaskMonitor taskMonitor;
+TaskHandle_t acquisitionTaskHandle = NULL;
+Timezone acquisitionTimezone;    // copy of myTimezone for the acquisition task (the conversions cache the changes of the year)
+int acquisitionTaskId = TASK_MONITOR_INVALID_ID;
+int loopTaskId = TASK_MONITOR_INVALID_ID;
+int acquisitionQueueId = TASK_MONITOR_INVALID_ID;
 int insertCounterAnalogTable = 0;
 int insertCounterApiAnalogTable01 = 0;
-uint32_t Ai_01_Read_Errorcount = 0;
 
 
 uint32_t tryUploadCounter = 0;
@@ -387,9 +546,26 @@ uint32_t loadViFeaturesCount = 0;
 uint32_t loadViFeaturesResp400Count = 0;
 uint32_t loadViFeaturesRespOtherCount = 0;
 
-uint32_t loadGasMeterJsonCount = 0;
 uint32_t loadRefreshTokenCount = 0;
 
+// Metrics which survive resets (RTC memory), unlike the counters above
+MetricsRegistry metrics;
+int metricAnalogInserts = METRICS_INVALID_ID;
+int metricUploads = METRICS_INVALID_ID;
+int metricUploadFails = METRICS_INVALID_ID;
+int metricViFeatures = METRICS_INVALID_ID;
+int metricViFails = METRICS_INVALID_ID;
+int metricMeterReadErrors = METRICS_INVALID_ID;
+int metricNtpUpdates = METRICS_INVALID_ID;
+int metricTokenRefreshes = METRICS_INVALID_ID;
+int metricWiFiReconnects = METRICS_INVALID_ID;
+int metricResetReason = METRICS_INVALID_ID;
+int metricMinFreeHeap = METRICS_INVALID_ID;
+int metricRssi = METRICS_INVALID_ID;
+int metricViLatency = METRICS_INVALID_ID;
+int metricAzureLatency = METRICS_INVALID_ID;
+int metricMeterLatency = METRICS_INVALID_ID;
+
 // not used on Esp32
 int32_t sysTimeNtpDelta = 0;
 
@@ -410,8 +586,15 @@ int32_t sysTimeNtpDelta = 0;
 static bool UseHttps_State = AZURE_TRANSPORT_PROTOKOL == 0 ? false : true;
 static bool UseCaCert_State = AZURE_TRANSPORT_PROTOKOL == 0 ? false : true;
 
-const char * LOG_FILE = "/LogData.json";             // For logging of error conditions etc.
-const char * PERSIST_FILE = "/PersistantData.json";  // For values that shoult persist after reset
+const char * LOG_FILE = "/LogData.bin";              // Ring log of error conditions etc.
+const char * LOG_FILE_JSON = "/LogData.json";        // Former Json log, replaced by LOG_FILE (removed once)
+FlashRingLog flashLog;
+const char * METRICS_FILE = "/Metrics.bin";          // Last flush of the metrics (if the RTC memory was lost)
+const char * PERSIST_FILE = "/PersistantData.json";  // For values that shoult persist after reset (gasmeter)
+const char * PERSIST_FILE_WATER = "/PersistantDataWater.json";  // For values that shoult persist after reset (watermeter)
+const char * METER_STATE_FILE = "/MeterState.jnl";   // Journal for values of the meters that should persist after reset
+                                                     // (replaces PERSIST_FILE and PERSIST_FILE_WATER, which are taken over once)
+JournaledStateStore meterStateStore;
 const char * CONFIG_FILE = "/ConfigSW.json";         // Configuration for Azure and threshold
                                                      // 'CONFIG_FILENAME' is used for Router Credentials
 
@@ -431,6 +614,7 @@ char sSwiThresholdStr[6] = SOUNDSWITCHER_THRESHOLD;
 #define SoundSwitcherThresholdString_Label "sSwiThresholdStr"
 
 #define GasmeterBaseValueOffset_Label "gasmeterBaseValueOffsetStr"
+#define WatermeterBaseValueOffset_Label "watermeterBaseValueOffsetStr"
 
 // for Ai-on-the-edge-devices
 char GasMeterAccountName[20] =  "gasmeter";
@@ -448,35 +632,89 @@ CloudStorageAccount myCloudStorageAccount(azureAccountName, azureAccountKey, Use
 CloudStorageAccount * myCloudStorageAccountPtr = &myCloudStorageAccount;
 
 RestApiAccount gasmeterApiAccount(GasMeterAccountName, "", GasMeterHostName, false, false);
+RestApiAccount watermeterApiAccount(WaterMeterAccountName, "", WaterMeterHostName, false, false);
+
+// Every AiOnTheEdge meter device has its own pipeline with account, read schedule,
+// persisted day base value, datacontainer and table
+MeterPipeline gasmeterPipeline("Gasmeter", &gasmeterApiAccount, gasmeterApiSelectionPtr, &dataContainer, &analogSensorMgr_Ai_01, analogTableName, PERSIST_FILE, true);
+MeterPipeline watermeterPipeline("Watermeter", &watermeterApiAccount, &watermeterApiSelection, &dataContainerWatermeter, &analogSensorMgr_Ai_02, watermeterAnalogTableName, PERSIST_FILE_WATER, USE_WATERMETER == 1);
+
+#define METER_PIPELINES_COUNT 2
+MeterPipeline * meterPipelines[METER_PIPELINES_COUNT] = { &gasmeterPipeline, &watermeterPipeline };
+
+// Held rows of the analog table and of the ...Days table of each meter
+AnalogRowBuffer<1 + 4> meterAnalogRows[METER_PIPELINES_COUNT];
+AnalogRowBuffer<1 + 4> meterDaysRows[METER_PIPELINES_COUNT];
+
+// Every active meter is read by its own task (meterTask()) with its own clients and buffer,
+// so the meters are polled concurrently and a hanging device delays only its own reads
+typedef struct
+{
+  MeterPipeline * Pipeline = nullptr;
+  uint8_t Source = 0;                           // 1 + m, like in the events
+  int TaskId = TASK_MONITOR_INVALID_ID;
+  int CommandQueueId = TASK_MONITOR_INVALID_ID; // requests of loop() to the device (pre value)
+  Timezone LocalTimezone;                       // copy of myTimezone for this task
+  HTTPClient Http;
+  WiFiClient PlainClient;
+  WiFiClientSecure SecureClient;
+  uint8_t Buffer[METER_RESPONSE_BUFFER_LENGTH];
+}
+MeterReader;
+
+MeterReader meterReaders[METER_PIPELINES_COUNT];
  
 
 
 void GPIOPinISR()
 {
   buttonPressed = true;
+  loopPacer.WakeFromISR();
 }
 
 // function forward declarations
 void trimLeadingSpaces(char * workstr);
-VI_Feature ReadViessmannApi_Analog_01(int pSensorIndex, const char * pSensorName, int pValueIndex, ViessmannApiSelection * pViessmannApiSelectionPtr);
-AiOnTheEdgeApiSelection:: Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex, RestApiAccount * pRestApiAccount, const char * pSensorName, AiOnTheEdgeApiSelection * pAiOnTheEdgeApiSelectionPtr);
-t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, const char * refreshToken);
-t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, uint32_t Data_0_Id, const char * p_gateways_0_serial, const char * p_gateways_0_devices_0_id, ViessmannApiSelection * apiSelectionPtr);
+float ReadViessmannApi_Analog_01(int pSensorIndex);
+AiOnTheEdgeApiSelection:: Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex, MeterPipeline * pPipeline, const char * pSensorName);
+t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, const char * refreshToken, DateTime pLocalTime);
+t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, uint32_t Data_0_Id, const char * p_gateways_0_serial, const char * p_gateways_0_devices_0_id, ViessmannApiSelection * apiSelectionPtr, DateTime pLocalTime);
 t_httpCode read_Vi_EquipmentFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, uint32_t * p_data_0_id, const int equipBufLen, char * p_data_0_description, char * p_data_0_address_street, char * p_data_0_address_houseNumber, char * p_gateways_0_serial, char * p_gateways_0_devices_0_id);
-t_httpCode readJsonFromRestApi(X509Certificate pCaCert, RestApiAccount * pRestApiAccount, AiOnTheEdgeApiSelection * apiSelectionPtr);
-t_httpCode setAiPreValueViaRestApi(X509Certificate pCaCert, RestApiAccount * pRestApiAccount, const char * pPreValue);
+t_httpCode readJsonFromRestApi(X509Certificate pCaCert, MeterReader * pReader, DateTime pLocalTime, AiOnTheEdgeApiSelection::Feature outFeatures[]);
+t_httpCode setAiPreValueViaRestApi(X509Certificate pCaCert, MeterReader * pReader, const char * pPreValue);
 t_httpCode read_Vi_UserFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr);
 void print_reset_reason(RESET_REASON reason);
+const char * reset_reason_name(RESET_REASON reason);
+void addHealthRow(MainLoopStats pLoopStats);
+void sendHealthRows();
 void scan_WIFI();
 String floToStr(float value, char decimalChar = '.');
 bool isValidFloat(const char* str);
 bool isValidInt(const char* str);
 bool nearlyEqualFloat(float nominalValue, float actualValue, float absTolerance = 0.0001f);
 //float ReadAnalogSensor_01(int pSensorIndex);
-ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex);
+ValueStruct ReadAnalogSensorStruct_01(MeterPipeline * pPipeline, int pSensorIndex);
+void storeMeterDayBase(MeterPipeline * pPipeline, float pDayBaseValue);
 void createSampleTime(const DateTime dateTimeUTCNow, const int timeZoneOffsetUTC, char * sampleTime, const SampleTimeFormatOpt formatOpt = SampleTimeFormatOpt::FORMAT_FULL_1);
 az_http_status_code  createTable(CloudStorageAccount * myCloudStorageAccountPtr, X509Certificate pCaCert, const char * tableName);
 az_http_status_code insertTableEntity(CloudStorageAccount *myCloudStorageAccountPtr,X509Certificate pCaCert, const char * pTableName, TableEntity pTableEntity, char * outInsertETag);
+void sendRollupRow(AnalogRollup * pRollup, RollupPeriod pPeriod, const char * pTableName, int pTimeZoneOffsetUTC, float pDivisorOfT_1 = 1.0f);
+void sendOnOffTransitions(int pSensorIndex, DateTime pLocalNow);
+void holdViessmannRow(DateTime pLocalTime, int pTimeZoneOffsetUTC);
+void holdMeterRows(int pMeterIndex, DateTime pLocalTime, int pTimeZoneOffsetUTC);
+template<size_t P, size_t N, size_t Extra>
+void holdAnalogRow(AnalogRowBuffer<P> * pBuffer, AnalogEntityBuilder<N, Extra> * pBuilder, DateTime pLocalTime, DateTime pPartitionTime);
+template<size_t P>
+void sendAnalogRows(AnalogRowBuffer<P> * pBuffer, const char * pTableName);
+void reconcileBurnerCycles(bool pLastState, bool pNewState, int64_t pBurnerStarts);
+void acquisitionTask(void * pParameter);
+void meterTask(void * pParameter);
+void processAcquisitionEvents();
+void copyViessmannValues(AcquisitionEvent * outEvent);
+void feedViessmannOnOffStates(const AcquisitionEvent * pEvent);
+void takeOverPreValue(MeterPipeline * pPipeline, t_httpCode pHttpCode);
+uint8_t meterSource(MeterPipeline * pPipeline);
+az_http_status_code insertTableEntities(CloudStorageAccount *myCloudStorageAccountPtr,X509Certificate pCaCert, const char * pTableName, TableEntity pTableEntities[], size_t pEntityCount);
+size_t storeTableEntities(const char * pTableName, TableEntity pTableEntities[], size_t pEntityCount);
 void makePartitionKey(const char * partitionKeyprefix, bool augmentWithYear, DateTime dateTime, az_span outSpan, size_t *outSpanLength);
 void makeRowKey(DateTime actDate, az_span outSpan, size_t *outSpanLength);
 int getDayNum(const char * day);
@@ -568,40 +806,6 @@ String Router_Pass;
 //WPA2 passwords can be up to 63 characters long.
 #define PASS_MAX_LEN            64
 
-typedef struct
-{ 
-  char localTimestamp[30] = {'\0'};
-  char logType[8] = {'\0'};
-  char logMess[50] = {'\0'};
-} Logging_Entry;
-
-typedef struct 
-{
-  char localTimestamp[30] = {'\0'};
-  int timeZoneOffsetUTC = 0; //myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
-  float gas_DayBaseValue = 0.0;
-  int gas_overflowCount = 0; 
-  float water_DayBaseValue = 0.0;
-  int water_overflowCount = 0;
-  uint16_t checksum = 0;
-} First_Reading;
-
-First_Reading first_Reading;
-
-typedef struct 
-{
-  bool isValid = false;
-  float dayConsumption = 0.0f;
-  float totalConsumption = 0.0f;
-} MaxLastDayConsumption;
-
-// Is used to store the LastDayGasConsumption
-// is set in the first reading of each new day
-// if it is valid, the value is stored in a new
-// line in the Azure ...Days Table
-
-MaxLastDayConsumption maxLastDayGasConsumption;
-
 typedef struct
 {
   char wifi_ssid[SSID_MAX_LEN];
@@ -834,6 +1038,7 @@ void check_WiFi()
   if ( (WiFi.status() != WL_CONNECTED) )
   {
     Serial.println(F("\nWiFi lost. Call connectMultiWiFi in loop"));
+    metrics.Increment(metricWiFiReconnects);
     connectMultiWiFi();
   }
 }
@@ -890,131 +1095,39 @@ int calcChecksum(uint8_t* address, uint16_t sizeToCalc)
 #pragma endregion
 
 #pragma region addLogEntry
-bool addLogEntry(const char * logFile, const char * logType, const char * logMessage, uint32_t maxLogMessageCount = 10)
+// Appends one record to the ring log, the oldest entry is overwritten when the log is full
+// The caller passes the local time, since the log is written by loop() and by the acquisition task
+bool addLogEntry(DateTime pLocalTime, const char * logType, const char * logMessage)
 {
-  if (strlen(logMessage) > 50 || strlen(logType) > 7)
+  if (strlen(logMessage) > RING_LOG_MAX_MESSAGE_LENGTH || strlen(logType) > RING_LOG_MAX_TYPE_LENGTH)
   {
     Serial.println("Logging failed: LogType or Logmessage too long (7, 50)");
     return false;
   }
-
-  if (!LittleFS.exists(logFile))
-  {
-    File file = FileFS.open(logFile, "w");
-    if (file)
-    {
-      Logging_Entry create;
-      strcpy(create.localTimestamp, (const char *)localTime.timestamp().c_str());
-      strcpy(create.logType, "Message");
-      strcpy(create.logMess, "Created new Log-File");
- 
-      JsonDocument logDoc;
-      JsonArray logArray = logDoc.to<JsonArray>();
-
-      char jsonCreate[150] = {'\0'};
-      int createSize = snprintf(jsonCreate, sizeof(jsonCreate), "{\"time\":\"%s\",\"logType\":\"%s\",\"logMess\":\"%s\"}", create.localTimestamp, create.logType, create.logMess);
-      if (createSize > sizeof(jsonCreate) -1)
-      {
-        Serial.println("Logging failed: Json-Creation-String too long");
-        file.close();
-        return false; 
-      }
-      logArray.add(serialized((const char *)jsonCreate));     
-      serializeJson(logDoc, file);
-      file.close();   
-    }
-    else
-    {
-      Serial.println("Logging failed: Log-File couldn't be created");
-      return false;
-    }   
-  }
-  else
-  {
-    // RoSchmi
-    // Must be commented out, is only for debugging
-    // LittleFS.remove(logFile);
-  }
-  
-  Logging_Entry nE;
-  strcpy(nE.localTimestamp, (const char *)localTime.timestamp().c_str());
-  strcpy(nE.logType, logType);
-  strcpy(nE.logMess, logMessage);
-
-  File file = LittleFS.open(logFile, "r");
-  if (!file) {
-    Serial.println("Logging failed: Couldn't read Log-File");
-    file.close();
-    return false;
-  }
-     
-  JsonDocument newDoc;
-  DeserializationError error = deserializeJson(newDoc, file);
-  file.close();
-  if (error)
+  if (!flashLog.Append(pLocalTime.unixtime(), logType, logMessage))
   {
-    Serial.println("Logging failed: Couldn't parse Log-File");
+    Serial.println("Logging failed: Couldn't write Log-File");
     return false;
   }
-
-  file = LittleFS.open(logFile, "w");
-    
-  JsonArray logArray = newDoc.as<JsonArray>();
-  while (logArray.size() > maxLogMessageCount)
-  {
-    logArray.remove(0);
-  }
-  
-  char jsonAct[150] = {'\0'};
-  int actSize = snprintf(jsonAct, sizeof(jsonAct), "{\"time\":\"%s\",\"logType\":\"%s\",\"logMess\":\"%s\"}", nE.localTimestamp, nE.logType, nE.logMess);
-  if (actSize > sizeof(jsonAct) -1)
-  {
-    Serial.println("Logging failed: Json-String to long");
-    file.close();
-    return false; 
-  }
-  
-  logArray.add(serialized((const char *)jsonAct));
-  
-  serializeJson(newDoc, file);
-  file.close();
   return true;  
 }
 #pragma endregion
 
 #pragma region printLogEntries
-// Prints the logFile
+// Prints the newest entries of the log as Json array
 // Returns 0 if the value of the last logType was not an integer
 // or the value of the logType if the value was an integer
 // this gives an info about the last boot reason
-int printLogEntries(const char * logFile)
+int printLogEntries(uint32_t maxLogMessageCount)
 {
-    File file = LittleFS.open(logFile, "r");
-    if (!file)
-    {
-      Serial.println("Printing Log-File failed: Couldn't read Log-File");
-      return 0;
-    }
-    JsonDocument printDoc;
-    DeserializationError error = deserializeJson(printDoc, file);
-    
-    if (error)
-    {
-      Serial.println("Printing Log-File failed: Couldn't parse Log-File");
-      file.close();
-      return 0;
-    }
-    file.close();
-    Serial.printf("Printing Log-File %s:\n", logFile);
-    serializeJson(printDoc, Serial);
+    Serial.printf("Printing Log-File %s (%u of %u entries):\n", LOG_FILE, flashLog.GetCount(), flashLog.GetCapacity());
+    flashLog.ExportJson(&Serial, maxLogMessageCount);
     Serial.println("");
 
-    JsonArray arr = printDoc.as<JsonArray>();
-    JsonObject lastEntry = arr[arr.size() - 1];
-    const char* lastLogType = lastEntry["logType"];
-    if (isValidInt(lastLogType))
+    RingLogEntry lastEntry;
+    if (flashLog.GetNewest(&lastEntry) && isValidInt(lastEntry.LogType))
     {
-      return atoi(lastLogType);
+      return atoi(lastEntry.LogType);
     }
     else
     {
@@ -1096,27 +1209,84 @@ void saveWiFiConfigData()   // Save Router WiFi-Credentials to file
 }   // end saveWiFiConfigData
 #pragma endregion
 
+#pragma region readFormerDayBase()
+// Reads the persist file of former versions: 56 bytes (First_Reading, gas and water values)
+// or 48 bytes (MeterDayBase), the leading members are the same
+// The 16 bit checksum of these files was calculated over all bytes up to the end of the checksum,
+// so it contains the two bytes of the checksum before the update: the difference between the
+// stored checksum and the sum of the bytes before it must be in the range of two bytes (0 - 510)
+bool readFormerDayBase(const char * pPath, MeterDayBase * outDayBase)
+{
+  uint8_t buffer[64] = {0};
+  size_t checksumOffset = 0;
+  File f = FileFS.open(pPath, "r");
+  if (!f)
+  {
+    return false;
+  }
+  size_t fileSize = f.size();
+  bool isRead = (fileSize <= sizeof(buffer)) && (f.read(buffer, fileSize) == fileSize);
+  f.close();
+  if (!isRead)
+  {
+    return false;
+  }
+  switch (fileSize)
+  {
+    case 56: checksumOffset = 52; break;
+    case 48: checksumOffset = offsetof(MeterDayBase, checksum); break;
+    default: return false;
+  }
+  uint16_t sum = calcChecksum(buffer, checksumOffset);
+  uint16_t storedChecksum = buffer[checksumOffset] | (buffer[checksumOffset + 1] << 8);
+  if ((uint16_t)(storedChecksum - sum) > 2 * 0xFF)
+  {
+    return false;
+  }
+  memset((void *)outDayBase, 0, sizeof(MeterDayBase));
+  memcpy((void *)outDayBase, buffer, offsetof(MeterDayBase, checksum));
+  outDayBase ->localTimestamp[sizeof(outDayBase ->localTimestamp) - 1] = '\0';
+
+  DateTime timestamp;
+  return DateTime::parse(outDayBase ->localTimestamp, &timestamp) && isfinite(outDayBase ->dayBaseValue) && outDayBase ->dayBaseValue >= 0.0f;
+}
+#pragma endregion
+
 #pragma region loadPermanentData()
 bool loadPermanentData()
 {
-  File f = FileFS.open(PERSIST_FILE, "r");
-  if (!f)
+  // The base values of the day of the meters are kept in a journal,
+  // every update appends one small record
+  if (!meterStateStore.Begin(&FileFS, METER_STATE_FILE))
   {
-    Serial.println(F("Persistent Data file not found"));
+    Serial.println(F("Meter state journal could not be opened"));
     return false;
   }
-  else
+  if (meterStateStore.GetDiscardedBytes() > 0)
   {
-    // we could open the file
-    size_t size = f.size();
-    // Allocate a buffer to store contents of the file.
-    std::unique_ptr<char[]> buf(new char[size + 1]);
+    Serial.printf("Meter state journal: %u damaged bytes removed\n", meterStateStore.GetDiscardedBytes());
+  }
+  for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+  {
+    MeterPipeline * pipeline = meterPipelines[m];
+    pipeline ->StateKey = m;
 
-    // Read and store file contents in buf
-    f.readBytes(buf.get(), size);  
-    f.close();
-    return true;
+    // Take over the persist file of former versions
+    if (!meterStateStore.Contains(pipeline ->StateKey) && FileFS.exists(pipeline ->PersistFile))
+    {
+      MeterDayBase formerDayBase;
+      if (!readFormerDayBase(pipeline ->PersistFile, &formerDayBase))
+      {
+        Serial.printf("%s is damaged, the day base is not taken over\n", pipeline ->PersistFile);
+      }
+      else if (meterStateStore.Put(pipeline ->StateKey, &formerDayBase, sizeof(MeterDayBase)))
+      {
+        FileFS.remove(pipeline ->PersistFile);
+      }
+    }
+    meterStateStore.Get(pipeline ->StateKey, &pipeline ->DayBase, sizeof(MeterDayBase));
   }
+  return true;
 }
 #pragma endregion
 
@@ -1197,6 +1367,13 @@ bool loadApplConfigData()    // Config parameter for Azure credentials, Viessman
     {
       strcpy(gasmeterBaseValueOffsetStr, json[GasmeterBaseValueOffset_Label]);
       gasmeterBaseValueOffsetInt = strtoul((const char *)gasmeterBaseValueOffsetStr, NULL, 10);
+      gasmeterApiSelection.baseValueOffset = gasmeterBaseValueOffsetInt;
+    }
+    if (json.containsKey(WatermeterBaseValueOffset_Label))
+    {
+      strcpy(watermeterBaseValueOffsetStr, json[WatermeterBaseValueOffset_Label]);
+      watermeterBaseValueOffsetInt = strtoul((const char *)watermeterBaseValueOffsetStr, NULL, 10);
+      watermeterApiSelection.baseValueOffset = watermeterBaseValueOffsetInt;
     }
     if (json.containsKey(SoundSwitcherThresholdString_Label))
     {
@@ -1227,6 +1404,7 @@ bool saveApplConfigData() // Config parameter for Azure credentials, Viessmann R
   trimLeadingSpaces((char *)viessmannClientId);
   trimLeadingSpaces((char *)viessmannRefreshToken);
   trimLeadingSpaces((char *)gasmeterBaseValueOffsetStr);
+  trimLeadingSpaces((char *)watermeterBaseValueOffsetStr);
 
   // JSONify local configuration parameters 
   json[AzureAccountName_Label] = azureAccountName;
@@ -1235,6 +1413,7 @@ bool saveApplConfigData() // Config parameter for Azure credentials, Viessmann R
   json[ViessmannRefreshToken_Label] = strlen(viessmannRefreshToken) > 2 ? viessmannRefreshToken : "";
   
   json[GasmeterBaseValueOffset_Label] = gasmeterBaseValueOffsetStr;
+  json[WatermeterBaseValueOffset_Label] = watermeterBaseValueOffsetStr;
   json[SoundSwitcherThresholdString_Label] = sSwiThresholdStr;
   // Open file for writing
   File f = FileFS.open(CONFIG_FILE, "w");
@@ -1442,6 +1621,38 @@ void setup()
         delay(1);
       }
     }
+
+  #if FLASH_LOGGING == 1
+    // Fixed size log file, an entry is one small write
+    if (FileFS.exists(LOG_FILE_JSON))
+    {
+      FileFS.remove(LOG_FILE_JSON);
+    }
+    if (!flashLog.Begin(&FileFS, LOG_FILE, LOGGING_SECTORS))
+    {
+      Serial.println(F("Log-File couldn't be created"));
+    }
+  #endif
+
+  // The order of the metrics must not change, otherwise the stored values are discarded
+  metricAnalogInserts = metrics.AddCounter("analogInserts");
+  metricUploads = metrics.AddCounter("uploads");
+  metricUploadFails = metrics.AddCounter("uploadFails");
+  metricViFeatures = metrics.AddCounter("viFeatures");
+  metricViFails = metrics.AddCounter("viFails");
+  metricMeterReadErrors = metrics.AddCounter("meterReadErrors");
+  metricNtpUpdates = metrics.AddCounter("ntpUpdates");
+  metricTokenRefreshes = metrics.AddCounter("tokenRefreshes");
+  metricWiFiReconnects = metrics.AddCounter("wifiReconnects");
+  metricResetReason = metrics.AddGauge("resetReason");
+  metricMinFreeHeap = metrics.AddGauge("minFreeHeap");
+  metricRssi = metrics.AddGauge("rssi");
+  metricViLatency = metrics.AddLatency("viLatency");
+  metricAzureLatency = metrics.AddLatency("azureLatency");
+  metricMeterLatency = metrics.AddLatency("meterLatency");
+  bool metricsAreTaken = metrics.Begin(&FileFS, METRICS_FILE);
+  metrics.SetGauge(metricResetReason, (int32_t)esp_reset_reason());
+  Serial.printf("Metrics: boot %u, %s\n", metrics.GetBootCount(), metricsAreTaken ? "values of the last run taken" : "started at 0");
   
 
   unsigned long startedAt = millis();
@@ -1521,6 +1732,7 @@ void setup()
   ESPAsync_WMParameter p_viessmannClientId(ViessmannClientId_Label, "Viessmann Client Id", viessmannClientId, 50);
   ESPAsync_WMParameter p_viessmannRefreshToken(ViessmannRefreshToken_Label, "Viessmann Refresh Token", "", 60);
   ESPAsync_WMParameter p_gasmeterBaseValueOffset(GasmeterBaseValueOffset_Label, "Gasmeter Base Offset",gasmeterBaseValueOffsetStr, 10);
+  ESPAsync_WMParameter p_watermeterBaseValueOffset(WatermeterBaseValueOffset_Label, "Watermeter Base Offset",watermeterBaseValueOffsetStr, 10);
   ESPAsync_WMParameter p_soundSwitcherThreshold(SoundSwitcherThresholdString_Label, "Noise Threshold", sSwiThresholdStr, 6);
   // Just a quick hint
   ESPAsync_WMParameter p_hint("<small>*Hint: if you want to reuse the currently active WiFi credentials, leave SSID and Password fields empty. <br/>*Portal Password = MyESP_'hexnumber'</small>");
@@ -1534,6 +1746,7 @@ void setup()
   ESPAsync_wifiManager.addParameter(&p_viessmannClientId);
   ESPAsync_wifiManager.addParameter(&p_viessmannRefreshToken);
   ESPAsync_wifiManager.addParameter(&p_gasmeterBaseValueOffset);
+  ESPAsync_wifiManager.addParameter(&p_watermeterBaseValueOffset);
   ESPAsync_wifiManager.addParameter(&p_soundSwitcherThreshold);
 
   // Check if there are stored WiFi router/password credentials.
@@ -1738,6 +1951,13 @@ void setup()
     sprintf(gasmeterBaseValueOffsetStr, "%u", gasmeterBaseValueOffsetInt);
     gasmeterApiSelection.baseValueOffset = gasmeterBaseValueOffsetInt;
   }
+  if (strlen(p_watermeterBaseValueOffset.getValue()) > 0)
+  {
+    strcpy(watermeterBaseValueOffsetStr, p_watermeterBaseValueOffset.getValue());
+    watermeterBaseValueOffsetInt = strtoul((const char *)watermeterBaseValueOffsetStr, NULL, 10);
+    sprintf(watermeterBaseValueOffsetStr, "%u", watermeterBaseValueOffsetInt);
+    watermeterApiSelection.baseValueOffset = watermeterBaseValueOffsetInt;
+  }
   strcpy(sSwiThresholdStr, p_soundSwitcherThreshold.getValue());
     
     // Writing JSON config file to flash for next boot
@@ -1750,6 +1970,15 @@ void setup()
 
   // Azure Acount must be updated here with eventually changed values from WiFi-Manager
   myCloudStorageAccount.ChangeAccountParams((char *)azureAccountName, (char *)azureAccountKey, UseHttps_State, UseCaCert_State);
+  #if AZURE_AUTH_MODE_SAS == 1
+    #ifndef AZURE_CONFIG_SAS_TOKEN
+      #error "AZURE_AUTH_MODE_SAS needs AZURE_CONFIG_SAS_TOKEN in config_secret.h"
+    #endif
+    myCloudStorageAccount.SetSasToken(AZURE_CONFIG_SAS_TOKEN);
+    #if SERIAL_PRINT == 1
+      Serial.println(myCloudStorageAccount.UsesSas() ? F("Azure: SAS authentication") : F("Azure: SAS token too long, SharedKey is used"));
+    #endif
+  #endif
   
   #if WORK_WITH_WATCHDOG == 1
     // Start watchdog with 20 seconds
@@ -1827,7 +2056,7 @@ void setup()
 
   // Initialize State of 4 On/Off-sensor representations 
   // and of the inverter flags (Application specific)
-  for (int i = 0; i < 4; i++)
+  for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)
   {
     onOffDataContainer.PresetOnOffState(i, false, true);
     onOffDataContainer.Set_OutInverter(i, true);
@@ -1919,6 +2148,8 @@ void setup()
 
   unsigned long utcTime = timeClient.getUTCEpochTime();  // Seconds since 1. Jan. 1970
   
+  clockDiscipline.Begin();
+  clockDiscipline.AddReference(utcTime, ClockSource::Ntp);
   dateTimeUTCNow =  utcTime;
 
   Serial.printf("%s %i %02d %02d %02d %02d", (char *)"UTC-Time is  :", dateTimeUTCNow.year(), 
@@ -1939,8 +2170,8 @@ void setup()
   Serial.println("\n");
 
   #if FLASH_LOGGING == 1      
-      int lastLogTypeAsInteger = printLogEntries(LOG_FILE);
-      addLogEntry(LOG_FILE, "Message", "Program started", LOGGING_ENTRIES);
+      int lastLogTypeAsInteger = printLogEntries(LOGGING_ENTRIES);
+      addLogEntry(localTime, "Message", "Program started");
 
       // The following assignment serves as a rudimentary form of debugging
       // depending on the error that caused the reboot, the ramp (showing
@@ -1955,14 +2186,31 @@ void setup()
   // Set Standard Read Interval
   // Is limited to be not below 2 seconds
   analogSensorMgr_Ai_01.SetReadInterval(ANALOG_SENSOR_READ_INTERVAL_SECONDS < 2 ? 2 : ANALOG_SENSOR_READ_INTERVAL_SECONDS);
-  // Set Read Interval for special sensor
-  analogSensorMgr_Ai_01.SetReadInterval(0, GASMETER_AI_API_READ_INTERVAL_SECONDS);
-  analogSensorMgr_Ai_01.SetReadInterval(1, GASMETER_AI_API_READ_INTERVAL_SECONDS);
-  analogSensorMgr_Ai_01.SetReadInterval(2, GASMETER_AI_API_READ_INTERVAL_SECONDS);
+  analogSensorMgr_Ai_02.SetReadInterval(ANALOG_SENSOR_READ_INTERVAL_SECONDS < 2 ? 2 : ANALOG_SENSOR_READ_INTERVAL_SECONDS);
+  // Set Read Interval for the sensors of the meter devices
+  gasmeterPipeline.SetReadInterval(GASMETER_AI_API_READ_INTERVAL_SECONDS);
+  watermeterPipeline.SetReadInterval(WATERMETER_AI_API_READ_INTERVAL_SECONDS);
+  gasmeterPipeline.Plausibility.Begin(GASMETER_MAX_FLOW_PER_MINUTE, METER_RESYNC_AFTER_REJECTS);
+  watermeterPipeline.Plausibility.Begin(WATERMETER_MAX_FLOW_PER_MINUTE, METER_RESYNC_AFTER_REJECTS);
   
   analogSensorMgr_Vi_01.SetReadInterval(API_ANALOG_SENSOR_READ_INTERVAL_SECONDS);
+
+  // Source numbers of the sensor groups in the scheduler: 0 = Ai_01, 1 = Ai_02, 2 = Vi_01
+  // Of the meters only the polled channel of an active meter gets deadlines
+  gasmeterPipeline.AttachScheduler(&sensorScheduler, 0);
+  watermeterPipeline.AttachScheduler(&sensorScheduler, 1);
+  analogSensorMgr_Vi_01.AttachScheduler(&sensorScheduler, 2);
+
+  #if VI_SEND_BY_EXCEPTION == 1
+    // Outside and hot water temperature are static for hours, send only on changes
+    TimeSpan viHeartbeat = TimeSpan((VI_HEARTBEAT_MINUTES < 1 ? 1 : VI_HEARTBEAT_MINUTES) * 60);
+    dataContainerAnalogViessmann01.SetSendPolicy(0, SendPolicy::Deadband, VI_DEADBAND_T_1, viHeartbeat);
+    dataContainerAnalogViessmann01.SetSendPolicy(1, SendPolicy::Deadband, VI_DEADBAND_T_2, viHeartbeat);
+    dataContainerAnalogViessmann01.SetSendPolicy(2, SendPolicy::Deadband, VI_DEADBAND_T_3, viHeartbeat);
+    dataContainerAnalogViessmann01.SetSendPolicy(3, SendPolicy::Deadband, VI_DEADBAND_T_4, viHeartbeat);
+  #endif
   
-  httpCode = refresh_Vi_AccessTokenFromApi((const char*)"dummyCaCert", myViessmannApiAccountPtr, viessmannRefreshToken);
+  httpCode = refresh_Vi_AccessTokenFromApi((const char*)"dummyCaCert", myViessmannApiAccountPtr, viessmannRefreshToken, localTime);
   if (httpCode == t_http_codes::HTTP_CODE_OK)
   {   
     AccessTokenRefreshTime = dateTimeUTCNow;
@@ -1970,10 +2218,10 @@ void setup()
   else
   {
     #if FLASH_LOGGING == 1
-        addLogEntry(LOG_FILE, "5", "Couldn't refr. access token", LOGGING_ENTRIES);
+        addLogEntry(localTime, "5", "Couldn't refr. access token");
     #endif     
     Serial.println(F("Couldn't refresh accessToken from Viessmann Cloud. Error message is:"));
-    Serial.println((char*)bufferStorePtr);
+    Serial.println((char*)acquisitionBufferPtr);
     ESP.restart();
     while(true)
     {
@@ -1992,9 +2240,9 @@ void setup()
   {     
     Serial.println(F("Couldn't read UserId from Viessmann Cloud.\r\nError message is:"));
     #if FLASH_LOGGING == 1
-        addLogEntry(LOG_FILE, "10", "Couldn't read user", LOGGING_ENTRIES);
+        addLogEntry(localTime, "10", "Couldn't read user");
     #endif
-    Serial.println((char*)bufferStorePtr);
+    Serial.println((char*)acquisitionBufferPtr);
     ESP.restart();
     while(true)
     {
@@ -2012,10 +2260,10 @@ void setup()
   else
   {
     #if FLASH_LOGGING == 1
-        addLogEntry(LOG_FILE, "15", "Couldn't read equipment", LOGGING_ENTRIES);
+        addLogEntry(localTime, "15", "Couldn't read equipment");
     #endif     
     Serial.println(F("Couldn't read Equipment from Viessmann Cloud.\r\nError message is:"));
-    Serial.println((char*)bufferStorePtr);
+    Serial.println((char*)acquisitionBufferPtr);
     // RoSchmi
     
     ESP.restart();
@@ -2025,16 +2273,108 @@ void setup()
     }
       
   }
+
+  // The acquisition task wakes the radio for its polls, so the power mode is selected before
+  powerModeManager.Begin(LOW_POWER_MODE == 1, LOW_POWER_UPLOAD_BATCH_SECONDS);
+
+  // Start the pipeline: acquisition task and meter tasks --> queue --> loop() (processing and upload)
+  acquisitionTimezone = myTimezone;
+  acquisitionQueueId = taskMonitor.CreateQueue("Acquired", ACQUISITION_QUEUE_LENGTH, sizeof(AcquisitionEvent));
+  loopTaskId = taskMonitor.RegisterTask("Loop", xTaskGetCurrentTaskHandle(), xPortGetCoreID());
+  if (xTaskCreatePinnedToCore(acquisitionTask, "Acquisition", ACQUISITION_TASK_STACK_SIZE, NULL, ACQUISITION_TASK_PRIORITY, &acquisitionTaskHandle, ACQUISITION_TASK_CORE) != pdPASS)
+  {
+    Serial.println(F("Couldn't start acquisition task. Rebooting"));
+    ESP.restart();
+    while(true)
+    {
+      delay(500);
+    }
+  }
+  for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+  {
+    MeterReader * reader = &meterReaders[m];
+    reader ->Pipeline = meterPipelines[m];
+    reader ->Source = 1 + m;
+    reader ->LocalTimezone = myTimezone;
+    if (!reader ->Pipeline ->IsActive)
+    {
+      continue;
+    }
+    reader ->CommandQueueId = taskMonitor.CreateQueue(reader ->Pipeline ->Label, METER_COMMAND_QUEUE_LENGTH, sizeof(AcquisitionCommand));
+    if (xTaskCreatePinnedToCore(meterTask, reader ->Pipeline ->Label, METER_TASK_STACK_SIZE, reader, ACQUISITION_TASK_PRIORITY, NULL, ACQUISITION_TASK_CORE) != pdPASS)
+    {
+      Serial.printf("Couldn't start the task of %s. Rebooting\n", reader ->Pipeline ->Label);
+      ESP.restart();
+      while(true)
+      {
+        delay(500);
+      }
+    }
+  }
+
+  // From now on loop() waits for the cycles of the pacer instead of spinning
+  uint32_t mainLoopCycleMs = LOW_POWER_MODE == 1 ? LOW_POWER_CYCLE_MS : MAIN_LOOP_CYCLE_MS;
+  loopPacer.Begin(mainLoopCycleMs, LOW_POWER_MODE == 1 || MAIN_LOOP_LIGHT_SLEEP == 1);
+  #if SERIAL_PRINT == 1
+    Serial.printf("Main loop cycle: %u ms, light sleep: %s, low power mode: %s\n", mainLoopCycleMs,
+       loopPacer.LightSleepIsEnabled() ? "on" : "off", powerModeManager.IsLowPower() ? "on" : "off");
+  #endif
 }
 #pragma endregion
 
 #pragma region     loop()
 void loop()
 {
+  // Block until the next cycle, or earlier when the next sensor deadline comes first
+  // A deadline which is already over (the acquisition task was busy when the sensor was due) is left to the regular cycles
+  uint32_t maxWaitMs = UINT32_MAX;
+  if (sensorScheduler.HasDeadline())
+  {
+    int32_t secondsToDeadline = (int32_t)(sensorScheduler.nextDeadline().unixtime() - clockDiscipline.GetUtcSeconds());
+    maxWaitMs = secondsToDeadline > 0 ? (uint32_t)secondsToDeadline * 1000 : UINT32_MAX;
+  }
+  bool cycleIsDue = loopPacer.WaitForNextCycle(maxWaitMs);
+  taskMonitor.BeginWork(loopTaskId);
+
   check_status();   // Checks if WiFi is still connected
                     // if not, try other Accesspoint
-  // put your main code here, to run repeatedly:
-  if (++loopCounter % 100000 == 0)   // Make decisions to send data every 100000 th round and toggle Led to signal that App is running
+
+  // The loop statistics are printed and stored in the health table per report interval
+  static uint32_t lastLoopReportMs = millis();
+  if (millis() - lastLoopReportMs >= (uint32_t)MAIN_LOOP_REPORT_SECONDS * 1000)
+  {
+    lastLoopReportMs = millis();
+    MainLoopStats loopStats = loopPacer.GetStats();
+    #if HEALTH_TELEMETRY == 1
+      addHealthRow(loopStats);
+    #endif
+    #if SERIAL_PRINT == 1
+      Serial.printf("Loop: %u cycles (%u early), jitter mean %u ms max %u ms, overruns %u, cycle p50 %u ms p99 %u ms longest %u ms, blocked %.1f %%\n",
+         loopStats.CycleCount, loopStats.EarlyWakeCount, loopStats.MeanJitterMs, loopStats.MaxJitterMs, loopStats.OverrunCount, loopStats.WorkMsP50, loopStats.WorkMsP99,
+         loopStats.WorkMsMax, loopStats.BlockedPercent);
+      PowerModeStats powerStats = powerModeManager.GetStats();
+      Serial.printf("Power: cpu duty %.1f %% / %.1f %% (core 0 / 1), radio duty %.1f %%, %u upload bursts, wake to data mean %u ms max %u ms, %u cycles held\n",
+         100.0 - loopStats.CpuIdlePercent[0], 100.0 - loopStats.CpuIdlePercent[MAIN_LOOP_CPU_COUNT - 1], powerStats.RadioDutyPercent, powerStats.BurstCount, powerStats.MeanWakeToDataMs, powerStats.MaxWakeToDataMs, powerStats.HeldCount);
+      ClockStats clockStats = clockDiscipline.GetStats();
+      Serial.printf("Clock: drift %.1f ppm, last offset %d ms, %u references (%u NTP), %u steps, last reference %u s ago\n",
+         clockStats.DriftPpm, clockStats.LastOffsetMs, clockStats.ReferenceCount, clockStats.NtpCount, clockStats.StepCount, clockStats.SecondsSinceReference);
+      taskMonitor.PrintStats(&Serial);
+      metrics.PrintStats(&Serial);
+    #endif
+    loopPacer.ResetStats();
+    powerModeManager.ResetStats();
+  }
+
+  static uint32_t lastMetricsFlushMs = millis();
+  if (millis() - lastMetricsFlushMs >= (uint32_t)METRICS_FLUSH_INTERVAL_MINUTES * 60 * 1000)
+  {
+    lastMetricsFlushMs = millis();
+    metrics.SetGauge(metricMinFreeHeap, (int32_t)ESP.getMinFreeHeap());
+    metrics.SetGauge(metricRssi, WiFi.RSSI());
+    metrics.Flush();
+  }
+
+  if (cycleIsDue)   // Make decisions to send data and toggle Led to signal that App is running
   {
 
     #if SERIAL_PRINT == 1
@@ -2046,12 +2386,15 @@ void loop()
       esp_task_wdt_reset();
     #endif
     
-      // Update RTC from Ntp when ntpUpdateInterval has expired, retry when RetryInterval has expired       
-      if (timeClient.update())
+      // NTP is only asked when there was no reference (NTP or Azure response) within the ntpUpdateInterval,
+      // retry when RetryInterval has expired
+      if (clockDiscipline.ReferenceIsDue((NTP_UPDATE_INTERVAL_MINUTES < 1 ? 1 : NTP_UPDATE_INTERVAL_MINUTES) * 60) && timeClient.update())
       {                                                                      
-        dateTimeUTCNow = timeClient.getUTCEpochTime();
+        clockDiscipline.AddReference(timeClient.getUTCEpochTime(), ClockSource::Ntp);
+        dateTimeUTCNow = clockDiscipline.GetUtcSeconds();
         
         timeNtpUpdateCounter++;
+        metrics.Increment(metricNtpUpdates);
 
         #if SERIAL_PRINT == 1
           // Indicate that NTP time was updated
@@ -2062,50 +2405,77 @@ void loop()
         #endif
       }  // End NTP stuff
           
-      dateTimeUTCNow = timeClient.getUTCEpochTime();
+      dateTimeUTCNow = clockDiscipline.GetUtcSeconds();
       
-      // Get offset in minutes between UTC and local time with consideration of DST
-      int timeZoneOffsetUTC = myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
-      
-      localTime = myTimezone.toLocal(dateTimeUTCNow.unixtime());
+      // Get local time and offset in minutes between UTC and local time with consideration of DST
+      int timeZoneOffsetUTC = TIMEZONEOFFSET;
+      localTime = myTimezone.toLocalWithOffset(dateTimeUTCNow.unixtime(), &timeZoneOffsetUTC);
       timeDiffUtcToLocal = localTime.operator-(dateTimeUTCNow);
       
-      // refresh Viessmann access token if refresh interval has expired 
-      if ((AccessTokenRefreshTime.operator+(AccessTokenRefreshInterval)).operator<(dateTimeUTCNow))
-      {
-          httpCode = refresh_Vi_AccessTokenFromApi((const char*)"dummyCaCert", myViessmannApiAccountPtr, viessmannRefreshToken);
-          
-          if (httpCode == t_http_codes::HTTP_CODE_OK)
-          {           
-            AccessTokenRefreshTime = dateTimeUTCNow;
-          }
-          else
-          {
-            Serial.println(F("Token Refresh failed\n"));            
-            AccessTokenRefreshTime = dateTimeUTCNow.operator-(TimeSpan(300));
-          }
-      }
+      // The Viessmann access token is refreshed by the acquisition task
+
+      // Take over the results of the reads of the acquisition task and of the meter tasks
+      processAcquisitionEvents();
 
       // In the last 15 sec of each day we set a pulse to Off-State when we had On-State before
       bool isLast15SecondsOfDay = (localTime.hour() == 23 && localTime.minute() == 59 &&  localTime.second() > 45) ? true : false;
 
       // Get readings from 4 different analog sensors stored in the Viessmann Cloud    
-      // and store the values in a container
+      // and store the values in a container (the features are listed in viAnalogFeatureNames)
       
-      dataContainerAnalogViessmann01.SetNewValue(0, dateTimeUTCNow, atof((ReadViessmannApi_Analog_01(0, (const char *)"heating.sensors.temperature.outside", 0, viessmannApiSelectionPtr_01)).values[0].value)); // Aussen
-      dataContainerAnalogViessmann01.SetNewValue(1, dateTimeUTCNow, atof((ReadViessmannApi_Analog_01(1, (const char *)"heating.circuits.0.sensors.temperature.supply", 0, viessmannApiSelectionPtr_01)).values[0].value)); // Vorlauf
-      dataContainerAnalogViessmann01.SetNewValue(2, dateTimeUTCNow, atof((ReadViessmannApi_Analog_01(2, (const char *)"heating.dhw.sensors.temperature.dhwCylinder", 0, viessmannApiSelectionPtr_01)).values[0].value)); // Warmwasser
-      dataContainerAnalogViessmann01.SetNewValue(3, dateTimeUTCNow, atof((ReadViessmannApi_Analog_01(3, (const char *)"heating.burners.0.modulation", 0, viessmannApiSelectionPtr_01)).values[0].value)); // Modulation
+      dataContainerAnalogViessmann01.SetNewValue(0, dateTimeUTCNow, ReadViessmannApi_Analog_01(0)); // Aussen
+      dataContainerAnalogViessmann01.SetNewValue(1, dateTimeUTCNow, ReadViessmannApi_Analog_01(1)); // Vorlauf
+      dataContainerAnalogViessmann01.SetNewValue(2, dateTimeUTCNow, ReadViessmannApi_Analog_01(2)); // Warmwasser
+      dataContainerAnalogViessmann01.SetNewValue(3, dateTimeUTCNow, ReadViessmannApi_Analog_01(3)); // Modulation
+
+      #if ANALOG_SENSORS_SEND_ROLLUPS == 1
+        // Values which were accepted by the container in this round are added to the running hour and day
+        for (size_t i = 0; i < AnalogRollup::ChannelCount; i++)
+        {
+          if (dataContainerAnalogViessmann01.SampleValues[i].LastUpdateValueTime.operator==(dateTimeUTCNow))
+          {
+            analogRollupViessmann01.AddSample(i, localTime, dataContainerAnalogViessmann01.SampleValues[i].Value);
+          }
+        }
+        bool rollupHasToBeSent = analogRollupViessmann01.HasToBeSent(RollupPeriod::Hour) || analogRollupViessmann01.HasToBeSent(RollupPeriod::Day);
+      #else
+        bool rollupHasToBeSent = false;
+      #endif
       
       ledState = !ledState;
       digitalWrite(LED_BUILTIN, ledState);    // toggle LED to signal that App is running
 
-      // Get readings from 4 different analog sensors, (preferably measured by the Esp 32 device, e.g. noise level)     
-      // and store the values in a container      
-      dataContainer.SetNewValueStruct(0, dateTimeUTCNow, ReadAnalogSensorStruct_01(0), true);
-      dataContainer.SetNewValueStruct(1, dateTimeUTCNow, ReadAnalogSensorStruct_01(1), true);     
-      dataContainer.SetNewValueStruct(2, dateTimeUTCNow, ReadAnalogSensorStruct_01(2), false);      
-      dataContainer.SetNewValueStruct(3, dateTimeUTCNow, ReadAnalogSensorStruct_01(3), false); 
+      // Get readings from the 4 analog channels of each active meter (AiOnTheEdge devices)     
+      // and store the values in the container of the meter
+      // Every meter has its own read schedule, so they are polled independently
+      // Channel 0 takes the reading which came in with the events of this cycle (processAcquisitionEvents())
+      // The due rows are taken from the containers now, also when the upload has to wait
+      for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+      {
+        MeterPipeline * pipeline = meterPipelines[m];
+        if (!pipeline ->IsActive)
+        {
+          continue;
+        }
+        pipeline ->Container ->SetNewValueStruct(0, dateTimeUTCNow, ReadAnalogSensorStruct_01(pipeline, 0), true);
+        pipeline ->Container ->SetNewValueStruct(1, dateTimeUTCNow, ReadAnalogSensorStruct_01(pipeline, 1), true);     
+        pipeline ->Container ->SetNewValueStruct(2, dateTimeUTCNow, ReadAnalogSensorStruct_01(pipeline, 2), false);      
+        pipeline ->Container ->SetNewValueStruct(3, dateTimeUTCNow, ReadAnalogSensorStruct_01(pipeline, 3), false);
+        if (pipeline ->Container ->hasToBeSent())
+        {
+          holdMeterRows(m, localTime, timeZoneOffsetUTC);
+        }
+        #if ANALOG_SENSORS_SEND_ROLLUPS == 1
+          for (size_t i = 0; i < AnalogRollup::ChannelCount; i++)
+          {
+            if (pipeline ->Container ->SampleValues[i].LastUpdateValueTime.operator==(dateTimeUTCNow))
+            {
+              pipeline ->Rollup.AddSample(i, localTime, pipeline ->Container ->SampleValues[i].Value);
+            }
+          }
+          rollupHasToBeSent = rollupHasToBeSent || pipeline ->Rollup.HasToBeSent(RollupPeriod::Hour);
+        #endif
+      } 
       
       #pragma region Automatic OnOffSwitcher has toggled ? Is for tests and debugging
       // Check if automatic OnOffSwitcher has toggled (used to simulate on/off changes)
@@ -2172,432 +2542,144 @@ void loop()
       #pragma endregion
 
       #pragma region Check if something has to be sent to Azure, if so --> do           
+      // The switch events of the On/Off sensors are buffered and sent in batches
+      bool onOffFlushIsDue = onOffDataContainer.TransitionsHaveToBeFlushed(dateTimeUTCNow, ON_OFF_FLUSH_COUNT, ON_OFF_FLUSH_SECONDS);
+
+      // In low power mode due uploads wait for the next burst, except at the end of the day
+      // or when the switch events of a sensor would soon overwrite each other
+      // The health rows go the same way as the switch events: collected and sent in batches
+      bool healthFlushIsDue = healthRowCount >= HEALTH_BATCH_ROWS;
+
+      // The due analog rows wait in their buffers until the upload is allowed
+      if (dataContainerAnalogViessmann01.hasToBeSent())   // have to send analog values read from Viessmann ?
+      {
+        holdViessmannRow(localTime, timeZoneOffsetUTC);
+      }
+      bool analogRowsAreHeld = viAnalogRows.Count > 0;
+      for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+      {
+        analogRowsAreHeld = analogRowsAreHeld || (meterAnalogRows[m].Count > 0) || (meterDaysRows[m].Count > 0);
+      }
+
+      bool uploadIsDue = analogRowsAreHeld || rollupHasToBeSent || onOffFlushIsDue || healthFlushIsDue;
+      if (uploadIsDue)
+      {
+        bool uploadIsUrgent = isLast15SecondsOfDay || onOffDataContainer.TransitionsHaveToBeFlushed(dateTimeUTCNow, ON_OFF_TRANSITION_RING_SIZE - 2, UINT32_MAX);
+        uploadIsDue = powerModeManager.UploadIsAllowed(uploadIsUrgent);
+        if (uploadIsDue && powerModeManager.IsLowPower())
+        {
+          // All held analog rows, buffered switch events and health rows go with the burst
+          onOffFlushIsDue = onOffDataContainer.TransitionsHaveToBeFlushed(dateTimeUTCNow, 1, ON_OFF_FLUSH_SECONDS);
+          healthFlushIsDue = healthRowCount > 0;
+        }
+        else
+        {
+          onOffFlushIsDue = onOffFlushIsDue && uploadIsDue;
+          healthFlushIsDue = healthFlushIsDue && uploadIsDue;
+        }
+      }
+
       // Check if something is to do: send analog data ? send On/Off-Data ? Handle EndOfDay stuff ?
       //if (false)
-      if (dataContainerAnalogViessmann01.hasToBeSent() || dataContainer.hasToBeSent() || onOffDataContainer.One_hasToBeBeSent(localTime) || isLast15SecondsOfDay)
+      if (uploadIsDue || isLast15SecondsOfDay)
       {     
-        //Create some buffer
-        char sampleTime[25] {0};    // Buffer to hold sampletime        
-        char strData[100] {0};          // Buffer to hold display message
-        
-        char EtagBuffer[50] {0};    // Buffer to hold returned Etag
-
-        // Create az_span to hold partitionkey
-        char partKeySpan[25] {0};
-        size_t partitionKeyLength = 0;
-        az_span partitionKey = AZ_SPAN_FROM_BUFFER(partKeySpan);
-        
-        // Create az_span to hold rowkey
-        char rowKeySpan[25] {0};
-        size_t rowKeyLength = 0;
-        az_span rowKey = AZ_SPAN_FROM_BUFFER(rowKeySpan);
+        if (uploadIsDue)
+        {
+          powerModeManager.BeginUploads();
+        }
+        #pragma region Send the held analog rows of Viessmann and of the meters
+        if (uploadIsDue)
+        {
+          sendAnalogRows(&viAnalogRows, viessmAnalogTableName_01);
+          for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+          {
+            String daysTableName = meterPipelines[m] ->TableName;
+            daysTableName += "Days";
+            sendAnalogRows(&meterAnalogRows[m], meterPipelines[m] ->TableName);
+            sendAnalogRows(&meterDaysRows[m], daysTableName.c_str());
+          }
+        }
+        #pragma endregion
         
-        #pragma region if (dataContainerAnalogViessmann01.hasToBeSent())
-        if (dataContainerAnalogViessmann01.hasToBeSent())   // have to send analog values read from Viessmann ?
-        {         
-          // Retrieve edited sample values from container         
-          SampleValueSet sampleValueSet = dataContainerAnalogViessmann01.getCheckedSampleValues(dateTimeUTCNow, true);
-          //Serial.printf("Got checked Sample values\n");      
-          createSampleTime(sampleValueSet.LastUpdateTime, timeZoneOffsetUTC, (char *)sampleTime);
-          // Define name of the table (arbitrary name + actual year, like: AnalogTestValues2020)         
-          String augmentedAnalogTableName = viessmAnalogTableName_01; 
-          if (augmentTableNameWithYear)
+        #pragma region Rollups: if a hour or day is completed, send its row to the ...Hours and ...Days tables
+        // The rows of completed periods wait for the next burst like the analog rows
+        #if ANALOG_SENSORS_SEND_ROLLUPS == 1
+        if (uploadIsDue)
+        {
+          sendRollupRow(&analogRollupViessmann01, RollupPeriod::Hour, viessmAnalogTableName_01, timeZoneOffsetUTC);
+          sendRollupRow(&analogRollupViessmann01, RollupPeriod::Day, viessmAnalogTableName_01, timeZoneOffsetUTC);
+          for (int m = 0; m < METER_PIPELINES_COUNT; m++)
           {
-            // RoSchmi changed 10.07.2024 to resolve issue 1         
-            //augmentedAnalogTableName += (dateTimeUTCNow.year());
-            augmentedAnalogTableName += (localTime.year()); 
-          }         
-          // Create Azure Storage Table if table doesn't exist
-          if (localTime.year() != dataContainerAnalogViessmann01.Year)    // if new year
-          {           
-            az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogTableName.c_str());
-            
-            Serial.printf("\r\nCreate Table: Statuscode: %s\n", ((String)respCode).c_str());
-
-            if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
+            // The ...Days table of the meters holds the day consumption (see holdMeterRows())
+            // T_1 of the meters is stored with one shifted decimal place
+            if (meterPipelines[m] ->IsActive)
             {
-              dataContainerAnalogViessmann01.Set_Year(localTime.year());                   
+              sendRollupRow(&meterPipelines[m] ->Rollup, RollupPeriod::Hour, meterPipelines[m] ->TableName, timeZoneOffsetUTC, 10.0f);
             }
-            else
-            {
-              // Reset board if not successful
-             
-             //SCB_AIRCR = 0x05FA0004;             
-            }                     
           }
-          
-          // Create an Array of (here) 5 Properties
-          // Each Property consists of the Name, the Value and the Type (here only Edm.String is supported)
+        }
+        #endif
+        #pragma endregion
 
-          // Besides PartitionKey and RowKey we have 5 properties to be stored in a table row
-          // (SampleTime and 4 samplevalues)
-          const size_t analogPropertyCount = 5;
-          EntityProperty AnalogPropertiesArray[analogPropertyCount];
-         
-          #if ANALOG_SENSORS_USE_AVERAGE == 1
-            AnalogPropertiesArray[0] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) sampleTime, (char *)"Edm.String");
-            AnalogPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"T_1", (char *)floToStr(sampleValueSet.SampleValues[0].AverageValue).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[2] = (EntityProperty)TableEntityProperty((char *)"T_2", (char *)floToStr(sampleValueSet.SampleValues[1].AverageValue).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[3] = (EntityProperty)TableEntityProperty((char *)"T_3", (char *)floToStr(sampleValueSet.SampleValues[2].AverageValue).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[4] = (EntityProperty)TableEntityProperty((char *)"T_4", (char *)floToStr(sampleValueSet.SampleValues[3].AverageValue).c_str(), (char *)"Edm.String");         
-          #else
-            AnalogPropertiesArray[0] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) sampleTime, (char *)"Edm.String");
-            AnalogPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"T_1", (char *)floToStr(sampleValueSet.SampleValues[0].Value).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[2] = (EntityProperty)TableEntityProperty((char *)"T_2", (char *)floToStr(sampleValueSet.SampleValues[1].Value).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[3] = (EntityProperty)TableEntityProperty((char *)"T_3", (char *)floToStr(sampleValueSet.SampleValues[2].Value).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[4] = (EntityProperty)TableEntityProperty((char *)"T_4", (char *)floToStr(sampleValueSet.SampleValues[3].Value).c_str(), (char *)"Edm.String");
+        #pragma region if (onOffFlushIsDue || isLast15SecondsOfDay)
+        // Now test if Send On/Off values or End of day stuff?
+        if (onOffFlushIsDue || isLast15SecondsOfDay)
+        {
+          #if SERIAL_PRINT == 1
+          Serial.println("On/Off events have to be sent");
           #endif
-         
-          // Create the PartitionKey (special format)
-          makePartitionKey(analogTablePartPrefix, augmentPartitionKey, localTime, partitionKey, &partitionKeyLength);
-          partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
-         
-          // Create the RowKey (special format)        
-          makeRowKey(localTime, rowKey, &rowKeyLength);          
-          rowKey = az_span_slice(rowKey, 0, rowKeyLength);
-          
-          
-                    
-          // Create TableEntity consisting of PartitionKey, RowKey and the properties named 'SampleTime', 'T_1', 'T_2', 'T_3' and 'T_4'
-          AnalogTableEntity analogTableEntity(partitionKey, rowKey, az_span_create_from_str((char *)sampleTime),  AnalogPropertiesArray, analogPropertyCount);
-          
-          #if SERIAL_PRINT == 1
-            Serial.printf("Trying to insert %u \r\n", insertCounterApiAnalogTable01);
-            Serial.printf("Analog Table Name: %s \r\n\n", (const char *)augmentedAnalogTableName.c_str()); 
-          #endif
-             
-          // Keep track of tries to insert and check for memory leak
-          insertCounterApiAnalogTable01++;
 
-          // RoSchmi, Todo: event. include code to check for memory leaks here
-
-          // Store Entity to Azure Cloud   
-          __unused az_http_status_code insertResult =  insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogTableName.c_str(), analogTableEntity, (char *)EtagBuffer);
-        }
-        #pragma endregion
-        
-        #pragma region if (dataContainer.hasToBeSent())
-        if (dataContainer.hasToBeSent())   // have to send analog values read by Device (e.g. noise)?
-        {         
-          Serial.println(F("\n###### AiOnTheEdge dataContainer has to be sent to Azure\n"));        
-          // Retrieve edited sample values from container
-          SampleValueSet sampleValueSet = dataContainer.getCheckedSampleValues(dateTimeUTCNow, true);
-          // RoSchmi for debugging
-          volatile float valueOfFirstLine = sampleValueSet.SampleValues[0].Value;
-          if (valueOfFirstLine > 99.9)
-          {
-            Serial.printf("Value of T_1: %.1f\n", valueOfFirstLine);
-          }
-          
-          createSampleTime(sampleValueSet.LastUpdateTime, timeZoneOffsetUTC, (char *)sampleTime);
+          OnOffSampleValueSet onOffValueSet = onOffDataContainer.GetOnOffValueSet();
           
-          // Define name of the table (arbitrary name + actual year, like: AnalogTestValues2020)
-          String augmentedAnalogTableName = analogTableName;
-          String augmentedAnalogDaysTableName = analogTableName;
-          augmentedAnalogDaysTableName += "Days";
-          if (augmentTableNameWithYear)
+          for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)    // Do for 4 OnOff-Tables  
           {
-            
-            augmentedAnalogTableName += (localTime.year());
-            augmentedAnalogDaysTableName += (localTime.year());
-          }
-          
-          // Create Azure Storage Tables if tables don't exist
-          if (localTime.year() != dataContainer.Year)    // if new year          
-          {  
-            az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogTableName.c_str());
-                     
-            if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
-            {
-              dataContainer.Set_Year(localTime.year());                   
-            }
-            else
-            {
-              // eventually reset board if not successful                         
-            }
-            // Create a second table for consumption of days
-            respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogDaysTableName.c_str());
-            if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
-            {
-              dataContainer.Set_Year(localTime.year());                   
-            }
-            else
+            // End of day: if the sensor is 'on', an Off-event (first round) and an On-event (next round) are inserted
+            // The RowKeys of the two events are different, since the events of a sensor are at least one second apart
+            if (isLast15SecondsOfDay && !onOffValueSet.OnOffSampleValues[i].dayIsLocked)
             {
-              // eventually reset board if not successful                         
+              if (onOffValueSet.OnOffSampleValues[i].actState == true)              
+              {               
+                onOffDataContainer.Set_ResetToOnIsNeededFlag(i, true);                 
+                onOffDataContainer.SetNewOnOffValue(i, onOffValueSet.OnOffSampleValues[i].inputInverter ? true : false, dateTimeUTCNow, timeZoneOffsetUTC);
+              }
+              else
+              {              
+                if (onOffValueSet.OnOffSampleValues[i].resetToOnIsNeeded)
+                {                  
+                  onOffDataContainer.Set_DayIsLockedFlag(i, true);
+                  onOffDataContainer.Set_ResetToOnIsNeededFlag(i, false);
+                  onOffDataContainer.SetNewOnOffValue(i, onOffValueSet.OnOffSampleValues[i].inputInverter ? false : true, dateTimeUTCNow, timeZoneOffsetUTC);
+                }                 
+              }              
             }
-          }         
-          // Create an Array of (here) 5 Properties
-          // Each Property consists of the Name, the Value and the Type (here only Edm.String is supported)
-
-          // Besides PartitionKey and RowKey we have 5 properties to be stored in a table row
-          // (SampleTime and 4 samplevalues)
-          const size_t analogPropertyCount = 5;
-          EntityProperty AnalogPropertiesArray[analogPropertyCount];
-          AnalogPropertiesArray[0] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) sampleTime, (char *)"Edm.String");
-
-          // #if ANALOG_SENSORS_USE_AVERAGE == 1  makes no sense here
-          // RoSchmi
-          // 999.9 is not divided by 10 as 999.9 has a special meaning
-          //volatile float handledValue = sampleValueSet.SampleValues[0].Value == 999.9 ? 999.9 : sampleValueSet.SampleValues[0].Value / 10;
-          
-          float roundedMagicNumberInvalid = round((float)MAGIC_NUMBER_INVALID * 10) / 10;
-
-          volatile float handledValue = nearlyEqualFloat(roundedMagicNumberInvalid, sampleValueSet.SampleValues[0].Value, 0.0001f) ? roundedMagicNumberInvalid : sampleValueSet.SampleValues[0].Value / 10;
-          
-          //volatile float handledValue = round(sampleValueSet.SampleValues[0].Value * 10) / 10;
-          
-          if (handledValue == roundedMagicNumberInvalid)
-          {
-            Serial.println("handled Value was 999.9");
-          }
-          AnalogPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"T_1", (char *)floToStr(handledValue).c_str(), (char *)"Edm.String");
-         
-          //AnalogPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"T_1", (char *)floToStr(sampleValueSet.SampleValues[0].Value / 10).c_str(), (char *)"Edm.String");
-          AnalogPropertiesArray[2] = (EntityProperty)TableEntityProperty((char *)"T_2", (char *)floToStr(sampleValueSet.SampleValues[1].Value).c_str(), (char *)"Edm.String");
-          AnalogPropertiesArray[3] = (EntityProperty)TableEntityProperty((char *)"T_3", (char *)floToStr(sampleValueSet.SampleValues[2].Value).c_str(), (char *)"Edm.String");
-          AnalogPropertiesArray[4] = (EntityProperty)TableEntityProperty((char *)"T_4", (char *)floToStr(sampleValueSet.SampleValues[3].Value).c_str(), (char *)"Edm.String");
-          
-          // Create the PartitionKey (special format)
-          makePartitionKey(analogTablePartPrefix, augmentPartitionKey, localTime, partitionKey, &partitionKeyLength);
-          partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
-
-          // Create the RowKey (special format)        
-          makeRowKey(localTime, rowKey, &rowKeyLength);
-          
-          rowKey = az_span_slice(rowKey, 0, rowKeyLength);
-  
-          // Create TableEntity consisting of PartitionKey, RowKey and the properties named 'SampleTime', 'T_1', 'T_2', 'T_3' and 'T_4'
-          AnalogTableEntity analogTableEntity(partitionKey, rowKey, az_span_create_from_str((char *)sampleTime),  AnalogPropertiesArray, analogPropertyCount);
-          
-          #if SERIAL_PRINT == 1
-            Serial.printf("Trying to insert %u \r\n", insertCounterAnalogTable);
-            Serial.printf("Analog Table Name: %s \r\n\n", (const char *)augmentedAnalogTableName.c_str()); 
-          #endif
-             
-          // Keep track of tries to insert and check for memory leak
-          insertCounterAnalogTable++;
-
-          // RoSchmi, Todo: event. include code to check for memory leaks here
 
-          // Store Entity to Azure Cloud
-             
-          __unused az_http_status_code insertResult =  insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogTableName.c_str(), analogTableEntity, (char *)EtagBuffer);
-          
-          // have to write new row in ...Days Table
-          if (maxLastDayGasConsumption.isValid)
-          {
-            
-            // Create the PartitionKey (special format)          
-            TimeSpan oneDay(1,0,0,0);
-            // make PartitionKey, correct for the last day
-            makePartitionKey(analogTablePartPrefix, augmentPartitionKey, localTime.operator-(oneDay), partitionKey, &partitionKeyLength);
-            partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
-
-            // Create the RowKey (special format)
-            // make RowKey, correct for the last day
-            //TimeSpan oneSecond(0,0,0,1);
-            int offsetHours = timeZoneOffsetUTC / 60;
-            int offsetMinutes = timeZoneOffsetUTC % 60; 
-            TimeSpan spanOffsetUtc(0, offsetHours, offsetMinutes, 0);
-            TimeSpan spanToEndOfDay(0,23,59,59);
-            
-            //String todayDate = localTime.timestamp(DateTime::TIMESTAMP_DATE);
-            //DateTime beginOfToday(todayDate.c_str());
-
-            makeRowKey(localTime, rowKey, &rowKeyLength);
-            rowKey = az_span_slice(rowKey, 0, rowKeyLength);
-            
-            String SecondToLastUpdateDate = sampleValueSet.SecondToLastUpdateTime.timestamp(DateTime::TIMESTAMP_DATE);
-            //todayDate = sampleValueSet.LastUpdateTime.timestamp(DateTime::TIMESTAMP_DATE);
-            
-
-            DateTime startOfSecondToLastUpdateDate(SecondToLastUpdateDate.c_str());
-
-            
-            //createSampleTime(startOfToday, timeZoneOffsetUTC, (char *)sampleTime);
-            
-            float dayConsumption = maxLastDayGasConsumption.dayConsumption / 10;
-            float endOfDayTotalConsumption = gasmeterBaseValueOffsetInt + (maxLastDayGasConsumption.totalConsumption / 10);
-            
-            String dayConsumptionStringDecPoint = floToStr(dayConsumption, '.');
-            String dayConsumptionStringDecKomma = floToStr(dayConsumption, ',');
-
-            createSampleTime((startOfSecondToLastUpdateDate.operator-(spanOffsetUtc)).operator+(spanToEndOfDay), timeZoneOffsetUTC, (char *)sampleTime, SampleTimeFormatOpt::FORMAT_DATE_GER);        
-            AnalogPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"T_1", (char *) sampleTime, (char *)"Edm.String");
-            
-            AnalogPropertiesArray[2] = (EntityProperty)TableEntityProperty((char *)"T_2", (char *)dayConsumptionStringDecPoint.c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[3] = (EntityProperty)TableEntityProperty((char *)"T_3", (char *)floToStr(endOfDayTotalConsumption).c_str(), (char *)"Edm.String");
-            AnalogPropertiesArray[4] = (EntityProperty)TableEntityProperty((char *)"T_4", (char *)dayConsumptionStringDecKomma.c_str(), (char *)"Edm.String");
-          
-
-            createSampleTime((startOfSecondToLastUpdateDate.operator-(spanOffsetUtc)).operator+(spanToEndOfDay), timeZoneOffsetUTC, (char *)sampleTime, SampleTimeFormatOpt::FORMAT_FULL_1);
-            AnalogPropertiesArray[0] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) sampleTime, (char *)"Edm.String");
-            
-            maxLastDayGasConsumption.isValid = false;
-            maxLastDayGasConsumption.totalConsumption = 0.0f;
-            maxLastDayGasConsumption.dayConsumption = 0.0f;
-            
-            // Create TableEntity consisting of PartitionKey, RowKey and the properties named 'SampleTime', 'T_1', 'T_2', 'T_3' and 'T_4'
-            AnalogTableEntity analogTableEntity(partitionKey, rowKey, az_span_create_from_str((char *)sampleTime),  AnalogPropertiesArray, analogPropertyCount);
-            
-            az_http_status_code insertResult =  insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogDaysTableName.c_str(), analogTableEntity, (char *)EtagBuffer);
-            volatile int dummy = 0;
-            if (insertResult == AZ_HTTP_STATUS_CODE_ACCEPTED)
-            {
-              dummy = 1;
-            }
-            else
+            // The buffered events of all tables are sent, when one table reached the threshold
+            if (onOffFlushIsDue)
             {
-              dummy = 2;
+              sendOnOffTransitions(i, localTime);
             }
-
-          }
+          }               
         }
         #pragma endregion
-        
-        #pragma region if (onOffDataContainer.One_hasToBeBeSent(localTime) || isLast15SecondsOfDay)
-        // Now test if Send On/Off values or End of day stuff?
-        if (onOffDataContainer.One_hasToBeBeSent(localTime) || isLast15SecondsOfDay)
-        {
-          //Serial.println(F("..."));
-          #if SERIAL_PRINT == 1
-          Serial.println("One On/Off Value has to be sent");
-          #endif
 
-          OnOffSampleValueSet onOffValueSet = onOffDataContainer.GetOnOffValueSet();
-          
-          for (int i = 0; i < 4; i++)    // Do for 4 OnOff-Tables  
-          {
-            DateTime lastSwitchTimeDate = DateTime(onOffValueSet.OnOffSampleValues[i].LastSwitchTime.year(), 
-                                                onOffValueSet.OnOffSampleValues[i].LastSwitchTime.month(), 
-                                                onOffValueSet.OnOffSampleValues[i].LastSwitchTime.day());
-
-            DateTime actTimeDate = DateTime(localTime.year(), localTime.month(), localTime.day());
-            
-            //RoSchmi
-            if (onOffValueSet.OnOffSampleValues[i].hasToBeSent || ((onOffValueSet.OnOffSampleValues[i].actState == true) &&  (lastSwitchTimeDate.operator!=(actTimeDate))))
-            
-            //if (false)
-            {
-              if (onOffValueSet.OnOffSampleValues[i].hasToBeSent)
-              {
-                onOffDataContainer.Reset_hasToBeSent(i);     
-                EntityProperty OnOffPropertiesArray[5];
-               
-                TimeSpan  onTime = onOffValueSet.OnOffSampleValues[i].OnTimeDay;
-                if (lastSwitchTimeDate.operator!=(actTimeDate))
-                {
-                  onTime = TimeSpan(0);                 
-                  onOffDataContainer.Set_OnTimeDay(i, onTime);
-
-                  if (onOffValueSet.OnOffSampleValues[i].actState == true)
-                  {
-                    onOffDataContainer.Set_LastSwitchTime(i, actTimeDate);
-                  }
-              
-                }
-                          
-              char OnTimeDay[15] = {0};
-              sprintf(OnTimeDay, "%03i-%02i:%02i:%02i", onTime.days(), onTime.hours(), onTime.minutes(), onTime.seconds());
-              createSampleTime(dateTimeUTCNow, timeZoneOffsetUTC, (char *)sampleTime);
-
-              // Tablenames come from the onOffValueSet, here usually the tablename is augmented with the actual year
-              String augmentedOnOffTableName = onOffValueSet.OnOffSampleValues[i].tableName;
-              if (augmentTableNameWithYear)
-              {               
-                augmentedOnOffTableName += (localTime.year()); 
-              }
-
-              // Create table if table doesn't exist
-              if (localTime.year() != onOffValueSet.OnOffSampleValues[i].Year)
-              {
-                 az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedOnOffTableName.c_str());
-                 
-                 if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
-                 {
-                    onOffDataContainer.Set_Year(i, localTime.year());
-                 }
-                 else
-                 {
-                    delay(3000);
-                     //Reset Teensy 4.1
-                    //SCB_AIRCR = 0x05FA0004;      
-                 }
-              }
-
-              //RoSchmi
-              //Serial.println(F("\nDidn't need to create Table\n"));
- 
-              TimeSpan TimeFromLast = onOffValueSet.OnOffSampleValues[i].TimeFromLast;
-
-              char timefromLast[15] = {0};
-              sprintf(timefromLast, "%03i-%02i:%02i:%02i", TimeFromLast.days(), TimeFromLast.hours(), TimeFromLast.minutes(), TimeFromLast.seconds());
-                         
-              size_t onOffPropertyCount = 5;
-              OnOffPropertiesArray[0] = (EntityProperty)TableEntityProperty((char *)"ActStatus", onOffValueSet.OnOffSampleValues[i].outInverter ? (char *)(onOffValueSet.OnOffSampleValues[i].actState ? "On" : "Off") : (char *)(onOffValueSet.OnOffSampleValues[i].actState ? "Off" : "On"), (char *)"Edm.String");
-              OnOffPropertiesArray[1] = (EntityProperty)TableEntityProperty((char *)"LastStatus", onOffValueSet.OnOffSampleValues[i].outInverter ? (char *)(onOffValueSet.OnOffSampleValues[i].lastState ? "On" : "Off") : (char *)(onOffValueSet.OnOffSampleValues[i].lastState ? "Off" : "On"), (char *)"Edm.String");
-              OnOffPropertiesArray[2] = (EntityProperty)TableEntityProperty((char *)"OnTimeDay", (char *) OnTimeDay, (char *)"Edm.String");
-              OnOffPropertiesArray[3] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) sampleTime, (char *)"Edm.String");
-              OnOffPropertiesArray[4] = (EntityProperty)TableEntityProperty((char *)"TimeFromLast", (char *) timefromLast, (char *)"Edm.String");
-          
-              // Create the PartitionKey (special format)
-              makePartitionKey(onOffTablePartPrefix, augmentPartitionKey, localTime, partitionKey, &partitionKeyLength);
-              partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
-              
-              // Create the RowKey (special format)            
-              makeRowKey(localTime, rowKey, &rowKeyLength);
-              
-              rowKey = az_span_slice(rowKey, 0, rowKeyLength);
-  
-              // Create TableEntity consisting of PartitionKey, RowKey and the properties named 'SampleTime', 'T_1', 'T_2', 'T_3' and 'T_4'
-              OnOffTableEntity onOffTableEntity(partitionKey, rowKey, az_span_create_from_str((char *)sampleTime),  OnOffPropertiesArray, onOffPropertyCount);
-          
-              onOffValueSet.OnOffSampleValues[i].insertCounter++;
-                    
-              // Serial.printf("OnOff Table Name: %s \r\n\n", (const char *)augmentedOnOffTableName.c_str());
-              // Store Entity to Azure Cloud   
-             __unused az_http_status_code insertResult =  insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedOnOffTableName.c_str(), onOffTableEntity, (char *)EtagBuffer);
-              
-              delay(1000);     // wait at least 1 sec so that two uploads cannot have the same RowKey
-
-              break;          // Send only one in each round of loop
-              }
-              else
-              {
-                if (isLast15SecondsOfDay && !onOffValueSet.OnOffSampleValues[i].dayIsLocked)
-                {
-                  if (onOffValueSet.OnOffSampleValues[i].actState == true)              
-                  {               
-                    onOffDataContainer.Set_ResetToOnIsNeededFlag(i, true);                 
-                    onOffDataContainer.SetNewOnOffValue(i, onOffValueSet.OnOffSampleValues[i].inputInverter ? true : false, dateTimeUTCNow, timeZoneOffsetUTC);
-                    delay(1000);   // because we don't want to send twice in the same second 
-                    break;
-                  }
-                else
-                {              
-                  if (onOffValueSet.OnOffSampleValues[i].resetToOnIsNeeded)
-                  {                  
-                    onOffDataContainer.Set_DayIsLockedFlag(i, true);
-                    onOffDataContainer.Set_ResetToOnIsNeededFlag(i, false);
-                    onOffDataContainer.SetNewOnOffValue(i, onOffValueSet.OnOffSampleValues[i].inputInverter ? false : true, dateTimeUTCNow, timeZoneOffsetUTC);
-                    break;
-                  }                 
-                }              
-              }
-              } 
-            }                                
-          }               
+        if (healthFlushIsDue)
+        {
+          sendHealthRows();
+        }
+        if (uploadIsDue)
+        {
+          powerModeManager.EndUploads();
         }
-        #pragma endregion       
       }
       #pragma endregion          
   } 
+  taskMonitor.EndWork(loopTaskId);
 }  // end of Loop()
 #pragma endregion
 
 
-#pragma region Function ReadAnalogSensorStruct_01(int pSensorIndex)
-ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
+#pragma region Function ReadAnalogSensorStruct_01(MeterPipeline * pPipeline, int pSensorIndex)
+ValueStruct ReadAnalogSensorStruct_01(MeterPipeline * pPipeline, int pSensorIndex)
 { 
   ValueStruct returnValueStruct = { 
       .displayValue = (float)MAGIC_NUMBER_INVALID,
@@ -2606,6 +2688,8 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
 
   char consumption[12] = {'\0'};
 
+  DataContainerWio * meterContainer = pPipeline ->Container;
+
   switch(pSensorIndex)
   {
       case 0:
@@ -2617,11 +2701,11 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
 
         AiOnTheEdgeApiSelection::Feature selectedFeature;
         
-        #pragma region  (is FirstGasmeterRead)
-        if (isFirstGasmeterRead)
+        #pragma region  (is FirstRead of this meter)
+        if (pPipeline ->IsFirstRead)
         {
           // Read raw instead of value
-          selectedFeature = ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, &gasmeterApiAccount, (const char *)"raw", gasmeterApiSelectionPtr);                  
+          selectedFeature = ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, pPipeline, (const char *)"raw");                  
           char preValue[12] = {'\0'};
                
           strncpy(preValue, (const char *)selectedFeature.value, sizeof(preValue) -1);
@@ -2629,159 +2713,53 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
           
           //Serial.printf("Raw-value read was: %s\n", preValue);
           
-          if (strcmp((char *)preValue, (char *)"999.9") != 0)
+          // The pre value is set by the task of the meter, the first read ends with its event (takeOverPreValue())
+          if ((strcmp((char *)preValue, (char *)"999.9") != 0) && !pPipeline ->PreValueIsPending)
           {
             float preValueFloat = atof(preValue);
-            float preValueFloatMinus = preValueFloat - 0.1f;
-            snprintf(preValue, sizeof(preValue), "%.2f", preValueFloatMinus);             
-            t_httpCode httpResponse = setAiPreValueViaRestApi((const char*)"dummyCaCert", &gasmeterApiAccount, (const char *)preValue);
-            if (httpResponse == t_http_codes::HTTP_CODE_OK)
+            AcquisitionCommand command;
+            command.Source = meterSource(pPipeline);
+            snprintf(command.PreValue, sizeof(command.PreValue), "%.2f", preValueFloat - 0.1f);
+            command.PostedMicros = micros();
+            if (taskMonitor.Send(meterReaders[command.Source - 1].CommandQueueId, &command))
             {
-              isFirstGasmeterRead = false;
-
-              //if (true)
-              if (!LittleFS.exists(PERSIST_FILE))
-              {
-                // Create file if not existing               
-                strcpy(first_Reading.localTimestamp, (const char*)localTime.timestamp().c_str());
-                first_Reading.timeZoneOffsetUTC = myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;                
-                first_Reading.gas_DayBaseValue = preValueFloat * decShiftFactor;
-                first_Reading.gas_overflowCount = 0;
-                first_Reading.water_DayBaseValue = 0;
-                first_Reading.water_overflowCount = 0;
-                first_Reading.checksum = calcChecksum( (uint8_t*) &first_Reading, sizeof(first_Reading) - sizeof(first_Reading.checksum) );                   
-                File file = FileFS.open(PERSIST_FILE, "w");
-                if (file)
-                {
-                  file.write((uint8_t*) &first_Reading, sizeof(first_Reading));
-                  file.close();
-                }                
-              }  // End of creating not existing PERSIST_FILE
-
-              File file = FileFS.open(PERSIST_FILE, "r");
-              // Set content of the struct to 0
-              memset((void *) &first_Reading,       0, sizeof(first_Reading));
-              if (file)
-              {
-                file.readBytes((char *) &first_Reading, sizeof(first_Reading));
-                file.close();
-                DateTime firstReadingDateTime((const char *)first_Reading.localTimestamp);
-                DateTime localTimeDateTime((const char *)localTime.timestamp().c_str());   // Created for debugging
-                
-                //Serial.printf("In: isFirstGasmeterRead, Dates: %s,  %s\n", (const char *)first_Reading.localTimestamp, (const char *)localTime.timestamp().c_str());
-                  
-                // if we have a new day --> write first_Reading, otherwise -->leave the old one
-                if (firstReadingDateTime.timestamp(DateTime::TIMESTAMP_DATE) != localTimeDateTime.timestamp(DateTime::TIMESTAMP_DATE))       
-                {
-                  Serial.println("Was new day");
-                  Serial.println("Presetting an writing new first_Reading values");
-                  strcpy(first_Reading.localTimestamp, (const char*)localTime.timestamp().c_str());
-                  first_Reading.timeZoneOffsetUTC = myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
-                  first_Reading.gas_DayBaseValue = preValueFloat * decShiftFactor;
-                  first_Reading.gas_overflowCount = 0;
-                  first_Reading.water_DayBaseValue = 0;
-                  first_Reading.water_overflowCount = 0;
-                  first_Reading.checksum = calcChecksum( (uint8_t*) &first_Reading, sizeof(first_Reading) - sizeof(first_Reading.checksum) );                   
-                  
-                  File file = FileFS.open(PERSIST_FILE, "w");
-                  if (file)
-                  {
-                    file.write((uint8_t*) &first_Reading, sizeof(first_Reading));                                
-                    file.close();
-                  }
-                  file = FileFS.open(PERSIST_FILE, "r");
-                  // Set content of the struct to 0
-                  memset((void *) &first_Reading,       0, sizeof(first_Reading));
-                  if (file)
-                  {
-                    file.readBytes((char *) &first_Reading, sizeof(first_Reading));                   
-                    file.close();
-                  }
-                }            
-              }
-              else
-              {
-                Serial.println("Error reading PERSIST_FILE");
-              }
-            }   // (httpResponse == t_http_codes::HTTP_CODE_OK)
+              pPipeline ->PreValueIsPending = true;
+              pPipeline ->PendingPreValue = preValueFloat;
+            }
           }   
         }
         #pragma endregion
-        else   // not FirstGasmeterRead
+        else   // not FirstRead
         {
-        #pragma region (is not FirstGasmeterRead)
-
-          selectedFeature = ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, &gasmeterApiAccount,(const char *)"value", gasmeterApiSelectionPtr);
-          // if we have a new day --> write first_Reading, otherwise -->leave the old one
-          DateTime storedFirstReadingDateTime((const char *)first_Reading.localTimestamp);
-          
-          
-          /******* for debugging */
-          GasmeterReadCounter++;   // to be deleted later
-          
-          TimeSpan diffDay(0,0,0,0);
-          TimeSpan oneDay(1,0,0,0);
-
-          if (GasmeterReadCounter == 1)
-          {
-            // diffDay = oneDay;     // normally has to be commented out
-          }
+        #pragma region (is not FirstRead of this meter)
 
-          /******* end for debugging */
-         
-          DateTime firstReadingDateTime = storedFirstReadingDateTime.operator-(diffDay); // commented, only for debugging
-          DateTime localTimeDateTime((const char *)localTime.timestamp().c_str());   // Created for debugging               
-          
-          //Serial.printf("In: is not FirstGasmeterRead, Dates: %s,  %s\n", (const char *)first_Reading.localTimestamp, (const char *)localTime.timestamp().c_str());
+          selectedFeature = ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, pPipeline, (const char *)"value");
+          // if we have a new day --> write DayBase, otherwise -->leave the old one
+          DateTime firstReadingDateTime;
+          DateTime::parse((const char *)pPipeline ->DayBase.localTimestamp, &firstReadingDateTime);
                   
-          // if new day (is not FirstGasmeterRead)
-          if (firstReadingDateTime.timestamp(DateTime::TIMESTAMP_DATE) != localTimeDateTime.timestamp(DateTime::TIMESTAMP_DATE))
+          // if new day (is not FirstRead)
+          if (firstReadingDateTime.daysSinceEpoch() != localTime.daysSinceEpoch())
           {
-             Serial.println("Was new day");
+            Serial.println("Was new day");
             strncpy(consumption, selectedFeature.value, sizeof(consumption));
             Serial.printf("Consumption: %s\n", (const char *)consumption);
-            Serial.printf("LastGasmeterReading: %.1f\n", LastGasmeterReading);
-            
-            float tempNumber = (float)MAGIC_NUMBER_INVALID;
+            Serial.printf("LastReading (%s): %.1f\n", pPipeline ->Label, pPipeline ->LastReading);
      
             if (isValidFloat(consumption) && !(nearlyEqualFloat(0.0, atof(consumption))))   
             {
-              maxLastDayGasConsumption.isValid = true;              
-              maxLastDayGasConsumption.dayConsumption = LastGasmeterDayConsumption;
-              maxLastDayGasConsumption.totalConsumption = LastGasmeterReading;
+              pPipeline ->MaxLastDay.isValid = true;              
+              pPipeline ->MaxLastDay.dayConsumption = pPipeline ->LastDayConsumption;
+              pPipeline ->MaxLastDay.totalConsumption = pPipeline ->LastReading;
               
-              Serial.println("Preset new first_Reading values");
-              tempNumber = atof(consumption);
-              strcpy(first_Reading.localTimestamp, (const char*)localTime.timestamp().c_str());
-              first_Reading.timeZoneOffsetUTC = myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
-              first_Reading.gas_DayBaseValue = LastGasmeterReading;              
-              first_Reading.gas_overflowCount = 0;
-              first_Reading.water_DayBaseValue = 0;
-              first_Reading.water_overflowCount = 0;
-              first_Reading.checksum = calcChecksum( (uint8_t*) &first_Reading, sizeof(first_Reading) - sizeof(first_Reading.checksum) );                   
-              
-              
-              Serial.printf("Setting gas_DayBaseValue to %.1f\n", LastGasmeterReading);
-              File file = FileFS.open(PERSIST_FILE, "w");
-              if (file)
-              {
-                file.write((uint8_t*) &first_Reading, sizeof(first_Reading));                                
-                file.close();
-              }
-              file = FileFS.open(PERSIST_FILE, "r");
-                // Set content of the struct to 0
-              memset((void *) &first_Reading,       0, sizeof(first_Reading));
-              if (file)
-              { 
-                file.readBytes((char *) &first_Reading, sizeof(first_Reading));                   
-                file.close();
-              }              
+              Serial.printf("Setting DayBaseValue to %.1f\n", pPipeline ->LastReading);
+              storeMeterDayBase(pPipeline, pPipeline ->LastReading);             
             }
             else
             { 
-              maxLastDayGasConsumption.isValid = false;
-              maxLastDayGasConsumption.totalConsumption = 0.0f;
-              maxLastDayGasConsumption.dayConsumption = 0.0f;
+              pPipeline ->MaxLastDay.isValid = false;
+              pPipeline ->MaxLastDay.totalConsumption = 0.0f;
+              pPipeline ->MaxLastDay.dayConsumption = 0.0f;
             }         
           }
         #pragma endregion         
@@ -2810,22 +2788,18 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
           Serial.printf("Value invalid (0.00) or could not be parsed to float: %s\n", consumption);
           tempNumber = (float)MAGIC_NUMBER_INVALID;
 
-          // handle ESP.restart if more than 3 invalid readings
-          Ai_01_Read_Errorcount++;
-          if (Ai_01_Read_Errorcount > 3)
+          // An invalid reading is rejected by the plausibility filter, the last
+          // valid value stays in the container. Formerly the board was rebooted here
+          pPipeline ->Plausibility.SetInvalid();
+          pPipeline ->ReadErrorCount++;
+          metrics.Increment(metricMeterReadErrors);
+          if (pPipeline ->ReadErrorCount == 4)
           {
             #if FLASH_LOGGING == 1
-              addLogEntry(LOG_FILE, "20", "More than 3 invalid readings", LOGGING_ENTRIES);
+              addLogEntry(localTime, "20", "More than 3 invalid readings");
             #endif
-            Serial.println("Rebooting, reading gasmeter failed 3 times");
-            ESP.restart();
-            while(true)
-            {
-              delay(500);
-            }
-          }
-          
-          Serial.println("Read value (2)");    
+            Serial.printf("Reading %s failed more than 3 times\n", pPipeline ->Label);
+          }   
         }
         
         // convert values near MAGIC_NUMBER_INVALID to MAGIC_NUMBER_INVALID  
@@ -2842,12 +2816,36 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
           return returnValueStruct;
         }
 
-        Ai_01_Read_Errorcount = 0;
+        pPipeline ->ReadErrorCount = 0;
+
+        // Check the reading against the last accepted reading, the maximal flow
+        // and the 'raw' and 'pre' values of the device (misread digits)
+        float rawNumber = isValidFloat(pPipeline ->Features[1].value) ? atof(pPipeline ->Features[1].value) : NAN;
+        float preNumber = isValidFloat(pPipeline ->Features[2].value) ? atof(pPipeline ->Features[2].value) : NAN;
+        float checkedNumber = tempNumber;
+        PlausibilityResult plausibility = pPipeline ->Plausibility.Check(tempNumber, rawNumber, preNumber, dateTimeUTCNow.unixtime(), &checkedNumber);
+        if (plausibility != PlausibilityResult::Accepted)
+        {
+          Serial.printf("%s reading %.3f: %s (last accepted: %.3f)\n", pPipeline ->Label, tempNumber, 
+                MeterPlausibilityFilter::ResultName(plausibility), pPipeline ->Plausibility.LastAcceptedValue);
+        }
+        if (!MeterPlausibilityFilter::IsUsable(plausibility))
+        {
+          // Rejected, the value is ignored in further process
+          return returnValueStruct;
+        }
+        #if FLASH_LOGGING == 1
+          if (plausibility == PlausibilityResult::Resynced)
+          {
+            addLogEntry(localTime, "21", "Meter resynced after rejects");
+          }
+        #endif
+        tempNumber = checkedNumber;
 
         // multply by 10, so that there remains 1 significant digit after decimal point
         sprintf(consumption, "%.1f", tempNumber * decShiftFactor);
-        LastGasmeterReading = atof((const char *)consumption);
-        returnValueStruct.unClippedValue = LastGasmeterReading;  
+        pPipeline ->LastReading = atof((const char *)consumption);
+        returnValueStruct.unClippedValue = pPipeline ->LastReading;  
         
         // remove leading digits, so that there are maximal 2 digits 
         // before decimal point for .displayValue
@@ -2857,7 +2855,7 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
         }
         returnValueStruct.displayValue = atof((const char *)consumption);
         
-        returnValueStruct.thisDayBaseValue = first_Reading.gas_DayBaseValue;
+        returnValueStruct.thisDayBaseValue = pPipeline ->DayBase.dayBaseValue;
         
         //#if SERIAL_PRINT == 1
            Serial.printf("\nDisplayValue: %.1f  UnClippedValue: %.1f\n", returnValueStruct.displayValue, returnValueStruct.unClippedValue);
@@ -2868,15 +2866,15 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
       case 1:    // Consumption this day
       {
         // Calculate Day-Consumption from BaseValue and UnClippedValue 
-        float copyBaseValue = dataContainer.SampleValues[0].BaseValue;
-        float copyUnClippedValue = dataContainer.SampleValues[0].UnClippedValue;
-        uint32_t LastSendTimeSeconds = dataContainer._lastSentTime.secondstime();
+        float copyBaseValue = meterContainer ->SampleValues[0].BaseValue;
+        float copyUnClippedValue = meterContainer ->SampleValues[0].UnClippedValue;
+        uint32_t LastSendTimeSeconds = meterContainer ->_lastSentTime.secondstime();
         uint32_t timeSinceLastSendSeconds = dateTimeUTCNow.secondstime() - LastSendTimeSeconds;
                  
         if (copyBaseValue <= copyUnClippedValue)
         {        
-          LastGasmeterDayConsumption = (copyUnClippedValue - copyBaseValue);
-          returnValueStruct.displayValue = LastGasmeterDayConsumption;
+          pPipeline ->LastDayConsumption = (copyUnClippedValue - copyBaseValue);
+          returnValueStruct.displayValue = pPipeline ->LastDayConsumption;
         }
         else
         {
@@ -2884,14 +2882,14 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
           int preDecimalPoint = (int)copyBaseValue;
           int oneMoreDigit =  pow(10,(int)log10(preDecimalPoint) + 1);
           
-            LastGasmeterDayConsumption = copyUnClippedValue + (oneMoreDigit - copyBaseValue);
+            pPipeline ->LastDayConsumption = copyUnClippedValue + (oneMoreDigit - copyBaseValue);
            
         
-          returnValueStruct.displayValue = LastGasmeterDayConsumption;
+          returnValueStruct.displayValue = pPipeline ->LastDayConsumption;
         }
               
         returnValueStruct.unClippedValue = copyUnClippedValue;
-        if (timeSinceLastSendSeconds > dataContainer.SendInterval.totalseconds() -3)
+        if (timeSinceLastSendSeconds > meterContainer ->SendInterval.totalseconds() -3)
         {                      
           Serial.printf("\nCase 1: Day-Consumption: %.1f\n", returnValueStruct.displayValue);
         }                      
@@ -2899,15 +2897,15 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
       break;
       case 2:   // rate
       {
-        uint32_t sendIntervalSeconds = dataContainer.SendInterval.totalseconds();
-        uint32_t LastSendTimeSeconds = dataContainer._lastSentTime.secondstime();       
+        uint32_t sendIntervalSeconds = meterContainer ->SendInterval.totalseconds();
+        uint32_t LastSendTimeSeconds = meterContainer ->_lastSentTime.secondstime();       
         
-        float copyLastSendUnClippedValue = dataContainer.SampleValues[0].LastSendUnClippedValue;
-        float copyUnClippedValue = dataContainer.SampleValues[0].UnClippedValue;                    
+        float copyLastSendUnClippedValue = meterContainer ->SampleValues[0].LastSendUnClippedValue;
+        float copyUnClippedValue = meterContainer ->SampleValues[0].UnClippedValue;                    
         uint32_t timeSinceLastSendSeconds = dateTimeUTCNow.secondstime() - LastSendTimeSeconds;
              
           // Only print the last messages
-          if (timeSinceLastSendSeconds > dataContainer.SendInterval.totalseconds() -3)
+          if (timeSinceLastSendSeconds > meterContainer ->SendInterval.totalseconds() -3)
           {
             Serial.printf("LastSendTime: %d Actual: %.d Diff: %d Interval: %d Remain %d\n", LastSendTimeSeconds,  
             dateTimeUTCNow.secondstime(), dateTimeUTCNow.secondstime() - LastSendTimeSeconds, sendIntervalSeconds, 
@@ -2941,7 +2939,7 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
         }
           // RoSchmi
           // Only print the last messages
-          if (timeSinceLastSendSeconds > dataContainer.SendInterval.totalseconds() -3)
+          if (timeSinceLastSendSeconds > meterContainer ->SendInterval.totalseconds() -3)
           {
             Serial.printf("LastSendValue: %.1f Actual: %.1f Diff: %.1f Seconds: %d\n", copyLastSendUnClippedValue, 
             copyUnClippedValue, copyUnClippedValue - copyLastSendUnClippedValue, timeSinceLastSendSeconds);  
@@ -2983,13 +2981,34 @@ ValueStruct ReadAnalogSensorStruct_01(int pSensorIndex)
 }
 #pragma endregion
 
-#pragma region Routine ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, * pRestApiAccount, const char* pSensorName, * pAiOnTheEdgeApiSelectionPtr)
-AiOnTheEdgeApiSelection::Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex, RestApiAccount * pRestApiAccount, const char* pSensorName, AiOnTheEdgeApiSelection * pAiOnTheEdgeApiSelectionPtr)
+#pragma region Function storeMeterDayBase(MeterPipeline * pPipeline, float pDayBaseValue)
+// Sets the base value of this day in the DayBase struct of the pipeline
+// and appends it to the journal of the meter states
+void storeMeterDayBase(MeterPipeline * pPipeline, float pDayBaseValue)
+{
+  MeterDayBase * dayBase = &pPipeline ->DayBase;
+  localTime.format_to(dayBase ->localTimestamp, sizeof(dayBase ->localTimestamp));
+  dayBase ->timeZoneOffsetUTC = myTimezone.utcIsDST(dateTimeUTCNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
+  dayBase ->dayBaseValue = pDayBaseValue;
+  dayBase ->overflowCount = 0;
+  dayBase ->checksum = 0;
+  
+  if (!meterStateStore.Put(pPipeline ->StateKey, dayBase, sizeof(MeterDayBase)))
+  {
+    Serial.printf("Error writing DayBase (%s)\n", pPipeline ->Label);
+  }
+}
+#pragma endregion
+
+#pragma region Routine ReadAiOnTheEdgeApi_Analog_01(pSensorIndex, * pPipeline, const char* pSensorName)
+AiOnTheEdgeApiSelection::Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex, MeterPipeline * pPipeline, const char* pSensorName)
 {
   // Use values read from the AiOnTheEdge Rest API
   // pSensorIndex determins the line chart (No. 0 to No. 3) to be displayed.
-  // pRestApiAccount contains the url and the scheme to be used in the http-request to get the desired data
+  // pPipeline contains the account (url and scheme to be used in the http-request), the selection and the sensor manager of the meter
   // pSensorName is the name of the feature to be selected (value, raw, error etc.) (see AiOnTheEdgeSelection.h)
+  // The features are read from the device by the task of the meter (when readInterval has expired),
+  // loop() copies them out of the event of the read, each read is taken once
 
   AiOnTheEdgeApiSelection::Feature returnFeature;
   returnFeature.idx = 0;
@@ -2999,59 +3018,18 @@ AiOnTheEdgeApiSelection::Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex,
   // Set value to MAGIC_NUMBER_INVALID. This value is ignored in the following process
   strncpy(returnFeature.value, (floToStr(MAGIC_NUMBER_INVALID)).c_str(), sizeof(returnFeature.value) - 1);
   
-  // Save lastReadTimeSeconds and readIntervalSeconds
-  int64_t tempLastReadTimeSeconds = pAiOnTheEdgeApiSelectionPtr -> lastReadTimeSeconds;
-  int32_t tempReadIntervalSeconds = pAiOnTheEdgeApiSelectionPtr ->readIntervalSeconds;
-  
-  // Only read features from AiOnTheEdgeDevice when readInterval has expired
-  
-  int64_t utcNowSecondsTime = (int64_t)dateTimeUTCNow.secondstime();
-   
-  int64_t remaining_Ai_Seconds = ((tempLastReadTimeSeconds + tempReadIntervalSeconds) - utcNowSecondsTime);
-  
-  //Serial.printf("(Ai) LastReadTime: %d Interval: %d Now: %d\n", (int32_t)tempLastReadTimeSeconds, tempReadIntervalSeconds,  (int32_t)utcNowSecondsTime);
-
-  Serial.printf("Remaining seconds (Ai): %d\n", (int32_t)remaining_Ai_Seconds);
-  
-  // if ReadInterval has expired, --> readJsonFromRestApi
-  if ((tempLastReadTimeSeconds + tempReadIntervalSeconds) < utcNowSecondsTime)  
-  {
-    char myUriEndpoint[50] = {0};
-    strncpy(myUriEndpoint, (const char *)(pRestApiAccount ->UriEndPointJson).c_str(), sizeof(myUriEndpoint) - 1);
-    
-    t_httpCode httpResponseCode = readJsonFromRestApi(myX509Certificate, pRestApiAccount, pAiOnTheEdgeApiSelectionPtr);   
-     
-    if (httpResponseCode > 0)
-    {
-      pAiOnTheEdgeApiSelectionPtr ->lastReadTimeSeconds = (int64_t)dateTimeUTCNow.secondstime();          
-    
-      if (httpResponseCode == t_http_codes::HTTP_CODE_OK)
-      {
-        //Serial.println("Success to read Features from Ai-On-The-Edge");       
-      }
-      else
-      {
-        Serial.printf("Failed to read Features: ResponseCode: %d\n", httpResponseCode); 
-        Serial.println((char*)bufferStorePtr);
-      }
-    }
-    else
-    {
-      Serial.printf("Failed reading from Ai-On-The-Edge-Device, httpCode: %d\n", httpResponseCode); 
-    }
-  }
- 
-  if (analogSensorMgr_Ai_01.HasToBeRead(pSensorIndex, dateTimeUTCNow, true))
+  if (pPipeline ->HasNewFeatures)
   {
+    pPipeline ->HasNewFeatures = false;
     for (int i = 0; i < AI_FEATURES_COUNT; i++)
     {       
-      if (strcmp((const char *)ai_features[i].name, pSensorName) == 0)
+      if (strcmp((const char *)pPipeline ->Features[i].name, pSensorName) == 0)
       {       
-        returnFeature = ai_features[i];
+        returnFeature = pPipeline ->Features[i];
 
-        Serial.printf("\nanalogSensorMgr_Ai_01: Value is used. Index: %d Value: %s\n", pSensorIndex, returnFeature.value);
+        Serial.printf("\n%s SensorMgr: Value is used. Index: %d Value: %s\n", pPipeline ->Label, pSensorIndex, returnFeature.value);
         
-        analogSensorMgr_Ai_01.SetReadTimeAndValues(pSensorIndex, dateTimeUTCNow, atof(returnFeature.value), 0.0f, MAGIC_NUMBER_INVALID);                         
+        pPipeline ->SensorMgr ->SetReadTimeAndValues(pSensorIndex, dateTimeUTCNow, atof(returnFeature.value), 0.0f, MAGIC_NUMBER_INVALID);                         
         break;
       }     
     } 
@@ -3060,45 +3038,46 @@ AiOnTheEdgeApiSelection::Feature ReadAiOnTheEdgeApi_Analog_01(int pSensorIndex,
 }
 #pragma endregion
 
-#pragma region Routine readJsonFromRestApi(pCaCert, *pRestApiAccount, *apiSelectionPtr)
-t_httpCode readJsonFromRestApi(X509Certificate pCaCert, RestApiAccount * pRestApiAccount , AiOnTheEdgeApiSelection * apiSelectionPtr)
+#pragma region Routine readJsonFromRestApi(pCaCert, *pReader, pLocalTime, outFeatures[])
+// Reads the features of a meter (called by the task of the meter), they are copied into outFeatures
+t_httpCode readJsonFromRestApi(X509Certificate pCaCert, MeterReader * pReader, DateTime pLocalTime, AiOnTheEdgeApiSelection::Feature outFeatures[])
 {
-  WiFiClient * selectedClient = pRestApiAccount ->UseHttps ? &secure_wifi_client : &plain_wifi_client;
+  MeterPipeline * pPipeline = pReader ->Pipeline;
+  RestApiAccount * pRestApiAccount = pPipeline ->Account;
+  AiOnTheEdgeApiSelection * apiSelectionPtr = pPipeline ->ApiSelection;
+  AiOnTheEdgeApiSelection::Feature * ai_features = outFeatures;
+
+  WiFiClient * selectedClient = pRestApiAccount ->UseHttps ? &pReader ->SecureClient : &pReader ->PlainClient;
   
   if (pRestApiAccount -> UseHttps && !(pRestApiAccount -> UseCaCert))
   {
-    secure_wifi_client.setInsecure();
+    pReader ->SecureClient.setInsecure();
   }
 
-  int64_t tempLastReadTimeSeconds = apiSelectionPtr ->lastReadTimeSeconds;
-  int32_t tempReadIntervalSeconds = apiSelectionPtr ->readIntervalSeconds;
-
   #if WORK_WITH_WATCHDOG == 1
       esp_task_wdt_reset();
   #endif
 
-  memset(bufferStorePtr, '\0', bufferStoreLength);
+  memset(pReader ->Buffer, '\0', sizeof(pReader ->Buffer));
 
   char url[70] = {'\0'};
   strncpy(url, (const char *)((pRestApiAccount -> UriEndPointJson).c_str()), sizeof(url) - 1);
   Serial.printf("readJsonFromRestApi: %s\n", (const char *)url);
   
-  AiOnTheEdgeClient aiOnTheEdgeClient(pRestApiAccount, (const char*)"dummyCaCert", httpPtr, selectedClient);
-
-  Serial.printf("\r\n(%u) ", loadGasMeterJsonCount);
-  Serial.printf("%i/%02d/%02d %02d:%02d \n", localTime.year(), 
-                                        localTime.month() , localTime.day(),
-                                        localTime.hour() , localTime.minute());
+  AiOnTheEdgeClient aiOnTheEdgeClient(pRestApiAccount, (const char*)"dummyCaCert", &pReader ->Http, selectedClient);
+  pReader ->Http.setConnectTimeout(METER_HTTP_TIMEOUT_MS);
+  pReader ->Http.setTimeout(METER_HTTP_TIMEOUT_MS);
+
+  Serial.printf("\r\n%s (%u) ", pPipeline ->Label, pPipeline ->LoadJsonCount);
+  Serial.printf("%i/%02d/%02d %02d:%02d \n", pLocalTime.year(), 
+                                        pLocalTime.month() , pLocalTime.day(),
+                                        pLocalTime.hour() , pLocalTime.minute());
    
-  
-  int64_t tempLast_Vi_ReadTimeSeconds = viessmannApiSelectionPtr_01 ->lastReadTimeSeconds;
-  int32_t temp_Vi_ReadIntervalSeconds = viessmannApiSelectionPtr_01 ->readIntervalSeconds;
-  
-  t_httpCode responseCode = aiOnTheEdgeClient.GetFeatures((const char *)url, bufferStorePtr, bufferStoreLength, apiSelectionPtr);
+  t_httpCode responseCode = aiOnTheEdgeClient.GetFeatures((const char *)url, pReader ->Buffer, sizeof(pReader ->Buffer), apiSelectionPtr);
   
   // Serial.printf("LastReadTime in Hex: %x\n", viessmannApiSelectionPtr_01 ->lastReadTimeSeconds);
   
-  loadGasMeterJsonCount++;
+  pPipeline ->LoadJsonCount++;
   
   if (responseCode == t_http_codes::HTTP_CODE_OK)
   {
@@ -3128,73 +3107,26 @@ t_httpCode readJsonFromRestApi(X509Certificate pCaCert, RestApiAccount * pRestAp
 }
 #pragma endregion
 
-#pragma region Routine ReadViessmannApi_Analog_01(pSensorIndex, const char* pSensorName, int pValueIndex, * pViessmannApiSelectionPtr)
-VI_Feature ReadViessmannApi_Analog_01(int pSensorIndex, const char* pSensorName, int pValueIndex, ViessmannApiSelection * pViessmannApiSelectionPtr)
+#pragma region Routine ReadViessmannApi_Analog_01(pSensorIndex)
+float ReadViessmannApi_Analog_01(int pSensorIndex)
 {
   // Use values read from the Viessmann API
-  // pSensorIndex determins the position (from 4). 
-  // pSensorName is the name of the feature (see ViessmannApiSelection.h)
- 
-  // preset a 'returnFeature' with value = MAGIC_NUMBER_INVALID (999.9)
-  // Save lastReadTimeSeconds and readIntervalSeconds
-  int64_t tempLastReadTimeSeconds = pViessmannApiSelectionPtr -> lastReadTimeSeconds;
-  int32_t tempReadIntervalSeconds = pViessmannApiSelectionPtr ->readIntervalSeconds;
- 
-  VI_Feature returnFeature;
-  strncpy(returnFeature.values[pValueIndex].value, (floToStr(MAGIC_NUMBER_INVALID)).c_str(), sizeof(returnFeature.values[pValueIndex].value) - 1);
-  
-  int64_t utcNowSecondsTime = (int64_t)dateTimeUTCNow.secondstime();
-  int64_t remaining_Vi_seconds = tempLastReadTimeSeconds + tempReadIntervalSeconds - utcNowSecondsTime;
-  
-  if (pSensorIndex == 0)
+  // pSensorIndex determins the position (from 4) and the feature (see viAnalogFeatureNames)
+  // The features are read from the cloud by the acquisition task (when readInterval has expired),
+  // loop() copies the values out of the event of the read (processAcquisitionEvents())
+  // Returns MAGIC_NUMBER_INVALID (999.9) when the sensor is not due or no value was read yet
+  if ((viAnalogValues[pSensorIndex][0] == '\0') || !analogSensorMgr_Vi_01.HasToBeRead(pSensorIndex, dateTimeUTCNow))
   {
-    Serial.printf("Remaining seconds to read (Vi): %d\n",  (int32_t)remaining_Vi_seconds);
-  }
-
-  // Only read features from the cloud when readInterval has expired
-  if ((tempLastReadTimeSeconds + tempReadIntervalSeconds) < utcNowSecondsTime) 
-  { 
-      Serial.println(F("########## Have to read Vi-Features #########\n"));
-      
-      t_httpCode httpCode = read_Vi_FeaturesFromApi(myX509Certificate, myViessmannApiAccountPtr, Data_0_Id, Gateways_0_Serial, Gateways_0_Devices_0_Id, pViessmannApiSelectionPtr);
-         
-      if (httpCode == t_http_codes::HTTP_CODE_OK)
-      {
-        pViessmannApiSelectionPtr ->lastReadTimeSeconds = utcNowSecondsTime;
-        
-        Serial.println(F("Succeeded to read Features from Viessmann Cloud\n"));
-        
-        //Serial.printf("OK-Vi-LastReadTime: %u dateTimeUTCNow: %u, Interval: %u\n", (uint32_t)pViessmannApiSelectionPtr ->lastReadTimeSeconds, dateTimeUTCNow.secondstime(), pViessmannApiSelectionPtr ->readIntervalSeconds); 
-      }
-      else
-      {
-        pViessmannApiSelectionPtr ->lastReadTimeSeconds = utcNowSecondsTime;
-         
-        Serial.println(F("Failed to read Features from Viessmann Cloud"));
-        Serial.printf("Else-LastReadTime: %u dateTimeUTCNow: %u, Interval: %u\n", (uint32_t)viessmannApiSelection_01.lastReadTimeSeconds, dateTimeUTCNow.secondstime(), (uint32_t)viessmannApiSelection_01.readIntervalSeconds); 
-        //Serial.println((char*)bufferStorePtr);
-       } 
+    return (float)MAGIC_NUMBER_INVALID;
   }
-  
-  if (analogSensorMgr_Vi_01.HasToBeRead(pSensorIndex, dateTimeUTCNow))
-  {     
-    //for (int i = 0; i < VI_FEATURES_COUNT; i++)
-    for (int i = 0; i < ViessmannApiSelection::NUM_INTERESTING_PROPERTIES; i++)
-    {       
-      if (strcmp((const char *)vi_features[i].name, pSensorName) == 0)
-      {
-        returnFeature = vi_features[i];
-        analogSensorMgr_Vi_01.SetReadTimeAndValues(pSensorIndex, dateTimeUTCNow, atof(returnFeature.values[pValueIndex].value), 0.0f, MAGIC_NUMBER_INVALID);           
-        break;
-      }
-    } 
-  } 
-  return returnFeature;
+  float value = atof(viAnalogValues[pSensorIndex]);
+  analogSensorMgr_Vi_01.SetReadTimeAndValues(pSensorIndex, dateTimeUTCNow, value, 0.0f, MAGIC_NUMBER_INVALID);
+  return value;
 }
 #pragma endregion
 
 #pragma region Routine read_Vi_FeaturesFromApi(...)
-t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount * pViessmannApiAccountPtr, const uint32_t data_0_id, const char * p_gateways_0_serial, const char * p_gateways_0_devices_0_id, ViessmannApiSelection * apiSelectionPtr)
+t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount * pViessmannApiAccountPtr, const uint32_t data_0_id, const char * p_gateways_0_serial, const char * p_gateways_0_devices_0_id, ViessmannApiSelection * apiSelectionPtr, DateTime pLocalTime)
 {
   WiFiClient * selectedClient = (pViessmannApiAccountPtr -> UseHttps) ? &secure_wifi_client : &plain_wifi_client;
   //Serial.printf("Have selected Client \n");
@@ -3214,17 +3146,19 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
   
   //ViessmannApiSelection * apiSelectionPtr = &tempViessmannApiSelection;
   
-  memset(bufferStorePtr, '\0', bufferStoreLength);
+  memset(acquisitionBufferPtr, '\0', acquisitionBufferLength);
   
   
-  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  httpPtr, selectedClient, bufferStorePtr);
+  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  acquisitionHttpPtr, selectedClient, acquisitionBufferPtr);
   
   Serial.printf("\r\n(%u) ",loadViFeaturesCount);
-  Serial.printf("%i/%02d/%02d %02d:%02d ", localTime.year(), 
-                                        localTime.month() , localTime.day(),
-                                        localTime.hour() , localTime.minute());
+  Serial.printf("%i/%02d/%02d %02d:%02d ", pLocalTime.year(), 
+                                        pLocalTime.month() , pLocalTime.day(),
+                                        pLocalTime.hour() , pLocalTime.minute());
    
-  t_httpCode responseCode = viessmannClient.GetFeatures(bufferStorePtr, bufferStoreLength, data_0_id, Gateways_0_Serial, Gateways_0_Devices_0_Id, apiSelectionPtr);
+  uint32_t requestStartMs = millis();
+  t_httpCode responseCode = viessmannClient.GetFeatures(acquisitionBufferPtr, acquisitionBufferLength, data_0_id, Gateways_0_Serial, Gateways_0_Devices_0_Id, apiSelectionPtr);
+  metrics.RecordLatency(metricViLatency, millis() - requestStartMs);
 
   Serial.printf("(%u) Viessmann Features: httpResponseCode is: %d\r\n", loadViFeaturesCount, responseCode);
   if (responseCode == t_http_codes::HTTP_CODE_OK)
@@ -3232,6 +3166,7 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
     //pApiSelectionPtr ->lastReadTimeSeconds = dateTimeUTCNow.secondstime();
     
     loadViFeaturesCount++;
+    metrics.Increment(metricViFeatures);
     // After each successful request error counters are reset
     loadViFeaturesResp400Count = 0;
     loadViFeaturesRespOtherCount = 0;
@@ -3241,7 +3176,7 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
     if (vi_features[0].timestamp[0] == '\0')
     {
       #if FLASH_LOGGING == 1
-      addLogEntry(LOG_FILE, "25", "Viessmann can't read timestamp", LOGGING_ENTRIES);
+      addLogEntry(pLocalTime, "25", "Viessmann can't read timestamp");
       #endif
       Serial.println("Unknown timestamp was found. Rebooting\n");
       for (int i2 = 0; i2 < 5; i2++)
@@ -3254,14 +3189,8 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
         delay(500);
       }
     }
-       
-    // Get 4 On/Off sensor values which were read from the Viessmann Api
-    // and store them in a 'twin' of the sensor, reflecting its state
-    
-    OnOffBurnerStatus.Feed(strcmp(getFeatureByName(vi_features, VI_FEATURES_COUNT, "heating.burners.0")->values[0].value, "true") == 0, dateTimeUTCNow);
-    OnOffCirculationPumpStatus.Feed(strcmp(getFeatureByName(vi_features, VI_FEATURES_COUNT, "heating.circuits.0.circulation.pump")->values[0].value, "on") == 0, dateTimeUTCNow);   
-    OnOffDhwCircualtionPumpStatus.Feed(strcmp(getFeatureByName(vi_features, VI_FEATURES_COUNT, "heating.dhw.pumps.circulation")->values[0].value, "on") == 0, dateTimeUTCNow); 
-    OnOffDhwPrimaryPumpStatus.Feed(strcmp(getFeatureByName(vi_features, VI_FEATURES_COUNT, "heating.dhw.pumps.primary")->values[0].value, "on") == 0, dateTimeUTCNow);    
+
+    // The acquisition task copies the values into its event, loop() takes them (processAcquisitionEvents())
   }
   else
   {
@@ -3274,12 +3203,13 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
     {
       loadViFeaturesRespOtherCount++;
     }
+    metrics.Increment(metricViFails);
     Serial.printf("Bad httpResponses, Code 400: %d, Others: %d\n", loadViFeaturesResp400Count, loadViFeaturesRespOtherCount);
   
     if (loadViFeaturesResp400Count > 20 || loadViFeaturesRespOtherCount > 20)
     {
       #if FLASH_LOGGING == 1
-        addLogEntry(LOG_FILE, "30", "Viessmann failed requests", LOGGING_ENTRIES);
+        addLogEntry(pLocalTime, "30", "Viessmann failed requests");
       #endif
       Serial.printf("Rebooting, failed Vi-Requests. 400: %d, others: %d\n", loadViFeaturesResp400Count, loadViFeaturesRespOtherCount);
       ESP.restart();
@@ -3289,8 +3219,8 @@ t_httpCode read_Vi_FeaturesFromApi(X509Certificate pCaCert, ViessmannApiAccount
       }
     }
 
-    bufferStorePtr[bufferStoreLength - 1] = '\0';
-    Serial.println((char *)bufferStorePtr);
+    acquisitionBufferPtr[acquisitionBufferLength - 1] = '\0';
+    Serial.println((char *)acquisitionBufferPtr);
   }
   
   return responseCode;
@@ -3711,18 +3641,22 @@ bool nearlyEqualFloat(float nominalValue, float actualValue, float absTolerance)
 }
 
 #pragma region Function setAiPreValueViaRestApi(...)
-t_httpCode setAiPreValueViaRestApi(X509Certificate pCaCert, RestApiAccount * pRestApiAccount , const char * pPreValue)
+// Sets the pre value of a meter device (called by the task of the meter)
+t_httpCode setAiPreValueViaRestApi(X509Certificate pCaCert, MeterReader * pReader, const char * pPreValue)
 {
-  WiFiClient * selectedClient = pRestApiAccount -> UseHttps ? &secure_wifi_client : &plain_wifi_client;
+  RestApiAccount * pRestApiAccount = pReader ->Pipeline ->Account;
+  WiFiClient * selectedClient = pRestApiAccount -> UseHttps ? &pReader ->SecureClient : &pReader ->PlainClient;
   if (pRestApiAccount -> UseHttps && !(pRestApiAccount -> UseCaCert))
   {
-    secure_wifi_client.setInsecure();
+    pReader ->SecureClient.setInsecure();
   }
 
-  AiOnTheEdgeClient aiOnTheEdgeClient(pRestApiAccount, pCaCert, httpPtr, selectedClient);
+  AiOnTheEdgeClient aiOnTheEdgeClient(pRestApiAccount, pCaCert, &pReader ->Http, selectedClient);
+  pReader ->Http.setConnectTimeout(METER_HTTP_TIMEOUT_MS);
+  pReader ->Http.setTimeout(METER_HTTP_TIMEOUT_MS);
 
-  //t_httpCode responseCode = aiOnTheEdgeClient.SetPreValue((const char *)pUrl, pPreValue,  bufferStorePtr, bufferStoreLength);
-  t_httpCode responseCode = aiOnTheEdgeClient.SetPreValue((const char *)(pRestApiAccount ->BaseUrl).c_str(), pPreValue,  bufferStorePtr, bufferStoreLength);
+  //t_httpCode responseCode = aiOnTheEdgeClient.SetPreValue((const char *)pUrl, pPreValue,  acquisitionBufferPtr, acquisitionBufferLength);
+  t_httpCode responseCode = aiOnTheEdgeClient.SetPreValue((const char *)(pRestApiAccount ->BaseUrl).c_str(), pPreValue,  pReader ->Buffer, sizeof(pReader ->Buffer));
 
   if (responseCode == t_http_codes::HTTP_CODE_OK)
   {
@@ -3748,19 +3682,19 @@ t_httpCode read_Vi_UserFromApi(X509Certificate pCaCert, ViessmannApiAccount * vi
       esp_task_wdt_reset();
   #endif
 
-  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  httpPtr, selectedClient, bufferStorePtr);
+  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  acquisitionHttpPtr, selectedClient, acquisitionBufferPtr);
    #if SERIAL_PRINT == 1
         // Serial.println(myViessmannApiAccount.ClientId);
       #endif
       memset(viessmannApiUser,'\0', viessmannUserBufLen);
-      memset(bufferStorePtr,'\0', bufferStoreLength);
-      t_httpCode responseCode = viessmannClient.GetUser(bufferStorePtr, bufferStoreLength);
+      memset(acquisitionBufferPtr,'\0', acquisitionBufferLength);
+      t_httpCode responseCode = viessmannClient.GetUser(acquisitionBufferPtr, acquisitionBufferLength);
       Serial.printf("\r\nUser: httpResponseCode is: %d\r\n", responseCode);
       
       if (responseCode == t_http_codes::HTTP_CODE_OK)
       {
-        uint16_t cntToCopy = strlen((char*)bufferStorePtr) < viessmannUserBufLen ? strlen((char*)bufferStorePtr) : viessmannUserBufLen -1;
-        memcpy(viessmannApiUser, bufferStorePtr, cntToCopy);       
+        uint16_t cntToCopy = strlen((char*)acquisitionBufferPtr) < viessmannUserBufLen ? strlen((char*)acquisitionBufferPtr) : viessmannUserBufLen -1;
+        memcpy(viessmannApiUser, acquisitionBufferPtr, cntToCopy);       
       }    
 return responseCode;
 }
@@ -3779,19 +3713,19 @@ t_httpCode read_Vi_EquipmentFromApi(X509Certificate pCaCert, ViessmannApiAccount
   #if WORK_WITH_WATCHDOG == 1
       esp_task_wdt_reset();
   #endif
-  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  httpPtr, selectedClient, bufferStorePtr);
+  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  acquisitionHttpPtr, selectedClient, acquisitionBufferPtr);
    #if SERIAL_PRINT == 1
         //Serial.println(myViessmannApiAccount.ClientId);
       #endif
       
-      memset(bufferStorePtr, '\0', bufferStoreLength); 
-      t_httpCode responseCode = viessmannClient.GetEquipment(bufferStorePtr, bufferStoreLength);
+      memset(acquisitionBufferPtr, '\0', acquisitionBufferLength); 
+      t_httpCode responseCode = viessmannClient.GetEquipment(acquisitionBufferPtr, acquisitionBufferLength);
           
       Serial.printf("\r\nEquipment httpResponseCode is: %d\r\n", responseCode);
 
       if (responseCode == t_http_codes::HTTP_CODE_OK)
       {
-        const char* json = (char *)bufferStorePtr;
+        const char* json = (char *)acquisitionBufferPtr;
         JsonDocument doc;
         deserializeJson(doc, json);
         
@@ -3803,7 +3737,7 @@ t_httpCode read_Vi_EquipmentFromApi(X509Certificate pCaCert, ViessmannApiAccount
         const char * gateways_0_devices_0_id = doc["data"][0]["gateways"][0]["devices"][0]["id"];
         
         *p_data_0_id = data_0_id;
-        memset(bufferStorePtr, '\0', bufferStoreLength);
+        memset(acquisitionBufferPtr, '\0', acquisitionBufferLength);
          
         memset(p_data_0_description, '\0', equipBufLen);
         memset(p_data_0_address_street, '\0', equipBufLen);
@@ -3824,7 +3758,7 @@ t_httpCode read_Vi_EquipmentFromApi(X509Certificate pCaCert, ViessmannApiAccount
 #pragma endregion
 
 #pragma region Routine refresh_Vi_AccessTokenFromApi(...)
-t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, const char * refreshToken)
+t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAccount * viessmannApiAccountPtr, const char * refreshToken, DateTime pLocalTime)
 {
   WiFiClient * selectedClient = viessmannApiAccountPtr -> UseHttps ? &secure_wifi_client : &plain_wifi_client;
   
@@ -3841,25 +3775,26 @@ t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAc
   const char * refreshTokenLabel = "refresh_token";
   const char * tokenTypeLabel = "token_type";
   
-  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  httpPtr, selectedClient, bufferStorePtr); 
-      memset(bufferStorePtr,'\0', bufferStoreLength);
-      t_httpCode responseCode = viessmannClient.RefreshAccessToken(bufferStorePtr, bufferStoreLength, refreshToken);
+  ViessmannClient viessmannClient(myViessmannApiAccountPtr, pCaCert,  acquisitionHttpPtr, selectedClient, acquisitionBufferPtr); 
+      memset(acquisitionBufferPtr,'\0', acquisitionBufferLength);
+      t_httpCode responseCode = viessmannClient.RefreshAccessToken(acquisitionBufferPtr, acquisitionBufferLength, refreshToken);
       
-      Serial.printf("\n(%u) %i/%02d/%02d %02d:%02d ", loadRefreshTokenCount, localTime.year(), 
-                                        localTime.month() , localTime.day(),
-                                        localTime.hour() , localTime.minute());
+      Serial.printf("\n(%u) %i/%02d/%02d %02d:%02d ", loadRefreshTokenCount, pLocalTime.year(), 
+                                        pLocalTime.month() , pLocalTime.day(),
+                                        pLocalTime.hour() , pLocalTime.minute());
       Serial.println(F("Refreshing Access Token"));
       Serial.printf("(%u) Refresh Token: httpResponseCode: %d\r\n\r\n", loadRefreshTokenCount++, responseCode);
+      metrics.Increment(metricTokenRefreshes);
       
       if (responseCode == t_http_codes::HTTP_CODE_OK)
       {    
          #if SERIAL_PRINT == 1
-          // Serial.printf("%s\n", (char *)bufferStorePtr);
+          // Serial.printf("%s\n", (char *)acquisitionBufferPtr);
          #endif
          bool tokenIsValid = true;
-         char * posAcTok = strnstr((char *)bufferStorePtr, (const char *)"access_token", 50);
-         char * posRefrTok = strnstr((char *)bufferStorePtr, (const char *)"refresh_token", 2000);
-         char * posTokType = strnstr((char *)bufferStorePtr, (const char *)"token_type", 2000);
+         char * posAcTok = strnstr((char *)acquisitionBufferPtr, (const char *)"access_token", 50);
+         char * posRefrTok = strnstr((char *)acquisitionBufferPtr, (const char *)"refresh_token", 2000);
+         char * posTokType = strnstr((char *)acquisitionBufferPtr, (const char *)"token_type", 2000);
 
          tokenIsValid = posAcTok == nullptr ? false : tokenIsValid;
          tokenIsValid = posRefrTok == nullptr ? false : tokenIsValid;
@@ -3883,15 +3818,15 @@ t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAc
          {
             responseCode = HTTPC_ERROR_SEND_PAYLOAD_FAILED;
             Serial.println(F("Content error. Refreshing Accesstoken failed!\n"));
-            bufferStorePtr[bufferStoreLength - 1] = '\0';
-            Serial.println((char *)bufferStorePtr);
+            acquisitionBufferPtr[acquisitionBufferLength - 1] = '\0';
+            Serial.println((char *)acquisitionBufferPtr);
          }
       }
       else
       {  
         Serial.println(F("Response Error. Refreshing Accesstoken failed!\n"));   
-        bufferStorePtr[bufferStoreLength - 1] = '\0';
-        Serial.println((char *)bufferStorePtr);
+        acquisitionBufferPtr[acquisitionBufferLength - 1] = '\0';
+        Serial.println((char *)acquisitionBufferPtr);
       }
    return responseCode;
       
@@ -3899,6 +3834,7 @@ t_httpCode refresh_Vi_AccessTokenFromApi(X509Certificate pCaCert, ViessmannApiAc
 #pragma endregion
 
 #pragma region Routine createTable(...)   //Azure Storage Table
+// Returns the status code, the table is available with 201 (created) or 409 (exists)
 az_http_status_code createTable(CloudStorageAccount *pAccountPtr, X509Certificate pCaCert, const char * pTableName)
 { 
 
@@ -3942,66 +3878,1021 @@ az_http_status_code createTable(CloudStorageAccount *pAccountPtr, X509Certificat
   {
       sprintf(codeString, "%s %i", "Table Creation failed: ", az_http_status_code(statusCode));
       #if FLASH_LOGGING == 1
-        addLogEntry(LOG_FILE, "40", "Azure table creation failed", LOGGING_ENTRIES);
+        addLogEntry(localTime, "40", "Azure table creation failed");
       #endif
       //#if SERIAL_PRINT == 1   
         Serial.println((char *)codeString);
       //#endif
- 
-    delay(1000);
-    //RoSchmi (temporary commented)
-    ESP.restart();    
+      metrics.Increment(metricUploadFails);
+      // No restart: the caller keeps its rows and tries again with the next upload
   }
 return statusCode;
 }
 #pragma endregion
 
-#pragma region Routine insertTableEntity(...)    //Azure Storage Table
-az_http_status_code insertTableEntity(CloudStorageAccount *pAccountPtr,  X509Certificate pCaCert, const char * pTableName, TableEntity pTableEntity, char * outInsertETag)
-{ 
-  #if AZURE_TRANSPORT_PROTOKOL == 1
-    static WiFiClientSecure wifi_client;
-  #else
-    static WiFiClient wifi_client;
-  #endif
-  
-  #if AZURE_TRANSPORT_PROTOKOL == 1
-    wifi_client.setCACert(myX509Certificate); 
-  #endif
-  
-  /*
-  // For tests: Try second upload with corrupted certificate to provoke failure
-  #if AZURE_TRANSPORT_PROTOKOL == 1
-    wifi_client.setCACert(myX509Certificate);
-    if (insertCounterAnalogTable == 2)
+#pragma region Routine sendRollupRow(...)
+void sendRollupRow(AnalogRollup * pRollup, RollupPeriod pPeriod, const char * pTableName, int pTimeZoneOffsetUTC, float pDivisorOfT_1)
+{
+  if (!pRollup ->HasToBeSent(pPeriod))
+  {
+    return;
+  }
+  // The row is only acknowledged when it was stored, otherwise it is sent again with the next upload
+  AnalogRollup::RollupRow row = pRollup ->PeekRow(pPeriod);
+
+  // Define name of the table (name + Hours or Days + year of the period, like: ViessmannValuesHours2025)
+  String augmentedTableName = pTableName;
+  augmentedTableName += pPeriod == RollupPeriod::Hour ? "Hours" : "Days";
+  if (augmentTableNameWithYear)
+  {
+    augmentedTableName += (row.End.year());
+  }
+  // Create Azure Storage Table if table doesn't exist
+  if (row.End.year() != pRollup ->Year[(int)pPeriod])
+  {
+    az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedTableName.c_str());
+    if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
     {
-      wifi_client.setCACert(baltimore_corrupt_root_ca);
+      pRollup ->Year[(int)pPeriod] = row.End.year();
     }
-  #endif
-  */
+    else
+    {
+      return;
+    }
+  }
 
-  TableClient table(pAccountPtr, pCaCert,  httpPtr, &wifi_client, bufferStorePtr);
+  // SampleTime is the last second of the period
+  char sampleTime[25] {0};
+  TimeSpan spanOffsetUtc(0, pTimeZoneOffsetUTC / 60, pTimeZoneOffsetUTC % 60, 0);
+  createSampleTime(row.End.operator-(spanOffsetUtc), pTimeZoneOffsetUTC, (char *)sampleTime);
 
-  #if WORK_WITH_WATCHDOG == 1
-      esp_task_wdt_reset();
-  #endif
-  
-  DateTime responseHeaderDateTime = DateTime();   // Will be filled with DateTime value of the resonse from Azure Service
+  // T_1 ... T_N hold the mean, so that the table can be displayed like the other analog tables
+  // T_1_Min, T_1_Max ... T_N_Max are added
+  const size_t rollupChannelCount = AnalogRollup::ChannelCount;
+  AnalogEntityBuilder<rollupChannelCount, 2 * rollupChannelCount> rollupEntityBuilder(sampleTime);
+  for (size_t i = 0; i < rollupChannelCount; i++)
+  {
+    IntervalStats stats = row.Stats[i];
+    float divisor = (i == 0 && stats.Count > 0) ? pDivisorOfT_1 : 1.0f;
+    char statsPropertyName[12] = {0};
+    rollupEntityBuilder.SetValue(i, floToStr(stats.Mean / divisor).c_str());
+    snprintf(statsPropertyName, sizeof(statsPropertyName), "T_%d_Min", (int)(i + 1));
+    rollupEntityBuilder.AddProperty(statsPropertyName, floToStr(stats.Min / divisor).c_str());
+    snprintf(statsPropertyName, sizeof(statsPropertyName), "T_%d_Max", (int)(i + 1));
+    rollupEntityBuilder.AddProperty(statsPropertyName, floToStr(stats.Max / divisor).c_str());
+  }
 
-  // Insert Entity
-  az_http_status_code statusCode = table.InsertTableEntity(pTableName, dateTimeUTCNow, pTableEntity, (char *)outInsertETag, &responseHeaderDateTime, ContType::contApplicationIatomIxml, AcceptType::acceptApplicationIjson, ResponseType::dont_returnContent, false);
-  
-  #if WORK_WITH_WATCHDOG == 1
-      esp_task_wdt_reset();
-  #endif
+  char partKeySpan[25] {0};
+  size_t partitionKeyLength = 0;
+  az_span partitionKey = AZ_SPAN_FROM_BUFFER(partKeySpan);
+  makePartitionKey(analogTablePartPrefix, augmentPartitionKey, row.End, partitionKey, &partitionKeyLength);
+  partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
 
-  lastResetCause = 0;
-  tryUploadCounter++;
+  char rowKeySpan[25] {0};
+  size_t rowKeyLength = 0;
+  az_span rowKey = AZ_SPAN_FROM_BUFFER(rowKeySpan);
+  makeRowKey(row.End, rowKey, &rowKeyLength);
+  rowKey = az_span_slice(rowKey, 0, rowKeyLength);
 
-   // RoSchmi for tests: to simulate failed upload
-  //az_http_status_code   statusCode = AZ_HTTP_STATUS_CODE_UNAUTHORIZED;
-  
-  if ((statusCode == AZ_HTTP_STATUS_CODE_NO_CONTENT) || (statusCode == AZ_HTTP_STATUS_CODE_CREATED))
+  AnalogTableEntity analogTableEntity = rollupEntityBuilder.CreateEntity(partitionKey, rowKey);
+
+  #if SERIAL_PRINT == 1
+    Serial.printf("Rollup Table Name: %s \r\n\n", (const char *)augmentedTableName.c_str());
+  #endif
+
+  char EtagBuffer[50] {0};
+  az_http_status_code insertResult = insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedTableName.c_str(), analogTableEntity, (char *)EtagBuffer);
+  // Conflict: the row is already stored (the response of an earlier request was lost)
+  if ((insertResult == AZ_HTTP_STATUS_CODE_CREATED) || (insertResult == AZ_HTTP_STATUS_CODE_NO_CONTENT) || (insertResult == AZ_HTTP_STATUS_CODE_CONFLICT))
+  {
+    pRollup ->AckRow(pPeriod);
+  }
+}
+#pragma endregion
+
+#pragma region Function reconcileBurnerCycles(bool pLastState, bool pNewState, int64_t pBurnerStarts)
+// With the poll interval of the Viessmann Api short burner cycles between two polls are not seen.
+// They are concluded from the 'starts' counter and written to the burner table (index 0) before
+// the seen switch of this poll, which is written in loop()
+void reconcileBurnerCycles(bool pLastState, bool pNewState, int64_t pBurnerStarts)
+{
+  if (pBurnerStarts < 0)
+  {
+    burnerCycleReconciler.Reset();
+    return;
+  }
+
+  uint32_t inferredCycles = burnerCycleReconciler.Reconcile((uint32_t)pBurnerStarts, pLastState, pNewState, dateTimeUTCNow);
+  for (uint32_t i = 0; i < 2 * inferredCycles; i++)
+  {
+    // The first switch of a cycle changes to the opposite of the last state, the second switches back
+    bool state = (i % 2 == 0) ? !pLastState : pLastState;
+    DateTime switchTimeUtc = burnerCycleReconciler.GetInferredSwitchTime(i);
+    int timeZoneOffsetUTC = myTimezone.utcIsDST(switchTimeUtc.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
+    onOffDataContainer.SetNewOnOffValue(0, state, switchTimeUtc, timeZoneOffsetUTC, true);
+  }
+  if (inferredCycles > 0)
+  {
+    Serial.printf("%u burner cycles between the polls were inferred\r\n", inferredCycles);
+  }
+}
+#pragma endregion
+
+#pragma region Task acquisitionTask(void * pParameter)
+// Reads the Viessmann Cloud when its read interval has expired and posts an AcquisitionEvent
+// for each read. Uses only its own buffer and HTTPClient, so reads go on while loop() uploads to Azure
+// The features, the read time and the token refresh time belong to the task, loop() gets
+// the values only through the events. The meters are read by their own tasks (meterTask())
+void acquisitionTask(void * pParameter)
+{
+  acquisitionTaskId = taskMonitor.RegisterTask("Acquisition", xTaskGetCurrentTaskHandle(), xPortGetCoreID());
+  // The token was refreshed by setup()
+  DateTime accessTokenRefreshTime = AccessTokenRefreshTime;
+  for (;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(LOW_POWER_MODE == 1 ? LOW_POWER_CYCLE_MS : ACQUISITION_TASK_PERIOD_MS));
+    if (WiFi.status() != WL_CONNECTED)
+    {
+      continue;   // loop() reconnects
+    }
+    taskMonitor.BeginWork(acquisitionTaskId);
+
+    DateTime utcNow = DateTime(clockDiscipline.GetUtcSeconds());
+    int64_t utcNowSecondsTime = (int64_t)utcNow.secondstime();
+    DateTime taskLocalTime = DateTime(acquisitionTimezone.toLocal(utcNow.unixtime()));
+
+    // refresh Viessmann access token if refresh interval has expired 
+    if ((accessTokenRefreshTime.operator+(AccessTokenRefreshInterval)).operator<(utcNow))
+    {
+      powerModeManager.BeginRadioActivity();
+      t_httpCode refreshCode = refresh_Vi_AccessTokenFromApi((const char*)"dummyCaCert", myViessmannApiAccountPtr, viessmannRefreshToken, taskLocalTime);
+      powerModeManager.EndRadioActivity();
+      if (refreshCode == t_http_codes::HTTP_CODE_OK)
+      {           
+        accessTokenRefreshTime = utcNow;
+      }
+      else
+      {
+        Serial.println(F("Token Refresh failed\n"));            
+        accessTokenRefreshTime = utcNow.operator-(TimeSpan(300));
+      }
+    }
+
+    AcquisitionEvent event;
+    event.Kind = AcquisitionKind::Features;
+
+    // Only read features from the cloud when readInterval has expired
+    if ((viessmannApiSelectionPtr_01 ->lastReadTimeSeconds + viessmannApiSelectionPtr_01 ->readIntervalSeconds) < utcNowSecondsTime)
+    {
+      Serial.println(F("########## Have to read Vi-Features #########\n"));
+      powerModeManager.BeginRadioActivity();
+      event.HttpCode = read_Vi_FeaturesFromApi(myX509Certificate, myViessmannApiAccountPtr, Data_0_Id, Gateways_0_Serial, Gateways_0_Devices_0_Id, viessmannApiSelectionPtr_01, taskLocalTime);
+      powerModeManager.EndRadioActivity();
+      viessmannApiSelectionPtr_01 ->lastReadTimeSeconds = utcNowSecondsTime;
+      if (event.HttpCode == t_http_codes::HTTP_CODE_OK)
+      {
+        copyViessmannValues(&event);
+      }
+      Serial.println(event.HttpCode == t_http_codes::HTTP_CODE_OK ? F("Succeeded to read Features from Viessmann Cloud\n") : F("Failed to read Features from Viessmann Cloud"));
+
+      event.Source = 0;
+      event.PostedMicros = micros();
+      taskMonitor.Send(acquisitionQueueId, &event);
+    }
+
+    taskMonitor.EndWork(acquisitionTaskId);
+  }
+}
+#pragma endregion
+
+#pragma region Task meterTask(void * pParameter)
+// Reads one AiOnTheEdge device (pParameter is its MeterReader) when the read interval has expired
+// and posts an AcquisitionEvent for each read, sets the pre value on request of loop()
+// Each active meter has its own task, so the meters are polled concurrently
+// A device which does not answer is asked less often: after each failed read the delay
+// is doubled, up to METER_RETRY_MAX_BACKOFF_SECONDS
+void meterTask(void * pParameter)
+{
+  MeterReader * reader = (MeterReader *)pParameter;
+  MeterPipeline * pipeline = reader ->Pipeline;
+  AiOnTheEdgeApiSelection * apiSelectionPtr = pipeline ->ApiSelection;
+  reader ->TaskId = taskMonitor.RegisterTask(pipeline ->Label, xTaskGetCurrentTaskHandle(), xPortGetCoreID());
+  int64_t readDelaySeconds = apiSelectionPtr ->readIntervalSeconds;
+  uint32_t failedReads = 0;
+  for (;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(LOW_POWER_MODE == 1 ? LOW_POWER_CYCLE_MS : ACQUISITION_TASK_PERIOD_MS));
+    if (WiFi.status() != WL_CONNECTED)
+    {
+      continue;   // loop() reconnects
+    }
+    taskMonitor.BeginWork(reader ->TaskId);
+
+    DateTime utcNow = DateTime(clockDiscipline.GetUtcSeconds());
+    int64_t utcNowSecondsTime = (int64_t)utcNow.secondstime();
+    DateTime taskLocalTime = DateTime(reader ->LocalTimezone.toLocal(utcNow.unixtime()));
+
+    AcquisitionEvent event;
+    event.Source = reader ->Source;
+
+    // Requests of loop() to the device
+    AcquisitionCommand command;
+    while (taskMonitor.Receive(reader ->CommandQueueId, &command))
+    {
+      taskMonitor.AddQueueWait(reader ->TaskId, micros() - command.PostedMicros);
+      powerModeManager.BeginRadioActivity();
+      event.HttpCode = setAiPreValueViaRestApi((const char*)"dummyCaCert", reader, (const char *)command.PreValue);
+      powerModeManager.EndRadioActivity();
+
+      event.Kind = AcquisitionKind::PreValue;
+      event.PostedMicros = micros();
+      // loop() waits for the answer, so it must not be dropped
+      while (!taskMonitor.Send(acquisitionQueueId, &event))
+      {
+        vTaskDelay(pdMS_TO_TICKS(100));
+      }
+    }
+
+    if ((apiSelectionPtr ->lastReadTimeSeconds + readDelaySeconds) < utcNowSecondsTime)
+    {
+      powerModeManager.BeginRadioActivity();
+      uint32_t requestStartMs = millis();
+      event.HttpCode = readJsonFromRestApi(myX509Certificate, reader, taskLocalTime, event.MeterFeatures);
+      metrics.RecordLatency(metricMeterLatency, millis() - requestStartMs);
+      powerModeManager.EndRadioActivity();
+      apiSelectionPtr ->lastReadTimeSeconds = utcNowSecondsTime;
+      if (event.HttpCode > 0)
+      {
+        if (event.HttpCode != t_http_codes::HTTP_CODE_OK)
+        {
+          Serial.printf("Failed to read Features: ResponseCode: %d\n", event.HttpCode); 
+          Serial.println((char*)reader ->Buffer);
+        }
+      }
+      else
+      {
+        Serial.printf("Failed reading from Ai-On-The-Edge-Device, httpCode: %d\n", event.HttpCode); 
+      }
+
+      failedReads = (event.HttpCode == t_http_codes::HTTP_CODE_OK) ? 0 : failedReads + 1;
+      readDelaySeconds = apiSelectionPtr ->readIntervalSeconds;
+      for (uint32_t i = 0; (i < failedReads) && (readDelaySeconds * 2 <= METER_RETRY_MAX_BACKOFF_SECONDS); i++)
+      {
+        readDelaySeconds *= 2;
+      }
+
+      event.Kind = AcquisitionKind::Features;
+      event.PostedMicros = micros();
+      taskMonitor.Send(acquisitionQueueId, &event);
+    }
+    taskMonitor.EndWork(reader ->TaskId);
+  }
+}
+#pragma endregion
+
+#pragma region Function processAcquisitionEvents()
+// Takes the events of the acquisition task and of the meter tasks (called by loop() in each cycle)
+// The values are copied out of the events, the sensor managers take them from these copies:
+// the analog Viessmann values when their read interval has expired, the reading of a meter
+// in the same cycle (ReadAiOnTheEdgeApi_Analog_01())
+void processAcquisitionEvents()
+{
+  AcquisitionEvent event;
+  while (taskMonitor.Receive(acquisitionQueueId, &event))
+  {
+    taskMonitor.AddQueueWait(loopTaskId, micros() - event.PostedMicros);
+    if (event.Kind == AcquisitionKind::PreValue)
+    {
+      takeOverPreValue(meterPipelines[event.Source - 1], event.HttpCode);
+    }
+    else if (event.Source == 0 && event.HttpCode == t_http_codes::HTTP_CODE_OK)
+    {
+      memcpy((void *)viAnalogValues, (void *)event.ViAnalogValues, sizeof(viAnalogValues));
+      feedViessmannOnOffStates(&event);
+    }
+    else if (event.HttpCode == t_http_codes::HTTP_CODE_OK)
+    {
+      // A failed read has no values, the reading of the meter is left out in this cycle
+      MeterPipeline * pipeline = meterPipelines[event.Source - 1];
+      memcpy((void *)pipeline ->Features, (void *)event.MeterFeatures, sizeof(pipeline ->Features));
+      pipeline ->HasNewFeatures = true;
+    }
+  }
+}
+#pragma endregion
+
+#pragma region Function copyViessmannValues(AcquisitionEvent * outEvent)
+// Copies the 4 On/Off states, the 'starts' counter of the burner and the 4 analog values
+// from the features which were just read into the event (called by the acquisition task)
+void copyViessmannValues(AcquisitionEvent * outEvent)
+{
+  const char * onOffFeatureNames[VI_ON_OFF_STATE_COUNT] = { "heating.burners.0", "heating.circuits.0.circulation.pump", 
+                                                            "heating.dhw.pumps.circulation", "heating.dhw.pumps.primary" };
+  const char * onValues[VI_ON_OFF_STATE_COUNT] = { "true", "on", "on", "on" };
+  for (int i = 0; i < VI_ON_OFF_STATE_COUNT; i++)
+  {
+    VI_Feature * feature = getFeatureByName(vi_features, VI_FEATURES_COUNT, onOffFeatureNames[i]);
+    outEvent ->ViOnOffStates[i] = (feature != nullptr) && (strcmp(feature ->values[0].value, onValues[i]) == 0);
+  }
+
+  outEvent ->BurnerStarts = -1;
+  VI_Feature * statistics = getFeatureByName(vi_features, VI_FEATURES_COUNT, "heating.burners.0.statistics");
+  for (int i = 0; (statistics != nullptr) && (i < statistics ->valueCount); i++)
+  {
+    if ((strcmp(statistics ->values[i].key, "starts") == 0) && isdigit(statistics ->values[i].value[0]))
+    {
+      outEvent ->BurnerStarts = strtoul(statistics ->values[i].value, nullptr, 10);
+    }
+  }
+
+  // An empty value is not taken by ReadViessmannApi_Analog_01()
+  for (int i = 0; i < VI_ANALOG_VALUE_COUNT; i++)
+  {
+    VI_Feature * feature = getFeatureByName(vi_features, VI_FEATURES_COUNT, viAnalogFeatureNames[i]);
+    strncpy(outEvent ->ViAnalogValues[i], (feature != nullptr) ? feature ->values[0].value : "", VI_FEATUREVALUELENGTH - 1);
+    outEvent ->ViAnalogValues[i][VI_FEATUREVALUELENGTH - 1] = '\0';
+  }
+}
+#pragma endregion
+
+#pragma region Function feedViessmannOnOffStates(const AcquisitionEvent * pEvent)
+// Feeds the 4 On/Off sensor values which were read from the Viessmann Api (copied into the event)
+// into a 'twin' of the sensor, reflecting its state
+void feedViessmannOnOffStates(const AcquisitionEvent * pEvent)
+{
+  bool lastBurnerState = OnOffBurnerStatus.GetState();
+  OnOffBurnerStatus.Feed(pEvent ->ViOnOffStates[0], dateTimeUTCNow);
+  #if ON_OFF_RECONCILE_BURNER_STARTS == 1
+    reconcileBurnerCycles(lastBurnerState, OnOffBurnerStatus.GetState(), pEvent ->BurnerStarts);
+  #endif
+  OnOffCirculationPumpStatus.Feed(pEvent ->ViOnOffStates[1], dateTimeUTCNow);   
+  OnOffDhwCircualtionPumpStatus.Feed(pEvent ->ViOnOffStates[2], dateTimeUTCNow); 
+  OnOffDhwPrimaryPumpStatus.Feed(pEvent ->ViOnOffStates[3], dateTimeUTCNow);    
+}
+#pragma endregion
+
+#pragma region Function meterSource(MeterPipeline * pPipeline)
+// Number of the meter in the events and commands of the meter tasks (1 + m)
+uint8_t meterSource(MeterPipeline * pPipeline)
+{
+  for (int m = 0; m < METER_PIPELINES_COUNT; m++)
+  {
+    if (meterPipelines[m] == pPipeline)
+    {
+      return 1 + m;
+    }
+  }
+  return 0;
+}
+#pragma endregion
+
+#pragma region Function takeOverPreValue(MeterPipeline * pPipeline, t_httpCode pHttpCode)
+// The task of the meter has set the pre value of the first read
+// If it succeeded, the first read is done and the DayBase is set, otherwise the next read sends it again
+void takeOverPreValue(MeterPipeline * pPipeline, t_httpCode pHttpCode)
+{
+  const int decShiftFactor = 10;   // like in ReadAnalogSensorStruct_01()
+  pPipeline ->PreValueIsPending = false;
+  if (pHttpCode != t_http_codes::HTTP_CODE_OK)
+  {
+    Serial.printf("Setting the pre value of %s failed: %d\n", pPipeline ->Label, pHttpCode);
+    return;
+  }
+  pPipeline ->IsFirstRead = false;
+
+  // Set content of the struct to 0
+  memset((void *) &pPipeline ->DayBase,       0, sizeof(pPipeline ->DayBase));
+  if (!meterStateStore.Get(pPipeline ->StateKey, &pPipeline ->DayBase, sizeof(pPipeline ->DayBase)))
+  {
+    // No DayBase stored yet
+    storeMeterDayBase(pPipeline, pPipeline ->PendingPreValue * decShiftFactor);
+  }
+  else
+  {
+    // A stored timestamp which is not valid counts as another day
+    DateTime firstReadingDateTime;
+    DateTime::parse((const char *)pPipeline ->DayBase.localTimestamp, &firstReadingDateTime);
+      
+    // if we have a new day --> write DayBase, otherwise -->leave the old one
+    if (firstReadingDateTime.daysSinceEpoch() != localTime.daysSinceEpoch())       
+    {
+      Serial.println("Was new day");
+      Serial.printf("Presetting an writing new DayBase values (%s)\n", pPipeline ->Label);
+      storeMeterDayBase(pPipeline, pPipeline ->PendingPreValue * decShiftFactor);
+    }            
+  }
+}
+#pragma endregion
+
+#pragma region Function storeTableEntities(const char * pTableName, TableEntity pTableEntities[], size_t pEntityCount)
+// Inserts the entities of one partition, returns the number of leading entities which are stored
+// An entity group transaction ($batch) is atomic: a conflict (409) means that none of the entities
+// was stored, because one of them exists already (e.g. the response of an earlier request was lost).
+// Then the entities are inserted one at a time, here a conflict really means 'already stored'
+size_t storeTableEntities(const char * pTableName, TableEntity pTableEntities[], size_t pEntityCount)
+{
+  if (pEntityCount > 1)
+  {
+    az_http_status_code batchResult = insertTableEntities(myCloudStorageAccountPtr, myX509Certificate, pTableName, pTableEntities, pEntityCount);
+    if (batchResult == AZ_HTTP_STATUS_CODE_ACCEPTED)
+    {
+      return pEntityCount;
+    }
+    if (batchResult != AZ_HTTP_STATUS_CODE_CONFLICT)
+    {
+      return 0;
+    }
+  }
+  size_t storedCount = 0;
+  while (storedCount < pEntityCount)
+  {
+    char EtagBuffer[50] {0};
+    az_http_status_code insertResult = insertTableEntity(myCloudStorageAccountPtr, myX509Certificate, pTableName, pTableEntities[storedCount], (char *)EtagBuffer);
+    if ((insertResult != AZ_HTTP_STATUS_CODE_NO_CONTENT) && (insertResult != AZ_HTTP_STATUS_CODE_CREATED) && (insertResult != AZ_HTTP_STATUS_CODE_CONFLICT))
+    {
+      break;
+    }
+    storedCount++;
+  }
+  return storedCount;
+}
+#pragma endregion
+
+#pragma region Function sendOnOffTransitions(int pSensorIndex, DateTime pLocalNow)
+// Sends the buffered switch events of one On/Off table, all events of one month (partition) with one request
+// Each row gets the time of the switch as SampleTime and RowKey
+void sendOnOffTransitions(int pSensorIndex, DateTime pLocalNow)
+{
+  uint32_t transitionCount = onOffDataContainer.GetTransitionCount(pSensorIndex);
+  if (transitionCount == 0)
+  {
+    return;
+  }
+  OnOffSampleValue sampleValue = onOffDataContainer.GetOnOffValueSet().OnOffSampleValues[pSensorIndex];
+
+  OnOffTransition firstTransition = onOffDataContainer.GetTransition(pSensorIndex, 0);
+  DateTime firstLocalTime = firstTransition.TimeUtc.operator+(TimeSpan(firstTransition.OffsetUtcMinutes * 60));
+
+  TableEntity onOffTableEntities[MAX_BATCH_ENTITY_COUNT];
+  size_t entityCount = 0;
+  while ((entityCount < transitionCount) && (entityCount < MAX_BATCH_ENTITY_COUNT))
+  {
+    OnOffTransition transition = onOffDataContainer.GetTransition(pSensorIndex, entityCount);
+    DateTime transitionLocalTime = transition.TimeUtc.operator+(TimeSpan(transition.OffsetUtcMinutes * 60));
+
+    // All entities of a batch must be in the same table (year) and partition (month)
+    if ((transitionLocalTime.year() != firstLocalTime.year()) || (transitionLocalTime.month() != firstLocalTime.month()))
+    {
+      break;
+    }
+    OnOffBatchRow * row = &onOffBatchRows[entityCount];
+
+    char OnTimeDay[15] = {0};
+    sprintf(OnTimeDay, "%03i-%02i:%02i:%02i", transition.OnTimeDay.days(), transition.OnTimeDay.hours(), transition.OnTimeDay.minutes(), transition.OnTimeDay.seconds());
+    char timefromLast[15] = {0};
+    sprintf(timefromLast, "%03i-%02i:%02i:%02i", transition.TimeFromLast.days(), transition.TimeFromLast.hours(), transition.TimeFromLast.minutes(), transition.TimeFromLast.seconds());
+    createSampleTime(transition.TimeUtc, transition.OffsetUtcMinutes, (char *)row ->SampleTime);
+
+    size_t onOffPropertyCount = 5;
+    row ->Properties[0] = (EntityProperty)TableEntityProperty((char *)"ActStatus", sampleValue.outInverter ? (char *)(transition.actState ? "On" : "Off") : (char *)(transition.actState ? "Off" : "On"), (char *)"Edm.String");
+    row ->Properties[1] = (EntityProperty)TableEntityProperty((char *)"LastStatus", sampleValue.outInverter ? (char *)(transition.lastState ? "On" : "Off") : (char *)(transition.lastState ? "Off" : "On"), (char *)"Edm.String");
+    row ->Properties[2] = (EntityProperty)TableEntityProperty((char *)"OnTimeDay", (char *) OnTimeDay, (char *)"Edm.String");
+    row ->Properties[3] = (EntityProperty)TableEntityProperty((char *)"SampleTime", (char *) row ->SampleTime, (char *)"Edm.String");
+    row ->Properties[4] = (EntityProperty)TableEntityProperty((char *)"TimeFromLast", (char *) timefromLast, (char *)"Edm.String");
+
+    #if ON_OFF_SEND_DUTY_CYCLE_STATS == 1
+      // Duty cycle statistics (short-cycling of the burner), times as ddd-hh:mm:ss
+      OnOffDutyCycle dutyCycle = transition.DutyCycle;
+      uint32_t dutyCycleSeconds[4] = { dutyCycle.OnMinSeconds, OnOffDataContainerWio::MeanOnSeconds(dutyCycle), 
+                                       dutyCycle.OnMaxSeconds, OnOffDataContainerWio::MeanOffSeconds(dutyCycle) };
+      const char * dutyCycleNames[4] = { "OnMin", "OnMean", "LongestRun", "OffMean" };
+      char dutyCycleValue[15] = {0};
+      snprintf(dutyCycleValue, sizeof(dutyCycleValue), "%u", dutyCycle.StartsHour);
+      row ->Properties[onOffPropertyCount++] = (EntityProperty)TableEntityProperty((char *)"StartsHour", (char *)dutyCycleValue, (char *)"Edm.String");
+      snprintf(dutyCycleValue, sizeof(dutyCycleValue), "%u", dutyCycle.StartsDay);
+      row ->Properties[onOffPropertyCount++] = (EntityProperty)TableEntityProperty((char *)"StartsDay", (char *)dutyCycleValue, (char *)"Edm.String");
+      for (int d = 0; d < 4; d++)
+      {
+        TimeSpan dutyCycleSpan = TimeSpan((int32_t)dutyCycleSeconds[d]);
+        sprintf(dutyCycleValue, "%03i-%02i:%02i:%02i", dutyCycleSpan.days(), dutyCycleSpan.hours(), dutyCycleSpan.minutes(), dutyCycleSpan.seconds());
+        row ->Properties[onOffPropertyCount++] = (EntityProperty)TableEntityProperty((char *)dutyCycleNames[d], (char *)dutyCycleValue, (char *)"Edm.String");
+      }
+    #endif
+    // 1 = the switch was concluded from the starts counter, the time is estimated
+    row ->Properties[onOffPropertyCount++] = (EntityProperty)TableEntityProperty((char *)"Inferred", (char *)(transition.Inferred ? "1" : "0"), (char *)"Edm.String");
+
+    size_t partitionKeyLength = 0;
+    az_span partitionKey = AZ_SPAN_FROM_BUFFER(row ->PartitionKey);
+    makePartitionKey(onOffTablePartPrefix, augmentPartitionKey, transitionLocalTime, partitionKey, &partitionKeyLength);
+    partitionKey = az_span_slice(partitionKey, 0, partitionKeyLength);
+
+    size_t rowKeyLength = 0;
+    az_span rowKey = AZ_SPAN_FROM_BUFFER(row ->RowKey);
+    makeRowKey(transitionLocalTime, rowKey, &rowKeyLength);
+    rowKey = az_span_slice(rowKey, 0, rowKeyLength);
+
+    onOffTableEntities[entityCount] = OnOffTableEntity(partitionKey, rowKey, az_span_create_from_str((char *)row ->SampleTime), row ->Properties, onOffPropertyCount);
+    entityCount++;
+  }
+
+  // Tablenames come from the onOffValueSet, here usually the tablename is augmented with the year of the events
+  String augmentedOnOffTableName = sampleValue.tableName;
+  if (augmentTableNameWithYear)
+  {               
+    augmentedOnOffTableName += (firstLocalTime.year()); 
+  }
+
+  // Create table if table doesn't exist
+  if (firstLocalTime.year() != sampleValue.Year)
+  {
+    az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedOnOffTableName.c_str());
+    if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
+    {
+      onOffDataContainer.Set_Year(pSensorIndex, firstLocalTime.year());
+    }
+    else
+    {
+      return;
+    }
+  }
+
+  #if SERIAL_PRINT == 1
+    Serial.printf("OnOff Table Name: %s, %d events \r\n\n", (const char *)augmentedOnOffTableName.c_str(), entityCount);
+  #endif
+
+  // Only the events which are stored are removed, the others are sent again with the next flush
+  size_t storedCount = storeTableEntities(augmentedOnOffTableName.c_str(), onOffTableEntities, entityCount);
+  if (storedCount > 0)
+  {
+    onOffDataContainer.RemoveTransitions(pSensorIndex, storedCount);
+
+    // After a new day has begun, the on-time of the day starts with 0
+    DateTime lastSwitchTimeDate = DateTime(sampleValue.LastSwitchTime.year(), sampleValue.LastSwitchTime.month(), sampleValue.LastSwitchTime.day());
+    DateTime actTimeDate = DateTime(pLocalNow.year(), pLocalNow.month(), pLocalNow.day());
+    if ((onOffDataContainer.GetTransitionCount(pSensorIndex) == 0) && (lastSwitchTimeDate.operator!=(actTimeDate)))
+    {
+      onOffDataContainer.Set_OnTimeDay(pSensorIndex, TimeSpan(0));
+      if (sampleValue.actState == true)
+      {
+        onOffDataContainer.Set_LastSwitchTime(pSensorIndex, actTimeDate);
+      }
+    }
+  }
+}
+#pragma endregion
+
+#pragma region Function holdViessmannRow(DateTime pLocalTime, int pTimeZoneOffsetUTC)
+// Takes the due analog values of Viessmann from the container and holds them as row of the analog table
+void holdViessmannRow(DateTime pLocalTime, int pTimeZoneOffsetUTC)
+{
+  // Retrieve edited sample values from container
+  SampleValueSet sampleValueSet = dataContainerAnalogViessmann01.getCheckedSampleValues(dateTimeUTCNow, true);
+  char sampleTime[25] {0};
+  createSampleTime(sampleValueSet.LastUpdateTime, pTimeZoneOffsetUTC, (char *)sampleTime);
+
+  // Create the Properties of the table row with AnalogEntityBuilder
+  // Each Property consists of the Name, the Value and the Type (here only Edm.String is supported)
+
+  // Besides PartitionKey and RowKey we have 5 properties to be stored in a table row
+  // (SampleTime and 4 samplevalues)
+  // With ANALOG_SENSORS_SEND_INTERVAL_STATS min, max and mean of the send interval
+  // are added for each samplevalue (T_1_Min, T_1_Max, T_1_Mean ...)
+  const size_t viChannelCount = DataContainerWio::ChannelCount;
+  #if ANALOG_SENSORS_SEND_INTERVAL_STATS == 1
+    AnalogEntityBuilder<viChannelCount, 3 * viChannelCount> analogEntityBuilder(sampleTime);
+  #else
+    AnalogEntityBuilder<viChannelCount> analogEntityBuilder(sampleTime);
+  #endif
+
+  for (size_t i = 0; i < viChannelCount; i++)
+  {
+    #if ANALOG_SENSORS_USE_AVERAGE == 1
+      analogEntityBuilder.SetValue(i, floToStr(sampleValueSet.SampleValues[i].AverageValue).c_str());
+    #else
+      analogEntityBuilder.SetValue(i, floToStr(sampleValueSet.SampleValues[i].Value).c_str());
+    #endif
+  }
+
+  #if ANALOG_SENSORS_SEND_INTERVAL_STATS == 1
+    for (size_t i = 0; i < viChannelCount; i++)
+    {
+      char statsPropertyName[12] = {0};
+      IntervalStats stats = sampleValueSet.SampleValues[i].Stats;
+      snprintf(statsPropertyName, sizeof(statsPropertyName), "T_%d_Min", (int)(i + 1));
+      analogEntityBuilder.AddProperty(statsPropertyName, floToStr(stats.Min).c_str());
+      snprintf(statsPropertyName, sizeof(statsPropertyName), "T_%d_Max", (int)(i + 1));
+      analogEntityBuilder.AddProperty(statsPropertyName, floToStr(stats.Max).c_str());
+      snprintf(statsPropertyName, sizeof(statsPropertyName), "T_%d_Mean", (int)(i + 1));
+      analogEntityBuilder.AddProperty(statsPropertyName, floToStr(stats.Mean).c_str());
+    }
+  #endif
+
+  holdAnalogRow(&viAnalogRows, &analogEntityBuilder, pLocalTime, pLocalTime);
+
+  #if SERIAL_PRINT == 1
+    Serial.printf("Holding row %u of the Viessmann analog table, %u rows are held\r\n\n", insertCounterApiAnalogTable01, viAnalogRows.Count);
+  #endif
+  // Keep track of rows to insert
+  insertCounterApiAnalogTable01++;
+}
+#pragma endregion
+
+#pragma region Function holdMeterRows(int pMeterIndex, DateTime pLocalTime, int pTimeZoneOffsetUTC)
+// Takes the due values of a meter from its container and holds them as row of its analog table,
+// when a day is completed also the row of its ...Days table
+void holdMeterRows(int pMeterIndex, DateTime pLocalTime, int pTimeZoneOffsetUTC)
+{
+  MeterPipeline * pipeline = meterPipelines[pMeterIndex];
+  Serial.printf("\n###### AiOnTheEdge dataContainer (%s) has to be sent to Azure\n\n", pipeline ->Label);
+  // Retrieve edited sample values from container
+  SampleValueSet sampleValueSet = pipeline ->Container ->getCheckedSampleValues(dateTimeUTCNow, true);
+  // RoSchmi for debugging
+  volatile float valueOfFirstLine = sampleValueSet.SampleValues[0].Value;
+  if (valueOfFirstLine > 99.9)
+  {
+    Serial.printf("Value of T_1: %.1f\n", valueOfFirstLine);
+  }
+
+  char sampleTime[25] {0};
+  createSampleTime(sampleValueSet.LastUpdateTime, pTimeZoneOffsetUTC, (char *)sampleTime);
+
+  // Create the Properties of the table row with AnalogEntityBuilder
+  // Each Property consists of the Name, the Value and the Type (here only Edm.String is supported)
+
+  // Besides PartitionKey and RowKey we have SampleTime and one samplevalue per channel
+  // #if ANALOG_SENSORS_USE_AVERAGE == 1  makes no sense here
+  const size_t meterChannelCount = DataContainerWio::ChannelCount;
+  AnalogEntityBuilder<meterChannelCount> analogEntityBuilder(sampleTime);
+
+  float roundedMagicNumberInvalid = round((float)MAGIC_NUMBER_INVALID * 10) / 10;
+  for (size_t i = 0; i < meterChannelCount; i++)
+  {
+    float handledValue = sampleValueSet.SampleValues[i].Value;
+    // T_1 is stored with one shifted decimal place
+    // 999.9 is not divided by 10 as 999.9 has a special meaning
+    if (i == 0)
+    {
+      handledValue = nearlyEqualFloat(roundedMagicNumberInvalid, handledValue, 0.0001f) ? roundedMagicNumberInvalid : handledValue / 10;
+    }
+    analogEntityBuilder.SetValue(i, floToStr(handledValue).c_str());
+  }
+
+  holdAnalogRow(&meterAnalogRows[pMeterIndex], &analogEntityBuilder, pLocalTime, pLocalTime);
+
+  #if SERIAL_PRINT == 1
+    Serial.printf("Holding row %u of the %s analog table, %u rows are held\r\n\n", insertCounterAnalogTable, pipeline ->Label, meterAnalogRows[pMeterIndex].Count);
+
+    PlausibilityStatistics plausibilityStats = pipeline ->Plausibility.GetStatistics();
+    Serial.printf("%s readings: accepted %u repaired %u resynced %u rejected: invalid %u backwards %u too fast %u digit flip %u\r\n\n",
+          pipeline ->Label, plausibilityStats.Accepted, plausibilityStats.Repaired, plausibilityStats.Resynced, plausibilityStats.Invalid,
+          plausibilityStats.Backwards, plausibilityStats.TooFast, plausibilityStats.DigitFlip);
+  #endif
+
+  // Keep track of rows to insert
+  insertCounterAnalogTable++;
+  metrics.Increment(metricAnalogInserts);
+
+  // have to write new row in ...Days Table
+  if (pipeline ->MaxLastDay.isValid)
+  {
+    // The PartitionKey is made for the last day, the RowKey for now
+    TimeSpan oneDay(1,0,0,0);
+    int offsetHours = pTimeZoneOffsetUTC / 60;
+    int offsetMinutes = pTimeZoneOffsetUTC % 60;
+    TimeSpan spanOffsetUtc(0, offsetHours, offsetMinutes, 0);
+    TimeSpan spanToEndOfDay(0,23,59,59);
+
+    DateTime startOfSecondToLastUpdateDate(sampleValueSet.SecondToLastUpdateTime.year(), sampleValueSet.SecondToLastUpdateTime.month(), sampleValueSet.SecondToLastUpdateTime.day());
+
+    float dayConsumption = pipeline ->MaxLastDay.dayConsumption / 10;
+    float endOfDayTotalConsumption = pipeline ->ApiSelection ->baseValueOffset + (pipeline ->MaxLastDay.totalConsumption / 10);
+
+    String dayConsumptionStringDecPoint = floToStr(dayConsumption, '.');
+    String dayConsumptionStringDecKomma = floToStr(dayConsumption, ',');
+
+    char sampleDate[25] {0};
+    createSampleTime((startOfSecondToLastUpdateDate.operator-(spanOffsetUtc)).operator+(spanToEndOfDay), pTimeZoneOffsetUTC, (char *)sampleDate, SampleTimeFormatOpt::FORMAT_DATE_GER);
+    createSampleTime((startOfSecondToLastUpdateDate.operator-(spanOffsetUtc)).operator+(spanToEndOfDay), pTimeZoneOffsetUTC, (char *)sampleTime, SampleTimeFormatOpt::FORMAT_FULL_1);
+
+    // The ...Days table has its own 4 columns: date, day consumption, total and day consumption with comma
+    AnalogEntityBuilder<4> daysEntityBuilder(sampleTime);
+    daysEntityBuilder.SetValue(0, sampleDate);
+    daysEntityBuilder.SetValue(1, dayConsumptionStringDecPoint.c_str());
+    daysEntityBuilder.SetValue(2, floToStr(endOfDayTotalConsumption).c_str());
+    daysEntityBuilder.SetValue(3, dayConsumptionStringDecKomma.c_str());
+
+    pipeline ->MaxLastDay.isValid = false;
+    pipeline ->MaxLastDay.totalConsumption = 0.0f;
+    pipeline ->MaxLastDay.dayConsumption = 0.0f;
+
+    holdAnalogRow(&meterDaysRows[pMeterIndex], &daysEntityBuilder, pLocalTime, pLocalTime.operator-(oneDay));
+  }
+}
+#pragma endregion
+
+#pragma region Function holdAnalogRow(AnalogRowBuffer<P> * pBuffer, AnalogEntityBuilder<N, Extra> * pBuilder, DateTime pLocalTime, DateTime pPartitionTime)
+// Copies the properties of the builder into the buffer and makes the keys of the row
+// The table is the table of pLocalTime (year), the PartitionKey is made with pPartitionTime
+template<size_t P, size_t N, size_t Extra>
+void holdAnalogRow(AnalogRowBuffer<P> * pBuffer, AnalogEntityBuilder<N, Extra> * pBuilder, DateTime pLocalTime, DateTime pPartitionTime)
+{
+  static_assert(P >= AnalogEntityBuilder<N, Extra>::MaxPropertyCount, "The rows of the buffer are too small for the builder");
+  // When the rows could not be sent for a long time, the oldest row is dropped
+  if (pBuffer ->Count >= MAX_BATCH_ENTITY_COUNT)
+  {
+    memmove((void *)&pBuffer ->Rows[0], (void *)&pBuffer ->Rows[1], (MAX_BATCH_ENTITY_COUNT - 1) * sizeof(pBuffer ->Rows[0]));
+    pBuffer ->Count--;
+  }
+  auto * row = &pBuffer ->Rows[pBuffer ->Count];
+  memcpy((void *)row ->Properties, (void *)pBuilder ->Properties, sizeof(pBuilder ->Properties));
+  row ->PropertyCount = pBuilder ->PropertyCount();
+  row ->LocalTime = pLocalTime;
+
+  size_t partitionKeyLength = 0;
+  az_span partitionKey = AZ_SPAN_FROM_BUFFER(row ->PartitionKey);
+  makePartitionKey(analogTablePartPrefix, augmentPartitionKey, pPartitionTime, partitionKey, &partitionKeyLength);
+  row ->PartitionKey[partitionKeyLength < sizeof(row ->PartitionKey) ? partitionKeyLength : sizeof(row ->PartitionKey) - 1] = '\0';
+
+  size_t rowKeyLength = 0;
+  az_span rowKey = AZ_SPAN_FROM_BUFFER(row ->RowKey);
+  makeRowKey(pLocalTime, rowKey, &rowKeyLength);
+  row ->RowKey[rowKeyLength < sizeof(row ->RowKey) ? rowKeyLength : sizeof(row ->RowKey) - 1] = '\0';
+
+  pBuffer ->Count++;
+}
+#pragma endregion
+
+#pragma region Function sendAnalogRows(AnalogRowBuffer<P> * pBuffer, const char * pTableName)
+// Sends the held rows of an analog table, the rows of one partition with one request
+// Rows which are not stored stay in the buffer and are sent with the next upload
+template<size_t P>
+void sendAnalogRows(AnalogRowBuffer<P> * pBuffer, const char * pTableName)
+{
+  while (pBuffer ->Count > 0)
+  {
+    DateTime firstLocalTime = pBuffer ->Rows[0].LocalTime;
+
+    TableEntity analogTableEntities[MAX_BATCH_ENTITY_COUNT];
+    size_t entityCount = 0;
+    while (entityCount < pBuffer ->Count)
+    {
+      auto * row = &pBuffer ->Rows[entityCount];
+      // All entities of a batch must be in the same table (year) and partition
+      if ((row ->LocalTime.year() != firstLocalTime.year()) || (strcmp(row ->PartitionKey, pBuffer ->Rows[0].PartitionKey) != 0))
+      {
+        break;
+      }
+      analogTableEntities[entityCount] = AnalogTableEntity(az_span_create_from_str(row ->PartitionKey), az_span_create_from_str(row ->RowKey),
+                                                           az_span_create_from_str(row ->Properties[0].Value), row ->Properties, row ->PropertyCount);
+      entityCount++;
+    }
+
+    // Define name of the table (arbitrary name + actual year, like: AnalogTestValues2020)
+    String augmentedAnalogTableName = pTableName;
+    if (augmentTableNameWithYear)
+    {
+      augmentedAnalogTableName += (firstLocalTime.year());
+    }
+
+    // Create Azure Storage Table if table doesn't exist
+    if (firstLocalTime.year() != pBuffer ->TableYear)
+    {
+      az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedAnalogTableName.c_str());
+      Serial.printf("\r\nCreate Table: Statuscode: %s\n", ((String)respCode).c_str());
+      if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
+      {
+        pBuffer ->TableYear = firstLocalTime.year();
+      }
+      else
+      {
+        return;
+      }
+    }
+
+    #if SERIAL_PRINT == 1
+      Serial.printf("Analog Table Name: %s, %d rows \r\n\n", (const char *)augmentedAnalogTableName.c_str(), entityCount);
+    #endif
+
+    // Only the stored rows are removed, a failed request leaves the rest for the next upload
+    size_t storedCount = storeTableEntities(augmentedAnalogTableName.c_str(), analogTableEntities, entityCount);
+    memmove((void *)&pBuffer ->Rows[0], (void *)&pBuffer ->Rows[storedCount], (pBuffer ->Count - storedCount) * sizeof(pBuffer ->Rows[0]));
+    pBuffer ->Count -= storedCount;
+    if (storedCount < entityCount)
+    {
+      return;
+    }
+  }
+}
+#pragma endregion
+
+#pragma region Function addHealthRow(MainLoopStats pLoopStats)
+// Stores a row with the health of the device (heap, loop cycle times, request latencies, WiFi, queues)
+// of the last report interval. The rows look like the rows of an analog table (T_1 ... T_4),
+// so they can be displayed with Charts4Azure, the other values are added as extra columns
+void addHealthRow(MainLoopStats pLoopStats)
+{
+  if (!clockDiscipline.IsSynchronized())
+  {
+    return;
+  }
+  // When the rows could not be sent for a long time, the oldest row is dropped
+  if (healthRowCount >= MAX_BATCH_ENTITY_COUNT)
+  {
+    memmove((void *)&healthBatchRows[0], (void *)&healthBatchRows[1], (MAX_BATCH_ENTITY_COUNT - 1) * sizeof(HealthBatchRow));
+    healthRowCount--;
+  }
+  DateTime utcNow = DateTime(clockDiscipline.GetUtcSeconds());
+  int timeZoneOffsetUTC = myTimezone.utcIsDST(utcNow.unixtime()) ? TIMEZONEOFFSET + DSTOFFSET : TIMEZONEOFFSET;
+  DateTime localNow = utcNow.operator+(TimeSpan(timeZoneOffsetUTC * 60));
+
+  // The latencies of the requests within the report interval
+  static LatencyHistogram lastViLatency = {};
+  static LatencyHistogram lastAzureLatency = {};
+  static LatencyHistogram lastMeterLatency = {};
+  LatencyHistogram viLatencyNow = metrics.GetLatency(metricViLatency);
+  LatencyHistogram azureLatencyNow = metrics.GetLatency(metricAzureLatency);
+  LatencyHistogram meterLatencyNow = metrics.GetLatency(metricMeterLatency);
+  LatencyHistogram viLatency = MetricsRegistry::Difference(viLatencyNow, lastViLatency);
+  LatencyHistogram azureLatency = MetricsRegistry::Difference(azureLatencyNow, lastAzureLatency);
+  LatencyHistogram meterLatency = MetricsRegistry::Difference(meterLatencyNow, lastMeterLatency);
+  lastViLatency = viLatencyNow;
+  lastAzureLatency = azureLatencyNow;
+  lastMeterLatency = meterLatencyNow;
+
+  uint32_t onOffEvents = 0;
+  for (int i = 0; i < ON_OFF_SENSOR_COUNT; i++)
+  {
+    onOffEvents += onOffDataContainer.GetTransitionCount(i);
+  }
+
+  char sampleTime[25] {0};
+  createSampleTime(utcNow, timeZoneOffsetUTC, (char *)sampleTime);
+
+  // T_1: free heap (kB), T_2: loop cycle p99 (ms), T_3: mean Azure latency (ms), T_4: RSSI (dBm)
+  AnalogEntityBuilder<4, HEALTH_EXTRA_PROPERTY_COUNT> healthEntityBuilder(sampleTime);
+  healthEntityBuilder.SetValue(0, floToStr(ESP.getFreeHeap() / 1024.0).c_str());
+  healthEntityBuilder.SetValue(1, floToStr(pLoopStats.WorkMsP99).c_str());
+  healthEntityBuilder.SetValue(2, floToStr(azureLatency.Count > 0 ? azureLatency.SumMs / azureLatency.Count : 0).c_str());
+  healthEntityBuilder.SetValue(3, floToStr(WiFi.RSSI()).c_str());
+
+  char value[20] {0};
+  snprintf(value, sizeof(value), "%u", ESP.getMinFreeHeap());
+  healthEntityBuilder.AddProperty("MinFreeHeap", value);
+  snprintf(value, sizeof(value), "%u", ESP.getMaxAllocHeap());
+  healthEntityBuilder.AddProperty("LargestBlock", value);
+  snprintf(value, sizeof(value), "%u", pLoopStats.WorkMsP50);
+  healthEntityBuilder.AddProperty("LoopP50Ms", value);
+  snprintf(value, sizeof(value), "%u", viLatency.Count > 0 ? viLatency.SumMs / viLatency.Count : 0);
+  healthEntityBuilder.AddProperty("ViMeanMs", value);
+  snprintf(value, sizeof(value), "%u", MetricsRegistry::Percentile(viLatency, 99));
+  healthEntityBuilder.AddProperty("ViP99Ms", value);
+  snprintf(value, sizeof(value), "%u", MetricsRegistry::Percentile(azureLatency, 99));
+  healthEntityBuilder.AddProperty("AzureP99Ms", value);
+  snprintf(value, sizeof(value), "%u", meterLatency.Count > 0 ? meterLatency.SumMs / meterLatency.Count : 0);
+  healthEntityBuilder.AddProperty("MeterMeanMs", value);
+  snprintf(value, sizeof(value), "%u", MetricsRegistry::Percentile(meterLatency, 99));
+  healthEntityBuilder.AddProperty("MeterP99Ms", value);
+  snprintf(value, sizeof(value), "%u", metrics.GetCounter(metricWiFiReconnects));
+  healthEntityBuilder.AddProperty("Reconnects", value);
+  healthEntityBuilder.AddProperty("ResetReason", reset_reason_name(resetReason_0));
+  snprintf(value, sizeof(value), "%u", metrics.GetBootCount());
+  healthEntityBuilder.AddProperty("Boots", value);
+  snprintf(value, sizeof(value), "%u", taskMonitor.GetQueueStats(acquisitionQueueId).HighWaterMark);
+  healthEntityBuilder.AddProperty("QueueMax", value);
+  snprintf(value, sizeof(value), "%u", onOffEvents);
+  healthEntityBuilder.AddProperty("OnOffEvents", value);
+
+  HealthBatchRow * row = &healthBatchRows[healthRowCount];
+  memcpy((void *)row ->Properties, (void *)healthEntityBuilder.Properties, sizeof(row ->Properties));
+  row ->PropertyCount = healthEntityBuilder.PropertyCount();
+  row ->LocalTime = localNow;
+
+  size_t partitionKeyLength = 0;
+  az_span partitionKey = AZ_SPAN_FROM_BUFFER(row ->PartitionKey);
+  makePartitionKey(healthTablePartPrefix, augmentPartitionKey, localNow, partitionKey, &partitionKeyLength);
+  row ->PartitionKey[partitionKeyLength < sizeof(row ->PartitionKey) ? partitionKeyLength : sizeof(row ->PartitionKey) - 1] = '\0';
+
+  size_t rowKeyLength = 0;
+  az_span rowKey = AZ_SPAN_FROM_BUFFER(row ->RowKey);
+  makeRowKey(localNow, rowKey, &rowKeyLength);
+  row ->RowKey[rowKeyLength < sizeof(row ->RowKey) ? rowKeyLength : sizeof(row ->RowKey) - 1] = '\0';
+
+  healthRowCount++;
+}
+#pragma endregion
+
+#pragma region Function sendHealthRows()
+// Sends the buffered health rows of one month (partition) with one request
+void sendHealthRows()
+{
+  if (healthRowCount == 0)
+  {
+    return;
+  }
+  DateTime firstLocalTime = healthBatchRows[0].LocalTime;
+
+  TableEntity healthTableEntities[MAX_BATCH_ENTITY_COUNT];
+  size_t entityCount = 0;
+  while (entityCount < healthRowCount)
+  {
+    HealthBatchRow * row = &healthBatchRows[entityCount];
+    // All entities of a batch must be in the same table (year) and partition (month)
+    if ((row ->LocalTime.year() != firstLocalTime.year()) || (row ->LocalTime.month() != firstLocalTime.month()))
+    {
+      break;
+    }
+    healthTableEntities[entityCount] = AnalogTableEntity(az_span_create_from_str(row ->PartitionKey), az_span_create_from_str(row ->RowKey),
+                                                         az_span_create_from_str(row ->Properties[0].Value), row ->Properties, row ->PropertyCount);
+    entityCount++;
+  }
+
+  String augmentedHealthTableName = healthTableName;
+  if (augmentTableNameWithYear)
+  {
+    augmentedHealthTableName += (firstLocalTime.year());
+  }
+
+  // Create table if table doesn't exist
+  if (firstLocalTime.year() != healthTableYear)
+  {
+    az_http_status_code respCode = createTable(myCloudStorageAccountPtr, myX509Certificate, (char *)augmentedHealthTableName.c_str());
+    if ((respCode == AZ_HTTP_STATUS_CODE_CONFLICT) || (respCode == AZ_HTTP_STATUS_CODE_CREATED))
+    {
+      healthTableYear = firstLocalTime.year();
+    }
+    else
+    {
+      return;
+    }
+  }
+
+  #if SERIAL_PRINT == 1
+    Serial.printf("Health Table Name: %s, %d rows \r\n\n", (const char *)augmentedHealthTableName.c_str(), entityCount);
+  #endif
+
+  // Only the rows which are stored are removed, the others are sent again with the next upload
+  size_t storedCount = storeTableEntities(augmentedHealthTableName.c_str(), healthTableEntities, entityCount);
+  if (storedCount > 0)
+  {
+    memmove((void *)&healthBatchRows[0], (void *)&healthBatchRows[storedCount], (healthRowCount - storedCount) * sizeof(HealthBatchRow));
+    healthRowCount -= storedCount;
+  }
+}
+#pragma endregion
+
+#pragma region Routine insertTableEntity(...)    //Azure Storage Table
+az_http_status_code insertTableEntity(CloudStorageAccount *pAccountPtr,  X509Certificate pCaCert, const char * pTableName, TableEntity pTableEntity, char * outInsertETag)
+{ 
+  #if AZURE_TRANSPORT_PROTOKOL == 1
+    static WiFiClientSecure wifi_client;
+  #else
+    static WiFiClient wifi_client;
+  #endif
+  
+  #if AZURE_TRANSPORT_PROTOKOL == 1
+    wifi_client.setCACert(myX509Certificate); 
+  #endif
+  
+  /*
+  // For tests: Try second upload with corrupted certificate to provoke failure
+  #if AZURE_TRANSPORT_PROTOKOL == 1
+    wifi_client.setCACert(myX509Certificate);
+    if (insertCounterAnalogTable == 2)
+    {
+      wifi_client.setCACert(baltimore_corrupt_root_ca);
+    }
+  #endif
+  */
+
+  TableClient table(pAccountPtr, pCaCert,  httpPtr, &wifi_client, bufferStorePtr);
+
+  #if WORK_WITH_WATCHDOG == 1
+      esp_task_wdt_reset();
+  #endif
+  
+  DateTime responseHeaderDateTime = DateTime();   // Will be filled with DateTime value of the resonse from Azure Service
+
+  // Insert Entity
+  uint32_t requestStartMs = millis();
+  az_http_status_code statusCode = table.InsertTableEntity(pTableName, dateTimeUTCNow, pTableEntity, (char *)outInsertETag, &responseHeaderDateTime, ContType::contApplicationIatomIxml, AcceptType::acceptApplicationIjson, ResponseType::dont_returnContent, false);
+  #if SERIAL_PRINT == 1
+    // Cost of body, hash and signature on the device (compare SharedKey with SAS)
+    Serial.printf("Request prepared in %u us (%s)\r\n", (unsigned int)table.GetPrepareMicros(), pAccountPtr ->UsesSas() ? "SAS" : "SharedKey");
+  #endif
+  
+  #if WORK_WITH_WATCHDOG == 1
+      esp_task_wdt_reset();
+  #endif
+
+  metrics.RecordLatency(metricAzureLatency, millis() - requestStartMs);
+  lastResetCause = 0;
+  tryUploadCounter++;
+  metrics.Increment(metricUploads);
+
+   // RoSchmi for tests: to simulate failed upload
+  //az_http_status_code   statusCode = AZ_HTTP_STATUS_CODE_UNAUTHORIZED;
+  
+  if ((statusCode == AZ_HTTP_STATUS_CODE_NO_CONTENT) || (statusCode == AZ_HTTP_STATUS_CODE_CREATED))
   {
       char codeString[35] {0};
       sprintf(codeString, "Entity inserted: %i", statusCode);
@@ -4013,7 +4904,9 @@ az_http_status_code insertTableEntity(CloudStorageAccount *pAccountPtr,  X509Cer
     
     #if UPDATE_TIME_FROM_AZURE_RESPONSE == 1    // System time shall be updated from the DateTime value of the response ?
     
-    dateTimeUTCNow = responseHeaderDateTime;
+    // The response time is a reference for the clock discipline, the system time is slewed, not set
+    clockDiscipline.AddReference(responseHeaderDateTime.unixtime(), ClockSource::Azure);
+    dateTimeUTCNow = clockDiscipline.GetUtcSeconds();
     
     char buffer[35] = {0};
     strcpy(buffer, "Azure-Utc: YYYY-MM-DD hh:mm:ss");
@@ -4025,11 +4918,19 @@ az_http_status_code insertTableEntity(CloudStorageAccount *pAccountPtr,  X509Cer
     
     #endif   
   }
+  else if (statusCode == AZ_HTTP_STATUS_CODE_CONFLICT)
+  {
+    // Not a failure: the entity was stored by an earlier request (see storeTableEntities())
+    #if SERIAL_PRINT == 1
+      Serial.printf("\r\n%s Entity exists already: %i\r\n", pTableName, az_http_status_code(statusCode));
+    #endif
+  }
   else            // request failed
   {               // note: internal error codes from -1 to -11 were converted for tests to error codes 401 to 411 since
                   // negative values cannot be returned as 'az_http_status_code' 
 
     failedUploadCounter++;
+    metrics.Increment(metricUploadFails);
     //sendResultState = false;
     lastResetCause = 100;      // Set lastResetCause to arbitrary value of 100 to signal that post request failed
     
@@ -4064,27 +4965,117 @@ az_http_status_code insertTableEntity(CloudStorageAccount *pAccountPtr,  X509Cer
 }
 #pragma endregion
 
-#pragma region Routine print_reset_reason(RESET_REASON reason)
+#pragma region Routine insertTableEntities(...)    //Azure Storage Table
+// Inserts up to MAX_BATCH_ENTITY_COUNT entities of one partition with one request (entity group transaction)
+az_http_status_code insertTableEntities(CloudStorageAccount *pAccountPtr,  X509Certificate pCaCert, const char * pTableName, TableEntity pTableEntities[], size_t pEntityCount)
+{ 
+  #if AZURE_TRANSPORT_PROTOKOL == 1
+    static WiFiClientSecure wifi_client;
+  #else
+    static WiFiClient wifi_client;
+  #endif
+  
+  #if AZURE_TRANSPORT_PROTOKOL == 1
+    wifi_client.setCACert(myX509Certificate); 
+  #endif
+
+  TableClient table(pAccountPtr, pCaCert,  httpPtr, &wifi_client, bufferStorePtr);
+
+  #if WORK_WITH_WATCHDOG == 1
+      esp_task_wdt_reset();
+  #endif
+  
+  DateTime responseHeaderDateTime = DateTime();   // Will be filled with DateTime value of the resonse from Azure Service
+
+  // Insert Entities
+  uint32_t requestStartMs = millis();
+  az_http_status_code statusCode = table.InsertTableEntities(pTableName, dateTimeUTCNow, pTableEntities, pEntityCount, &responseHeaderDateTime, false);
+  #if SERIAL_PRINT == 1
+    Serial.printf("Batch prepared in %u us (%s)\r\n", (unsigned int)table.GetPrepareMicros(), pAccountPtr ->UsesSas() ? "SAS" : "SharedKey");
+  #endif
+  
+  #if WORK_WITH_WATCHDOG == 1
+      esp_task_wdt_reset();
+  #endif
+
+  metrics.RecordLatency(metricAzureLatency, millis() - requestStartMs);
+  lastResetCause = 0;
+  tryUploadCounter++;
+  metrics.Increment(metricUploads);
+
+  if (statusCode == AZ_HTTP_STATUS_CODE_ACCEPTED)
+  {
+    Serial.printf("\r\n%s %d Entities inserted: %i\r\n", pTableName, pEntityCount, az_http_status_code(statusCode));
+    
+    #if UPDATE_TIME_FROM_AZURE_RESPONSE == 1    // System time shall be updated from the DateTime value of the response ?
+      clockDiscipline.AddReference(responseHeaderDateTime.unixtime(), ClockSource::Azure);
+      dateTimeUTCNow = clockDiscipline.GetUtcSeconds();
+    #endif   
+  }
+  else if (statusCode == AZ_HTTP_STATUS_CODE_CONFLICT)
+  {
+    // Not a failure: a row exists already, storeTableEntities() inserts the rows one at a time
+    #if SERIAL_PRINT == 1
+      Serial.printf("%s %i\r\n", "Batch conflict, rows exist already: ", az_http_status_code(statusCode));
+    #endif
+  }
+  else            // request failed
+  {
+    failedUploadCounter++;
+    metrics.Increment(metricUploadFails);
+    lastResetCause = 100;      // Set lastResetCause to arbitrary value of 100 to signal that post request failed
+
+    #if SERIAL_PRINT == 1
+      Serial.printf("%s %i\r\n", "Batch insertion failed: ", az_http_status_code(statusCode));
+    #endif
+
+    #if REBOOT_AFTER_FAILED_UPLOAD == 1   // When selected in config.h -> Reboot through SystemReset after failed uoload
+      #if AZURE_TRANSPORT_PROTOKOL == 1         
+        ESP.restart();        
+      #endif
+      #if AZURE_TRANSPORT_PROTOKOL == 0     // for http requests reboot after the second, not the first, failed request
+        if(failedUploadCounter > 1)
+        {
+          ESP.restart();
+        }
+      #endif
+    #endif
+
+    #if WORK_WITH_WATCHDOG == 1
+      esp_task_wdt_reset();  
+    #endif
+    delay(1000);
+  }  
+  return statusCode;
+}
+#pragma endregion
+
+#pragma region Routine print_reset_reason(RESET_REASON reason), reset_reason_name(RESET_REASON reason)
 void print_reset_reason(RESET_REASON reason)
+{
+  Serial.println(reset_reason_name(reason));
+}
+
+const char * reset_reason_name(RESET_REASON reason)
 {
   switch ( reason)
   {
-    case 1 : Serial.println ("POWERON_RESET");break;          /**<1, Vbat power on reset*/
-    case 3 : Serial.println ("SW_RESET");break;               /**<3, Software reset digital core*/
-    case 4 : Serial.println ("OWDT_RESET");break;             /**<4, Legacy watch dog reset digital core*/
-    case 5 : Serial.println ("DEEPSLEEP_RESET");break;        /**<5, Deep Sleep reset digital core*/
-    case 6 : Serial.println ("SDIO_RESET");break;             /**<6, Reset by SLC module, reset digital core*/
-    case 7 : Serial.println ("TG0WDT_SYS_RESET");break;       /**<7, Timer Group0 Watch dog reset digital core*/
-    case 8 : Serial.println ("TG1WDT_SYS_RESET");break;       /**<8, Timer Group1 Watch dog reset digital core*/
-    case 9 : Serial.println ("RTCWDT_SYS_RESET");break;       /**<9, RTC Watch dog Reset digital core*/
-    case 10 : Serial.println ("INTRUSION_RESET");break;       /**<10, Instrusion tested to reset CPU*/
-    case 11 : Serial.println ("TGWDT_CPU_RESET");break;       /**<11, Time Group reset CPU*/
-    case 12 : Serial.println ("SW_CPU_RESET");break;          /**<12, Software reset CPU*/
-    case 13 : Serial.println ("RTCWDT_CPU_RESET");break;      /**<13, RTC Watch dog Reset CPU*/
-    case 14 : Serial.println ("EXT_CPU_RESET");break;         /**<14, for APP CPU, reseted by PRO CPU*/
-    case 15 : Serial.println ("RTCWDT_BROWN_OUT_RESET");break;/**<15, Reset when the vdd voltage is not stable*/
-    case 16 : Serial.println ("RTCWDT_RTC_RESET");break;      /**<16, RTC Watch dog reset digital core and rtc module*/
-    default : Serial.println ("NO_MEAN");
+    case 1 : return "POWERON_RESET";      /**<1, Vbat power on reset*/
+    case 3 : return "SW_RESET";           /**<3, Software reset digital core*/
+    case 4 : return "OWDT_RESET";         /**<4, Legacy watch dog reset digital core*/
+    case 5 : return "DEEPSLEEP_RESET";    /**<5, Deep Sleep reset digital core*/
+    case 6 : return "SDIO_RESET";         /**<6, Reset by SLC module, reset digital core*/
+    case 7 : return "TG0WDT_SYS_RESET";   /**<7, Timer Group0 Watch dog reset digital core*/
+    case 8 : return "TG1WDT_SYS_RESET";   /**<8, Timer Group1 Watch dog reset digital core*/
+    case 9 : return "RTCWDT_SYS_RESET";   /**<9, RTC Watch dog Reset digital core*/
+    case 10 : return "INTRUSION_RESET";   /**<10, Instrusion tested to reset CPU*/
+    case 11 : return "TGWDT_CPU_RESET";   /**<11, Time Group reset CPU*/
+    case 12 : return "SW_CPU_RESET";      /**<12, Software reset CPU*/
+    case 13 : return "RTCWDT_CPU_RESET";  /**<13, RTC Watch dog Reset CPU*/
+    case 14 : return "EXT_CPU_RESET";     /**<14, for APP CPU, reseted by PRO CPU*/
+    case 15 : return "RTCWDT_BROWN_OUT_RESET";/**<15, Reset when the vdd voltage is not stable*/
+    case 16 : return "RTCWDT_RTC_RESET";  /**<16, RTC Watch dog reset digital core and rtc module*/
+    default : return "NO_MEAN";
   }
 }
 #pragma endregion
@@ -0,0 +1,85 @@
+// Minimal Arduino API for the host tests
+#ifndef _ARDUINO_HOST_STUB_H_
+#define _ARDUINO_HOST_STUB_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define IRAM_ATTR
+#define memcpy_P memcpy
+
+static inline unsigned long millis()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+static inline unsigned long micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+static inline void delay(unsigned long pMs) { std::this_thread::sleep_for(std::chrono::milliseconds(pMs)); }
+
+template<typename T> static inline T min(T a, T b) { return a < b ? a : b; }
+template<typename T> static inline T max(T a, T b) { return a > b ? a : b; }
+
+class __FlashStringHelper;
+
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char * pValue) : std::string(pValue != NULL ? pValue : "") {}
+    String(const std::string & pValue) : std::string(pValue) {}
+    String(int pValue) : std::string(std::to_string(pValue)) {}
+    String(unsigned int pValue) : std::string(std::to_string(pValue)) {}
+    String(long pValue) : std::string(std::to_string(pValue)) {}
+    String(unsigned long pValue) : std::string(std::to_string(pValue)) {}
+    String(float pValue, unsigned int pDecimals = 2) { char buffer[32]; snprintf(buffer, sizeof(buffer), "%.*f", pDecimals, pValue); assign(buffer); }
+    String(double pValue, unsigned int pDecimals = 2) { char buffer[32]; snprintf(buffer, sizeof(buffer), "%.*f", pDecimals, pValue); assign(buffer); }
+    unsigned int length() const { return (unsigned int)size(); }
+    int indexOf(char pChar) const { size_t position = find(pChar); return position == npos ? -1 : (int)position; }
+    String substring(unsigned int pFrom) const { return String(substr(pFrom)); }
+    String substring(unsigned int pFrom, unsigned int pTo) const { return String(substr(pFrom, pTo - pFrom)); }
+    long toInt() const { return atol(c_str()); }
+    float toFloat() const { return (float)atof(c_str()); }
+};
+
+class HostSerial
+{
+public:
+    void begin(unsigned long) {}
+    size_t print(const char * pText) { return fputs(pText, stdout); }
+    size_t print(const __FlashStringHelper * pText) { return print((const char *)pText); }
+    size_t print(const String & pText) { return print(pText.c_str()); }
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    size_t print(T pValue) { return printf("%lld", (long long)pValue); }
+    size_t println(const char * pText = "") { return printf("%s\n", pText); }
+    size_t println(const __FlashStringHelper * pText) { return println((const char *)pText); }
+    size_t println(const String & pText) { return println(pText.c_str()); }
+    template<typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+    size_t println(T pValue) { return printf("%lld\n", (long long)pValue); }
+    size_t printf(const char * pFormat, ...)
+    {
+        va_list args;
+        va_start(args, pFormat);
+        int length = vprintf(pFormat, args);
+        va_end(args);
+        return length < 0 ? 0 : length;
+    }
+};
+static HostSerial Serial;
+
+#endif  // _ARDUINO_HOST_STUB_H_
@@ -0,0 +1,34 @@
+// File system API of the ESP32 core for the host tests, nothing is stored
+#ifndef _FS_HOST_STUB_H_
+#define _FS_HOST_STUB_H_
+
+#include <Arduino.h>
+
+namespace fs
+{
+class File
+{
+public:
+    operator bool() const { return false; }
+    bool seek(uint32_t) { return false; }
+    size_t readBytes(char *, size_t) { return 0; }
+    size_t write(const uint8_t *, size_t) { return 0; }
+    size_t size() const { return 0; }
+    void close() {}
+};
+
+class FS
+{
+public:
+    bool begin(bool pFormatOnFail = false) { (void)pFormatOnFail; return true; }
+    bool format() { return true; }
+    File open(const char *, const char * = "r") { return File(); }
+    bool exists(const char *) { return false; }
+    bool remove(const char *) { return false; }
+};
+}
+
+using fs::File;
+using fs::FS;
+
+#endif  // _FS_HOST_STUB_H_
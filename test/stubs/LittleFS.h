@@ -0,0 +1,9 @@
+// LittleFS of the ESP32 core for the host tests (see FS.h)
+#ifndef _LITTLEFS_HOST_STUB_H_
+#define _LITTLEFS_HOST_STUB_H_
+
+#include <FS.h>
+
+static fs::FS LittleFS;
+
+#endif  // _LITTLEFS_HOST_STUB_H_
@@ -0,0 +1,57 @@
+// Part of the Time library (https://github.com/PaulStoffregen/Time) for the host tests
+#ifndef _TIMELIB_HOST_STUB_H_
+#define _TIMELIB_HOST_STUB_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#define SECS_PER_MIN  ((time_t)(60UL))
+#define SECS_PER_HOUR ((time_t)(3600UL))
+#define SECS_PER_DAY  ((time_t)(SECS_PER_HOUR * 24UL))
+
+typedef struct
+{
+    uint8_t Second;
+    uint8_t Minute;
+    uint8_t Hour;
+    uint8_t Wday;   // day of week, sunday is day 1
+    uint8_t Day;
+    uint8_t Month;
+    uint8_t Year;   // offset from 1970
+}
+tmElements_t;
+
+static inline time_t makeTime(const tmElements_t & tm)
+{
+    struct tm t = {};
+    t.tm_year = tm.Year + 70;
+    t.tm_mon = tm.Month - 1;
+    t.tm_mday = tm.Day;
+    t.tm_hour = tm.Hour;
+    t.tm_min = tm.Minute;
+    t.tm_sec = tm.Second;
+    return timegm(&t);
+}
+
+static inline void breakTime(time_t pTime, tmElements_t & tm)
+{
+    struct tm t;
+    gmtime_r(&pTime, &t);
+    tm.Second = t.tm_sec;
+    tm.Minute = t.tm_min;
+    tm.Hour = t.tm_hour;
+    tm.Wday = t.tm_wday + 1;
+    tm.Day = t.tm_mday;
+    tm.Month = t.tm_mon + 1;
+    tm.Year = t.tm_year - 70;
+}
+
+static inline int year(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Year + 1970; }
+static inline int month(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Month; }
+static inline int day(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Day; }
+static inline int hour(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Hour; }
+static inline int minute(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Minute; }
+static inline int second(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Second; }
+static inline int weekday(time_t pTime) { tmElements_t tm; breakTime(pTime, tm); return tm.Wday; }
+
+#endif  // _TIMELIB_HOST_STUB_H_
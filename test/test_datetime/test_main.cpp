@@ -0,0 +1,218 @@
+// Host tests and benchmark of the allocation-free DateTime functions (lib/RoSchmi/TimeFuncs/DateTime.cpp)
+// Run with: pio test -e native -f test_datetime
+//
+// format_to() must write the same text as timestamp(), parse() must read it back and must
+// reject every string which is not a valid date (2000 - 2099), daysSinceEpoch() must count
+// the days like unixtime(). The benchmark compares them with the String based code they replace.
+
+#include <unity.h>
+#include <stdio.h>
+#include <time.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "DateTime.h"
+
+#define FIRST_YEAR 2000
+#define LAST_YEAR 2099
+#define BENCHMARK_COUNT 200000
+
+// Days of the month from the C library, independent of DateTime
+static int daysOfMonth(int pYear, int pMonth)
+{
+    struct tm t = {};
+    t.tm_year = (pMonth == 12 ? pYear + 1 : pYear) - 1900;
+    t.tm_mon = pMonth % 12;
+    t.tm_mday = 0;      // the last day of the month before
+    time_t last = timegm(&t);
+    struct tm result;
+    gmtime_r(&last, &result);
+    return result.tm_mday;
+}
+
+static std::vector<DateTime> randomDateTimes(size_t pCount)
+{
+    std::mt19937 random(4711);
+    std::uniform_int_distribution<uint32_t> distribution(DateTime(FIRST_YEAR, 1, 1).unixtime(), DateTime(LAST_YEAR, 12, 31, 23, 59, 59).unixtime());
+    std::vector<DateTime> dateTimes;
+    for (size_t i = 0; i < pCount; i++)
+    {
+        dateTimes.push_back(DateTime(distribution(random)));
+    }
+    return dateTimes;
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// Every 3607 s (so all hours, minutes and seconds are hit) from 2000 to 2099
+static void test_format_to_matches_timestamp()
+{
+    const DateTime::timestampOpt options[] = { DateTime::TIMESTAMP_FULL, DateTime::TIMESTAMP_DATE, DateTime::TIMESTAMP_TIME };
+    uint32_t end = DateTime(LAST_YEAR, 12, 31, 23, 59, 59).unixtime();
+    for (uint32_t t = DateTime(FIRST_YEAR, 1, 1).unixtime(); t <= end; t += 3607)
+    {
+        DateTime dateTime(t);
+        for (DateTime::timestampOpt option : options)
+        {
+            char buffer[20];
+            size_t length = dateTime.format_to(buffer, sizeof(buffer), option);
+            String expected = dateTime.timestamp(option);
+            TEST_ASSERT_EQUAL(expected.length(), length);
+            TEST_ASSERT_EQUAL_STRING(expected.c_str(), buffer);
+        }
+        TEST_ASSERT_EQUAL(t / 86400, dateTime.daysSinceEpoch());
+    }
+}
+
+static void test_format_to_small_buffer()
+{
+    DateTime dateTime(2024, 2, 29, 13, 5, 9);
+    char buffer[20] = "unchanged";
+    TEST_ASSERT_EQUAL(0, dateTime.format_to(buffer, 19));
+    TEST_ASSERT_EQUAL_STRING("", buffer);
+    TEST_ASSERT_EQUAL(0, dateTime.format_to(buffer, 10, DateTime::TIMESTAMP_DATE));
+    TEST_ASSERT_EQUAL(10, dateTime.format_to(buffer, 11, DateTime::TIMESTAMP_DATE));
+    TEST_ASSERT_EQUAL_STRING("2024-02-29", buffer);
+    TEST_ASSERT_EQUAL(8, dateTime.format_to(buffer, 9, DateTime::TIMESTAMP_TIME));
+    TEST_ASSERT_EQUAL_STRING("13:05:09", buffer);
+    TEST_ASSERT_EQUAL(0, dateTime.format_to(NULL, 20));
+}
+
+// Formatted and parsed again gives the same DateTime, with 'T' and with ' '
+static void test_round_trip()
+{
+    for (const DateTime & dateTime : randomDateTimes(BENCHMARK_COUNT))
+    {
+        char buffer[20];
+        dateTime.format_to(buffer, sizeof(buffer));
+        DateTime parsed;
+        TEST_ASSERT_TRUE(DateTime::parse(buffer, &parsed));
+        TEST_ASSERT_TRUE(parsed == dateTime);
+        buffer[10] = ' ';
+        TEST_ASSERT_TRUE(DateTime::parse(buffer, &parsed));
+        TEST_ASSERT_TRUE(parsed == dateTime);
+
+        dateTime.format_to(buffer, sizeof(buffer), DateTime::TIMESTAMP_DATE);
+        TEST_ASSERT_TRUE(DateTime::parse(buffer, &parsed));
+        TEST_ASSERT_TRUE(parsed == DateTime(dateTime.year(), dateTime.month(), dateTime.day()));
+        TEST_ASSERT_EQUAL(dateTime.daysSinceEpoch(), parsed.daysSinceEpoch());
+    }
+}
+
+// All months 0 - 13 and days 0 - 32 of the years 1999 - 2100, valid are only the real dates
+static void test_parse_all_dates()
+{
+    size_t validCount = 0;
+    for (int year = FIRST_YEAR - 1; year <= LAST_YEAR + 1; year++)
+    {
+        for (int month = 0; month <= 13; month++)
+        {
+            for (int day = 0; day <= 32; day++)
+            {
+                char text[32];
+                snprintf(text, sizeof(text), "%04d-%02d-%02dT12:34:56", year, month, day);
+                bool isValid = (year >= FIRST_YEAR) && (year <= LAST_YEAR) && (month >= 1) && (month <= 12) && (day >= 1) && (day <= daysOfMonth(year, month));
+                DateTime parsed(2001, 2, 3);
+                bool isParsed = DateTime::parse(text, &parsed);
+                if (isParsed != isValid)
+                {
+                    TEST_FAIL_MESSAGE(text);
+                }
+                if (isValid)
+                {
+                    TEST_ASSERT_TRUE(parsed == DateTime(year, month, day, 12, 34, 56));
+                    validCount++;
+                }
+                else
+                {
+                    // Not changed by invalid strings
+                    TEST_ASSERT_TRUE(parsed == DateTime(2001, 2, 3));
+                }
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(36525, validCount);
+}
+
+static void test_parse_malformed()
+{
+    const char * invalid[] = { "", "2024", "2024-02", "2024-2-29", "2024/02/29", "24-02-29", "2024-02-29T", "2024-02-29T12",
+                               "2024-02-29T12:00", "2024-02-29T24:00:00", "2024-02-29T12:60:00", "2024-02-29T12:00:60",
+                               "2024-02-29T1a:00:00", "2024-02-29T12-00-00", " 2024-02-29", "abcd-ef-gh", "2023-02-29" };
+    for (const char * text : invalid)
+    {
+        DateTime parsed(2001, 2, 3);
+        if (DateTime::parse(text, &parsed))
+        {
+            TEST_FAIL_MESSAGE(text);
+        }
+        TEST_ASSERT_TRUE(parsed == DateTime(2001, 2, 3));
+    }
+    DateTime parsed;
+    TEST_ASSERT_FALSE(DateTime::parse(NULL, &parsed));
+    TEST_ASSERT_FALSE(DateTime::parse("2024-02-29", NULL));
+
+    // Chars after the date or the time are ignored (e.g. the 'Z' of UTC)
+    TEST_ASSERT_TRUE(DateTime::parse("2024-02-29T23:59:59Z", &parsed));
+    TEST_ASSERT_TRUE(parsed == DateTime(2024, 2, 29, 23, 59, 59));
+    TEST_ASSERT_TRUE(DateTime::parse("2024-02-29x", &parsed));
+    TEST_ASSERT_TRUE(parsed == DateTime(2024, 2, 29));
+}
+
+template<typename F>
+static double nanosPerCall(const std::vector<DateTime> & pDateTimes, F pFunction)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pDateTimes.size(); i++)
+    {
+        pFunction(pDateTimes[i], pDateTimes[pDateTimes.size() - 1 - i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / pDateTimes.size();
+}
+
+// Only reports: the new functions against the String based code they replace in main.cpp
+static void test_benchmark()
+{
+    std::vector<DateTime> dateTimes = randomDateTimes(BENCHMARK_COUNT);
+    std::vector<String> texts;
+    for (DateTime dateTime : dateTimes)
+    {
+        texts.push_back(dateTime.timestamp());
+    }
+    volatile size_t sink = 0;
+
+    double formatString = nanosPerCall(dateTimes, [&](DateTime a, const DateTime &) { sink = sink + a.timestamp().length(); });
+    double formatTo = nanosPerCall(dateTimes, [&](const DateTime & a, const DateTime &) { char buffer[20]; sink = sink + a.format_to(buffer, sizeof(buffer)); });
+
+    size_t index = 0;
+    double parseConstructor = nanosPerCall(dateTimes, [&](const DateTime &, const DateTime &) { DateTime parsed(texts[index++ % texts.size()].c_str()); sink = sink + parsed.day(); });
+    index = 0;
+    double parse = nanosPerCall(dateTimes, [&](const DateTime &, const DateTime &) { DateTime parsed; DateTime::parse(texts[index++ % texts.size()].c_str(), &parsed); sink = sink + parsed.day(); });
+
+    double sameDayString = nanosPerCall(dateTimes, [&](DateTime a, DateTime b) { sink = sink + (a.timestamp(DateTime::TIMESTAMP_DATE) == b.timestamp(DateTime::TIMESTAMP_DATE)); });
+    double sameDayNumber = nanosPerCall(dateTimes, [&](const DateTime & a, const DateTime & b) { sink = sink + (a.daysSinceEpoch() == b.daysSinceEpoch()); });
+
+    printf("%-28s %14s %14s\n", "ns per call", "String based", "new");
+    printf("%-28s %14.1f %14.1f\n", "timestamp() / format_to()", formatString, formatTo);
+    printf("%-28s %14.1f %14.1f\n", "DateTime(text) / parse()", parseConstructor, parse);
+    printf("%-28s %14.1f %14.1f\n", "same day: dates / days", sameDayString, sameDayNumber);
+}
+
+int main(int argc, char ** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_format_to_matches_timestamp);
+    RUN_TEST(test_format_to_small_buffer);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_parse_all_dates);
+    RUN_TEST(test_parse_malformed);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
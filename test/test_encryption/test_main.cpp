@@ -0,0 +1,237 @@
+// Host tests and benchmark of the streaming hash functions (lib/RoSchmi/Encryption/Roschmi_encryption_helpers.cpp)
+// Run with: pio test -e native -f test_encryption
+// Needs the mbedtls 2.x library of the host (e.g. apt install libmbedtls-dev), the ESP32 core uses mbedtls 2.28
+//
+// The data hashed in chunks (init, update for each chunk, finish) must give the digests of the
+// one-shot functions and of the published test vectors (RFC 1321, FIPS 180-2, RFC 4231).
+// A digest with a 0 byte must be hex encoded in full, the former Content-MD5 stopped at the 0 byte.
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "RoSchmi_encryption_helpers.h"
+
+#define BENCHMARK_BYTES (1024 * 1024)
+
+typedef struct
+{
+    std::string Key;
+    std::string Message;
+    const char * DigestHex;
+}
+Vector;
+
+static const Vector md5Vectors[] =
+{
+    { "", "", "D41D8CD98F00B204E9800998ECF8427E" },
+    { "", "abc", "900150983CD24FB0D6963F7D28E17F72" },
+    { "", "The quick brown fox jumps over the lazy dog", "9E107D9D372BB6826BD81D3542A419D6" },
+    { "", "Content 167", "585AFF004ED7A5C192694D70BAE9D619" },     // the 4th byte is 0
+};
+
+static const Vector sha256Vectors[] =
+{
+    { "", "abc", "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD" },
+    { "", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248D6A61D20638B8E5C026930C3E6039A33CE45964FF2167F6ECEDD419DB06C1" },
+    { "", "Content 16", "2900C68E06D6CAAB7D354A5273C581F8E1695F67858B6D86B94ECC3E0D65A9E9" },     // the 2nd byte is 0
+};
+
+static const Vector hmacVectors[] =
+{
+    { std::string(20, '\x0b'), "Hi There", "B0344C61D8DB38535CA8AFCEAF0BF12B881DC200C9833DA726E9376C2E32CFF7" },
+    { "Jefe", "what do ya want for nothing?", "5BDCC146BF60754E6A042426089575C75A003F089D2739839DEC58B964EC3843" },
+    { std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First", "60E431591EE0B67F0D8A26AACBF5B77F8E0BC6213728C5140546040F0EE37F54" },
+    { "key", "Content 114", "50BA3B0071556F3459340913D709D12C6E66BA8BBBD55CE0240077C276DD30A6" },     // the 4th byte is 0
+};
+
+// Each hash function hashed in chunks of the given size
+static void md5Chunked(const std::string & pKey, const std::string & pMessage, size_t pChunkSize, uint8_t * outDigest)
+{
+    (void)pKey;
+    mbedtls_md5_context ctx;
+    TEST_ASSERT_EQUAL(0, md5HashInit(&ctx));
+    for (size_t i = 0; i < pMessage.size(); i += pChunkSize)
+    {
+        TEST_ASSERT_EQUAL(0, md5HashUpdate(&ctx, pMessage.data() + i, std::min(pChunkSize, pMessage.size() - i)));
+    }
+    TEST_ASSERT_EQUAL(0, md5HashFinish(&ctx, outDigest));
+}
+
+static void sha256Chunked(const std::string & pKey, const std::string & pMessage, size_t pChunkSize, uint8_t * outDigest)
+{
+    (void)pKey;
+    mbedtls_sha256_context ctx;
+    TEST_ASSERT_EQUAL(0, sha256HashInit(&ctx));
+    for (size_t i = 0; i < pMessage.size(); i += pChunkSize)
+    {
+        TEST_ASSERT_EQUAL(0, sha256HashUpdate(&ctx, pMessage.data() + i, std::min(pChunkSize, pMessage.size() - i)));
+    }
+    TEST_ASSERT_EQUAL(0, sha256HashFinish(&ctx, outDigest));
+}
+
+static void hmacChunked(const std::string & pKey, const std::string & pMessage, size_t pChunkSize, uint8_t * outDigest)
+{
+    mbedtls_md_context_t ctx;
+    TEST_ASSERT_EQUAL(0, hmacSha256Init(&ctx, pKey.data(), pKey.size()));
+    for (size_t i = 0; i < pMessage.size(); i += pChunkSize)
+    {
+        TEST_ASSERT_EQUAL(0, hmacSha256Update(&ctx, pMessage.data() + i, std::min(pChunkSize, pMessage.size() - i)));
+    }
+    TEST_ASSERT_EQUAL(0, hmacSha256Finish(&ctx, outDigest));
+}
+
+// The one-shot functions: createMd5Hash(), mbedtls_sha256_ret() and createSHA256Hash() (HMAC-SHA256)
+static void md5OneShot(const std::string & pKey, const std::string & pMessage, uint8_t * outDigest)
+{
+    (void)pKey;
+    char output[17];
+    TEST_ASSERT_EQUAL(0, createMd5Hash(output, sizeof(output), pMessage.c_str()));
+    memcpy(outDigest, output, 16);
+}
+
+static void sha256OneShot(const std::string & pKey, const std::string & pMessage, uint8_t * outDigest)
+{
+    (void)pKey;
+    TEST_ASSERT_EQUAL(0, mbedtls_sha256_ret((const unsigned char *)pMessage.data(), pMessage.size(), outDigest, 0));
+}
+
+static void hmacOneShot(const std::string & pKey, const std::string & pMessage, uint8_t * outDigest)
+{
+    char output[33];
+    TEST_ASSERT_EQUAL(0, createSHA256Hash(output, sizeof(output), pMessage.data(), pMessage.size(), pKey.data(), pKey.size()));
+    memcpy(outDigest, output, 32);
+}
+
+typedef void (*ChunkedFunction)(const std::string &, const std::string &, size_t, uint8_t *);
+typedef void (*OneShotFunction)(const std::string &, const std::string &, uint8_t *);
+
+static void checkVectors(const Vector * pVectors, size_t pCount, size_t pDigestLength, ChunkedFunction pChunked, OneShotFunction pOneShot)
+{
+    const size_t chunkSizes[] = { 1, 3, 7, 64, 1000 };
+    for (size_t v = 0; v < pCount; v++)
+    {
+        uint8_t expected[32];
+        char hex[65];
+        pOneShot(pVectors[v].Key, pVectors[v].Message, expected);
+        bytesToHexString(hex, expected, pDigestLength);
+        TEST_ASSERT_EQUAL_STRING(pVectors[v].DigestHex, hex);
+        TEST_ASSERT_EQUAL(2 * pDigestLength, strlen(hex));
+        for (size_t chunkSize : chunkSizes)
+        {
+            uint8_t digest[32];
+            pChunked(pVectors[v].Key, pVectors[v].Message, chunkSize, digest);
+            TEST_ASSERT_EQUAL_MEMORY(expected, digest, pDigestLength);
+        }
+    }
+}
+
+// Random messages (without 0 bytes, createMd5Hash() takes a string) in random chunks
+static void checkRandomMessages(size_t pDigestLength, ChunkedFunction pChunked, OneShotFunction pOneShot)
+{
+    std::mt19937 random(4711);
+    for (int i = 0; i < 200; i++)
+    {
+        std::string key(1 + random() % 100, ' ');
+        std::string message(random() % 5000, ' ');
+        for (char & c : key)
+        {
+            c = (char)(1 + random() % 255);
+        }
+        for (char & c : message)
+        {
+            c = (char)(1 + random() % 255);
+        }
+        uint8_t expected[32];
+        uint8_t digest[32];
+        pOneShot(key, message, expected);
+        pChunked(key, message, 1 + random() % 300, digest);
+        TEST_ASSERT_EQUAL_MEMORY(expected, digest, pDigestLength);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+static void test_md5()
+{
+    checkVectors(md5Vectors, sizeof(md5Vectors) / sizeof(md5Vectors[0]), 16, md5Chunked, md5OneShot);
+    checkRandomMessages(16, md5Chunked, md5OneShot);
+}
+
+static void test_sha256()
+{
+    checkVectors(sha256Vectors, sizeof(sha256Vectors) / sizeof(sha256Vectors[0]), 32, sha256Chunked, sha256OneShot);
+    checkRandomMessages(32, sha256Chunked, sha256OneShot);
+}
+
+static void test_hmac_sha256()
+{
+    checkVectors(hmacVectors, sizeof(hmacVectors) / sizeof(hmacVectors[0]), 32, hmacChunked, hmacOneShot);
+    checkRandomMessages(32, hmacChunked, hmacOneShot);
+}
+
+// The Content-MD5 of a digest with a 0 byte: all 16 bytes are encoded
+static void test_hex_of_digest_with_zero_byte()
+{
+    uint8_t digest[16];
+    md5Chunked("", "Content 167", 4, digest);
+    TEST_ASSERT_EQUAL(0, digest[3]);
+    char hex[33];
+    bytesToHexString(hex, digest, sizeof(digest));
+    TEST_ASSERT_EQUAL(32, strlen(hex));
+    TEST_ASSERT_EQUAL_STRING("585AFF004ED7A5C192694D70BAE9D619", hex);
+}
+
+static double megabytesPerSecond(ChunkedFunction pChunked, const std::string & pMessage, size_t pChunkSize)
+{
+    uint8_t digest[32];
+    auto start = std::chrono::steady_clock::now();
+    pChunked("key", pMessage, pChunkSize, digest);
+    auto end = std::chrono::steady_clock::now();
+    return pMessage.size() / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static double megabytesPerSecond(OneShotFunction pOneShot, const std::string & pMessage)
+{
+    uint8_t digest[32];
+    auto start = std::chrono::steady_clock::now();
+    pOneShot("key", pMessage, digest);
+    auto end = std::chrono::steady_clock::now();
+    return pMessage.size() / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// Only reports: the throughput of the one-shot functions and of the chunk sizes of a table request body
+static void test_benchmark()
+{
+    std::string message(BENCHMARK_BYTES, 'x');
+    const char * names[] = { "MD5", "SHA-256", "HMAC-SHA256" };
+    ChunkedFunction chunkedFunctions[] = { md5Chunked, sha256Chunked, hmacChunked };
+    OneShotFunction oneShotFunctions[] = { md5OneShot, sha256OneShot, hmacOneShot };
+    printf("%-14s %10s %10s %10s %10s\n", "MB/s", "one-shot", "16 B", "64 B", "1024 B");
+    for (int i = 0; i < 3; i++)
+    {
+        printf("%-14s %10.1f %10.1f %10.1f %10.1f\n", names[i], megabytesPerSecond(oneShotFunctions[i], message),
+               megabytesPerSecond(chunkedFunctions[i], message, 16), megabytesPerSecond(chunkedFunctions[i], message, 64),
+               megabytesPerSecond(chunkedFunctions[i], message, 1024));
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_md5);
+    RUN_TEST(test_sha256);
+    RUN_TEST(test_hmac_sha256);
+    RUN_TEST(test_hex_of_digest_with_zero_byte);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,389 @@
+// Host tests and benchmark of the SoundSwitcher block kernels (SoundBlockKernel.h)
+// Run with: pio test -e native -f test_sound_kernel
+//
+// The benchmark compares the broadband threshold/hysteresis average with the Goertzel
+// (spectral) mode on WAV clips. Recorded clips are taken from the directory in the
+// environment variable SOUND_CLIPS_DIR, the name of a clip starts with 'on' when the
+// burner runs and with 'off' when not (e.g. on_burner_01.wav, off_washing_machine.wav).
+// PCM 16 or 32 bit, the first channel is used. Without recorded clips synthesized
+// clips are used.
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "SoundBlockKernel.h"
+
+#define BLOCK_FRAMES 64             // dma_buf_len of the I2S configurations
+#define FEED_INTERVAL_MS 100        // the loudest block of an interval is used, like getSoundFromCapturedBlocks()
+#define AVERAGE_LENGTH 10           // buflen of SoundSwitcher
+#define HYSTERESIS_PERCENT 10
+#define MIN_BAND_RATIO 0.3f
+
+static const float bandFrequencies[] = { 1000.0f, 2000.0f };
+static const size_t bandCount = sizeof(bandFrequencies) / sizeof(bandFrequencies[0]);
+
+typedef struct
+{
+    std::string Name;
+    bool IsOn;
+    uint32_t SampleRate;
+    std::vector<int32_t> Samples;   // 32 bit I2S format, one channel
+}
+Clip;
+
+static uint32_t readLe(const uint8_t * pBytes, size_t pLength)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < pLength; i++)
+    {
+        value |= (uint32_t)pBytes[i] << (8 * i);
+    }
+    return value;
+}
+
+static bool readWav(const std::string & pPath, Clip * outClip)
+{
+    FILE * file = fopen(pPath.c_str(), "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[4096];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        bytes.insert(bytes.end(), buffer, buffer + length);
+    }
+    fclose(file);
+
+    if (bytes.size() < 12 || memcmp(&bytes[0], "RIFF", 4) != 0 || memcmp(&bytes[8], "WAVE", 4) != 0)
+    {
+        return false;
+    }
+    uint32_t channels = 0;
+    uint32_t bitsPerSample = 0;
+    size_t position = 12;
+    while (position + 8 <= bytes.size())
+    {
+        uint32_t chunkSize = readLe(&bytes[position + 4], 4);
+        const uint8_t * chunk = &bytes[position + 8];
+        if (position + 8 + chunkSize > bytes.size())
+        {
+            chunkSize = bytes.size() - position - 8;
+        }
+        if (memcmp(&bytes[position], "fmt ", 4) == 0 && chunkSize >= 16)
+        {
+            channels = readLe(chunk + 2, 2);
+            outClip ->SampleRate = readLe(chunk + 4, 4);
+            bitsPerSample = readLe(chunk + 14, 2);
+        }
+        else if (memcmp(&bytes[position], "data", 4) == 0 && channels > 0 && (bitsPerSample == 16 || bitsPerSample == 32))
+        {
+            size_t frameBytes = channels * bitsPerSample / 8;
+            for (size_t i = 0; i + frameBytes <= chunkSize; i += frameBytes)
+            {
+                // The I2S samples are left aligned in 32 bit
+                uint32_t raw = readLe(chunk + i, bitsPerSample / 8);
+                outClip ->Samples.push_back(bitsPerSample == 16 ? (int32_t)(raw << 16) : (int32_t)raw);
+            }
+            return outClip ->SampleRate > 0;
+        }
+        position += 8 + chunkSize + (chunkSize & 1);
+    }
+    return false;
+}
+
+static std::vector<Clip> loadRecordedClips()
+{
+    std::vector<Clip> clips;
+    const char * directory = getenv("SOUND_CLIPS_DIR");
+    DIR * dir = directory != NULL ? opendir(directory) : NULL;
+    if (dir == NULL)
+    {
+        return clips;
+    }
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        std::string name = entry ->d_name;
+        bool isOn = name.compare(0, 2, "on") == 0;
+        bool isOff = name.compare(0, 3, "off") == 0;
+        if ((!isOn && !isOff) || name.size() < 4 || name.compare(name.size() - 4, 4, ".wav") != 0)
+        {
+            continue;
+        }
+        Clip clip;
+        clip.Name = name;
+        clip.IsOn = isOn;
+        if (readWav(std::string(directory) + "/" + name, &clip))
+        {
+            clips.push_back(clip);
+        }
+        else
+        {
+            printf("Skipped %s (no PCM 16/32 bit)\n", name.c_str());
+        }
+    }
+    closedir(dir);
+    return clips;
+}
+
+// Burner tone at the band frequencies, broadband noise and loud sounds outside of the bands
+static Clip synthesizeClip(const char * pName, bool pIsOn, float pToneAmplitude, float pNoiseAmplitude, float pDisturbanceAmplitude)
+{
+    Clip clip;
+    clip.Name = pName;
+    clip.IsOn = pIsOn;
+    clip.SampleRate = 22050;
+    std::mt19937 random(42);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (uint32_t i = 0; i < clip.SampleRate * 10; i++)
+    {
+        float t = (float)i / clip.SampleRate;
+        float value = pNoiseAmplitude * noise(random);
+        value += pToneAmplitude * (sinf(2.0f * (float)M_PI * bandFrequencies[0] * t) + 0.5f * sinf(2.0f * (float)M_PI * bandFrequencies[1] * t));
+        // Voice like: 300 Hz and 4500 Hz, switched on and off every 0.7 s
+        float envelope = fmodf(t, 1.4f) < 0.7f ? 1.0f : 0.2f;
+        value += pDisturbanceAmplitude * envelope * (sinf(2.0f * (float)M_PI * 300.0f * t) + sinf(2.0f * (float)M_PI * 4500.0f * t));
+        // Values after '>> 14' like in the kernels
+        clip.Samples.push_back((int32_t)value * (1 << 14));
+    }
+    return clip;
+}
+
+static std::vector<Clip> synthesizedClips()
+{
+    std::vector<Clip> clips;
+    clips.push_back(synthesizeClip("on_quiet", true, 400.0f, 100.0f, 0.0f));
+    clips.push_back(synthesizeClip("on_voices", true, 400.0f, 100.0f, 300.0f));
+    clips.push_back(synthesizeClip("off_quiet", false, 0.0f, 100.0f, 0.0f));
+    clips.push_back(synthesizeClip("off_voices", false, 0.0f, 100.0f, 600.0f));
+    clips.push_back(synthesizeClip("off_noise", false, 0.0f, 500.0f, 0.0f));
+    return clips;
+}
+
+// Volume of one block like SoundSwitcher::volumeFromLevel() without calibration
+static float blockVolume(const int32_t * pSamples, size_t pCount, const int32_t * pCoeffs, bool pSpectral)
+{
+    SoundBlockLevel level = computeSoundBlockLevel(pSamples, pCount);
+    if (!pSpectral)
+    {
+        return (float)(level.Max - level.Min);
+    }
+    float bandMeanSquare = 0.0f;
+    for (size_t i = 0; i < bandCount; i++)
+    {
+        bandMeanSquare += computeGoertzelMeanSquare(pSamples, pCount, pCoeffs[i]);
+    }
+    float meanSquare = level.Rms * level.Rms;
+    float bandRatio = meanSquare > 0.0f ? bandMeanSquare / meanSquare : 0.0f;
+    return bandRatio < MIN_BAND_RATIO ? 0.0f : 2.0f * 1.4142f * sqrtf(bandMeanSquare);
+}
+
+// Volumes which feed() takes: the loudest block of every feed interval
+static std::vector<float> feedVolumes(const Clip & pClip, bool pSpectral)
+{
+    int32_t coeffs[bandCount];
+    for (size_t i = 0; i < bandCount; i++)
+    {
+        coeffs[i] = computeGoertzelCoefficient(bandFrequencies[i], pClip.SampleRate);
+    }
+    size_t blocksPerInterval = pClip.SampleRate * FEED_INTERVAL_MS / 1000 / BLOCK_FRAMES;
+    std::vector<float> volumes;
+    float loudest = 0.0f;
+    size_t blockIndex = 0;
+    for (size_t i = 0; i + BLOCK_FRAMES <= pClip.Samples.size(); i += BLOCK_FRAMES)
+    {
+        float volume = blockVolume(&pClip.Samples[i], BLOCK_FRAMES, coeffs, pSpectral);
+        loudest = volume > loudest ? volume : loudest;
+        if (++blockIndex % blocksPerInterval == 0)
+        {
+            volumes.push_back(loudest);
+            loudest = 0.0f;
+        }
+    }
+    return volumes;
+}
+
+// Part of the feed intervals where the state of the threshold/hysteresis average is right
+// The state starts wrong, so the time to switch is counted as error
+static float detectionAccuracy(const std::vector<float> & pVolumes, bool pIsOn, float pThreshold)
+{
+    bool state = !pIsOn;
+    size_t correct = 0;
+    size_t counted = 0;
+    for (size_t i = AVERAGE_LENGTH; i <= pVolumes.size(); i++)
+    {
+        float average = 0.0f;
+        for (size_t j = i - AVERAGE_LENGTH; j < i; j++)
+        {
+            average += pVolumes[j];
+        }
+        average /= AVERAGE_LENGTH;
+        if (!state && average > pThreshold)
+        {
+            state = true;
+        }
+        else if (state && average < pThreshold - pThreshold / 100 * HYSTERESIS_PERCENT)
+        {
+            state = false;
+        }
+        correct += state == pIsOn;
+        counted++;
+    }
+    return counted > 0 ? (float)correct / counted : 0.0f;
+}
+
+static float median(std::vector<float> pValues)
+{
+    if (pValues.empty())
+    {
+        return 0.0f;
+    }
+    std::sort(pValues.begin(), pValues.end());
+    return pValues[pValues.size() / 2];
+}
+
+// Same calibration for both modes: geometric mean of the median 'on' and 'off' volume
+static float calibrateThreshold(const std::vector<Clip> & pClips, bool pSpectral)
+{
+    std::vector<float> onVolumes;
+    std::vector<float> offVolumes;
+    for (const Clip & clip : pClips)
+    {
+        std::vector<float> volumes = feedVolumes(clip, pSpectral);
+        (clip.IsOn ? onVolumes : offVolumes).insert((clip.IsOn ? onVolumes : offVolumes).end(), volumes.begin(), volumes.end());
+    }
+    float threshold = sqrtf(median(onVolumes) * median(offVolumes));
+    return threshold > 0.0f ? threshold : median(onVolumes) / 2;
+}
+
+// Mean accuracy over the clips of both modes
+static void runBenchmark(const std::vector<Clip> & pClips, float * outBroadbandAccuracy, float * outSpectralAccuracy)
+{
+    float thresholds[2] = { calibrateThreshold(pClips, false), calibrateThreshold(pClips, true) };
+    float accuracySums[2] = { 0.0f, 0.0f };
+    double cpuMicrosPerSecond[2] = { 0.0, 0.0 };
+    double audioSeconds = 0.0;
+
+    printf("%-28s %6s %12s %12s\n", "clip", "state", "broadband", "goertzel");
+    for (const Clip & clip : pClips)
+    {
+        float accuracies[2];
+        for (int mode = 0; mode < 2; mode++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<float> volumes = feedVolumes(clip, mode == 1);
+            auto end = std::chrono::steady_clock::now();
+            cpuMicrosPerSecond[mode] += std::chrono::duration<double, std::micro>(end - start).count();
+            accuracies[mode] = detectionAccuracy(volumes, clip.IsOn, thresholds[mode]);
+            accuracySums[mode] += accuracies[mode];
+        }
+        audioSeconds += (double)clip.Samples.size() / clip.SampleRate;
+        printf("%-28s %6s %11.1f%% %11.1f%%\n", clip.Name.c_str(), clip.IsOn ? "on" : "off", accuracies[0] * 100, accuracies[1] * 100);
+    }
+    *outBroadbandAccuracy = accuracySums[0] / pClips.size();
+    *outSpectralAccuracy = accuracySums[1] / pClips.size();
+    printf("%-28s %6s %11.1f%% %11.1f%%\n", "mean", "", *outBroadbandAccuracy * 100, *outSpectralAccuracy * 100);
+    printf("%-28s %6s %10.1fus %10.1fus\n", "host cpu per second of audio", "", cpuMicrosPerSecond[0] / audioSeconds, cpuMicrosPerSecond[1] / audioSeconds);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// 500 Hz at 16 kHz has exact zero crossings, the zeros are regular samples
+static void test_goertzel_sine_with_zero_samples()
+{
+    const size_t count = 512;
+    int32_t samples[count];
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = (int32_t)lroundf(1000.0f * sinf(2.0f * (float)M_PI * 500.0f * i / 16000.0f)) * (1 << 14);
+    }
+    TEST_ASSERT_EQUAL(0, samples[16]);
+    float meanSquare = computeGoertzelMeanSquare(samples, count, computeGoertzelCoefficient(500.0f, 16000.0f));
+    TEST_ASSERT_FLOAT_WITHIN(500000.0f * 0.02f, 500000.0f, meanSquare);
+
+    SoundBlockLevel level = computeSoundBlockLevel(samples, count);
+    TEST_ASSERT_EQUAL(count, level.SampleCount);
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 707.1f, level.Rms);
+}
+
+// The signal of the SPH0645 is in one of the interleaved channels, the other one is 0
+static void test_interleaved_channel()
+{
+    const size_t count = 512;
+    int32_t mono[count];
+    int32_t interleaved[2 * count];
+    for (size_t i = 0; i < count; i++)
+    {
+        mono[i] = (int32_t)lroundf(1000.0f * sinf(2.0f * (float)M_PI * 500.0f * i / 16000.0f) + 200.0f) * (1 << 14);
+    }
+    int32_t coeff = computeGoertzelCoefficient(500.0f, 16000.0f);
+    float expected = computeGoertzelMeanSquare(mono, count, coeff);
+    SoundBlockLevel expectedLevel = computeSoundBlockLevel(mono, count);
+
+    for (size_t channel = 0; channel < 2; channel++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            interleaved[2 * i + channel] = mono[i];
+            interleaved[2 * i + 1 - channel] = 0;
+        }
+        size_t first = findUsedChannel(interleaved, 2 * count, 2);
+        TEST_ASSERT_EQUAL(channel, first);
+        TEST_ASSERT_FLOAT_WITHIN(1.0f, expected, computeGoertzelMeanSquare(interleaved, 2 * count, coeff, 2, first));
+        SoundBlockLevel level = computeSoundBlockLevel(interleaved, 2 * count, 2, first);
+        TEST_ASSERT_EQUAL(count, level.SampleCount);
+        TEST_ASSERT_EQUAL(expectedLevel.Min, level.Min);
+        TEST_ASSERT_EQUAL(expectedLevel.Max, level.Max);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, expectedLevel.Rms, level.Rms);
+    }
+}
+
+static void test_benchmark_synthesized_clips()
+{
+    float broadband;
+    float spectral;
+    runBenchmark(synthesizedClips(), &broadband, &spectral);
+    // Loud sounds outside of the bands must not switch the spectral mode on
+    TEST_ASSERT_TRUE(spectral >= 0.95f);
+    TEST_ASSERT_TRUE(spectral > broadband);
+}
+
+// Only reports, the accuracy of recorded clips depends on the calibration
+static void test_benchmark_recorded_clips()
+{
+    std::vector<Clip> clips = loadRecordedClips();
+    if (clips.empty())
+    {
+        TEST_MESSAGE("No recorded clips, set SOUND_CLIPS_DIR to a directory with on*.wav and off*.wav");
+        return;
+    }
+    float broadband;
+    float spectral;
+    runBenchmark(clips, &broadband, &spectral);
+}
+
+int main(int argc, char ** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_goertzel_sine_with_zero_samples);
+    RUN_TEST(test_interleaved_channel);
+    RUN_TEST(test_benchmark_synthesized_clips);
+    RUN_TEST(test_benchmark_recorded_clips);
+    return UNITY_END();
+}
@@ -0,0 +1,279 @@
+// Host tests and benchmark of the cached DST transition table of Timezone (Timezone_Generic_Impl.h)
+// Run with: pio test -e native -f test_timezone
+//
+// ReferenceTimezone is the implementation before the transition table: every conversion
+// calls year() once or twice and recalculates the changes when the year differs.
+// The new utcIsDST(), toLocal() and toLocalWithOffset() must give the same results
+// for all times from 2000 to 2100.
+
+#include <unity.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <LittleFS.h>
+#define FileFS LittleFS     // Timezone stores its rules with LittleFS on the ESP32
+#include <Timezone_Generic.h>
+
+#define FIRST_YEAR 2000
+#define LAST_YEAR 2100
+#define COARSE_STEP_SECONDS 599         // coprime to 60 and 3600, so all minutes and seconds are hit
+#define CHANGE_WINDOW_SECONDS 3600      // every second this long before and after each change
+
+// The algorithm of Timezone_Generic 1.10.1
+class ReferenceTimezone
+{
+public:
+    ReferenceTimezone(const TimeChangeRule & pDstStart, const TimeChangeRule & pStdStart) : m_dst(pDstStart), m_std(pStdStart) {}
+
+    bool utcIsDST(const time_t & utc)
+    {
+        // recalculate the time change points if needed
+        if (year(utc) != year(m_dstUTC))
+            calcTimeChanges(year(utc));
+
+        if (m_stdUTC == m_dstUTC)       // daylight time not observed in this tz
+            return false;
+        else if (m_stdUTC > m_dstUTC)   // northern hemisphere
+            return (utc >= m_dstUTC && utc < m_stdUTC);
+        else                            // southern hemisphere
+            return !(utc >= m_stdUTC && utc < m_dstUTC);
+    }
+
+    time_t toLocal(const time_t & utc)
+    {
+        // recalculate the time change points if needed
+        if (year(utc) != year(m_dstUTC))
+            calcTimeChanges(year(utc));
+
+        if (utcIsDST(utc))
+            return utc + m_dst.offset * SECS_PER_MIN;
+        else
+            return utc + m_std.offset * SECS_PER_MIN;
+    }
+
+    // The changes (UTC) of the year, for the test points around them
+    void changesOfYear(int yr, time_t * outDstUTC, time_t * outStdUTC)
+    {
+        calcTimeChanges(yr);
+        *outDstUTC = m_dstUTC;
+        *outStdUTC = m_stdUTC;
+    }
+
+private:
+    void calcTimeChanges(int yr)
+    {
+        m_dstLoc = toTime_t(m_dst, yr);
+        m_stdLoc = toTime_t(m_std, yr);
+        m_dstUTC = m_dstLoc - m_std.offset * SECS_PER_MIN;
+        m_stdUTC = m_stdLoc - m_dst.offset * SECS_PER_MIN;
+    }
+
+    time_t toTime_t(const TimeChangeRule & r, int yr)
+    {
+        uint8_t m = r.month;     // temp copies of r.month and r.week
+        uint8_t w = r.week;
+
+        if (w == 0)              // is this a "Last week" rule?
+        {
+            if (++m > 12)        // yes, for "Last", go to the next month
+            {
+                m = 1;
+                ++yr;
+            }
+            w = 1;               // and treat as first week of next month, subtract 7 days later
+        }
+
+        // calculate first day of the month, or for "Last" rules, first day of the next month
+        tmElements_t tm;
+        tm.Hour   = r.hour;
+        tm.Minute = 0;
+        tm.Second = 0;
+        tm.Day    = 1;
+        tm.Month  = m;
+        tm.Year   = yr - 1970;
+        time_t t  = makeTime(tm);
+
+        // add offset from the first of the month to r.dow, and offset for the given week
+        t += ( (r.dow - weekday(t) + 7) % 7 + (w - 1) * 7 ) * SECS_PER_DAY;
+
+        // back up a week if this is a "Last" rule
+        if (r.week == 0)
+            t -= 7 * SECS_PER_DAY;
+
+        return t;
+    }
+
+    TimeChangeRule m_dst;
+    TimeChangeRule m_std;
+    time_t m_dstUTC = 0;
+    time_t m_stdUTC = 0;
+    time_t m_dstLoc = 0;
+    time_t m_stdLoc = 0;
+};
+
+typedef struct
+{
+    const char * Name;
+    TimeChangeRule DstStart;
+    TimeChangeRule StdStart;
+}
+Zone;
+
+static const Zone zones[] =
+{
+    { "CET/CEST",   { "CEST", Last,   Sun, Mar, 2, 120 },  { "CET",  Last,   Sun, Oct, 3, 60 } },
+    { "US Eastern", { "EDT",  Second, Sun, Mar, 2, -240 }, { "EST",  First,  Sun, Nov, 2, -300 } },
+    { "AEST/AEDT",  { "AEDT", First,  Sun, Oct, 2, 660 },  { "AEST", First,  Sun, Apr, 3, 600 } },
+    { "IST (no DST)", { "IST", Last,  Sun, Mar, 1, 330 },  { "IST",  Last,   Sun, Mar, 1, 330 } },
+};
+static const size_t zoneCount = sizeof(zones) / sizeof(zones[0]);
+
+static time_t yearStartUTC(int yr)
+{
+    tmElements_t tm = {};
+    tm.Day = 1;
+    tm.Month = 1;
+    tm.Year = yr - 1970;
+    return makeTime(tm);
+}
+
+// The coarse grid, every second around the changes and around the turns of the year
+static std::vector<time_t> testTimes(const Zone & pZone)
+{
+    ReferenceTimezone reference(pZone.DstStart, pZone.StdStart);
+    std::vector<time_t> times;
+    for (time_t t = yearStartUTC(FIRST_YEAR); t < yearStartUTC(LAST_YEAR + 1); t += COARSE_STEP_SECONDS)
+    {
+        times.push_back(t);
+    }
+    for (int yr = FIRST_YEAR; yr <= LAST_YEAR; yr++)
+    {
+        time_t changes[3];
+        reference.changesOfYear(yr, &changes[0], &changes[1]);
+        changes[2] = yearStartUTC(yr);
+        for (time_t change : changes)
+        {
+            for (time_t t = change - CHANGE_WINDOW_SECONDS; t <= change + CHANGE_WINDOW_SECONDS; t++)
+            {
+                times.push_back(t);
+            }
+        }
+    }
+    return times;
+}
+
+static void checkZone(const Zone & pZone, const std::vector<time_t> & pTimes)
+{
+    ReferenceTimezone reference(pZone.DstStart, pZone.StdStart);
+    Timezone timezone(pZone.DstStart, pZone.StdStart);
+    size_t mismatches = 0;
+    for (time_t utc : pTimes)
+    {
+        bool isDST = reference.utcIsDST(utc);
+        time_t local = reference.toLocal(utc);
+        int offsetMinutes = 0;
+        if ((timezone.utcIsDST(utc) != isDST) || (timezone.toLocal(utc) != local) ||
+            (timezone.toLocalWithOffset(utc, &offsetMinutes) != local) || ((time_t)offsetMinutes * 60 != local - utc))
+        {
+            if (mismatches++ < 5)
+            {
+                printf("%s: mismatch at %lld\n", pZone.Name, (long long)utc);
+            }
+        }
+    }
+    printf("%-14s %9zu times, %zu mismatches\n", pZone.Name, pTimes.size(), mismatches);
+    TEST_ASSERT_EQUAL(0, mismatches);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+// In ascending order, like the calls of loop()
+static void test_equivalence_ascending()
+{
+    for (size_t z = 0; z < zoneCount; z++)
+    {
+        std::vector<time_t> times = testTimes(zones[z]);
+        std::sort(times.begin(), times.end());
+        checkZone(zones[z], times);
+    }
+}
+
+// In random order, so the table of another year is calculated with nearly every call
+static void test_equivalence_random_order()
+{
+    std::mt19937 random(4711);
+    for (size_t z = 0; z < zoneCount; z++)
+    {
+        std::vector<time_t> times = testTimes(zones[z]);
+        std::shuffle(times.begin(), times.end(), random);
+        times.resize(times.size() / 4);
+        checkZone(zones[z], times);
+    }
+}
+
+// A zone without DST made with the constructor for one rule (no initTimeChanges())
+static void test_single_rule_constructor()
+{
+    TimeChangeRule ist = { "IST", Last, Sun, Mar, 1, 330 };
+    Timezone timezone(ist);
+    for (time_t t = yearStartUTC(FIRST_YEAR); t < yearStartUTC(LAST_YEAR + 1); t += 86400 * 7 + 3599)
+    {
+        TEST_ASSERT_FALSE(timezone.utcIsDST(t));
+        TEST_ASSERT_EQUAL(t + 330 * 60, timezone.toLocal(t));
+    }
+}
+
+template<typename Tz>
+static double nanosPerConversion(Tz * pTimezone, const std::vector<time_t> & pTimes)
+{
+    volatile time_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (time_t utc : pTimes)
+    {
+        sink = sink + pTimezone ->toLocal(utc) + pTimezone ->utcIsDST(utc);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / pTimes.size();
+}
+
+// Only reports: one toLocal() and one utcIsDST() per time, like the former code of loop()
+static void test_benchmark()
+{
+    const Zone & zone = zones[0];
+    std::vector<time_t> loopTimes;
+    for (time_t t = yearStartUTC(2024); loopTimes.size() < 2000000; t += 5)
+    {
+        loopTimes.push_back(t);
+    }
+    std::vector<time_t> randomTimes;
+    std::mt19937 random(4711);
+    std::uniform_int_distribution<time_t> distribution(yearStartUTC(FIRST_YEAR), yearStartUTC(LAST_YEAR + 1) - 1);
+    for (size_t i = 0; i < 200000; i++)
+    {
+        randomTimes.push_back(distribution(random));
+    }
+
+    ReferenceTimezone reference(zone.DstStart, zone.StdStart);
+    Timezone timezone(zone.DstStart, zone.StdStart);
+    printf("%-22s %12s %12s\n", "ns per conversion", "reference", "table");
+    printf("%-22s %12.1f %12.1f\n", "every 5 s (loop)", nanosPerConversion(&reference, loopTimes), nanosPerConversion(&timezone, loopTimes));
+    printf("%-22s %12.1f %12.1f\n", "random 2000 - 2100", nanosPerConversion(&reference, randomTimes), nanosPerConversion(&timezone, randomTimes));
+}
+
+int main(int argc, char ** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_equivalence_ascending);
+    RUN_TEST(test_equivalence_random_order);
+    RUN_TEST(test_single_rule_constructor);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}